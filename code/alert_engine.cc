@@ -0,0 +1,175 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/alert_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/telemetry.h"
+
+namespace mjpc {
+
+namespace {
+
+double AlertValue(const DashboardSnapshot& snapshot, int alert) {
+  switch (alert) {
+    case kAlertHighRpm:
+      return snapshot.rpm;
+    case kAlertLowFuel:
+      return snapshot.fuel;
+    case kAlertOverheat:
+      return snapshot.temperature;
+  }
+  return 0.0;
+}
+
+// 数值升高告警：set >= clear
+bool Rising(const AlertRule& rule) { return rule.set >= rule.clear; }
+
+}  // namespace
+
+AlertEngine::AlertEngine() {
+  std::copy_n(kDefaultAlertRules, kNumAlerts, rules_);
+  Reset();
+}
+
+void AlertEngine::ReadRules(const mjModel* model) {
+  for (int i = 0; i < kNumAlerts; i++) {
+    AlertRule rule = kDefaultAlertRules[i];
+    std::string name = std::string("alert_") + rule.name;
+    int id = mj_name2id(model, mjOBJ_NUMERIC, name.c_str());
+    if (id >= 0) {
+      const double* data = model->numeric_data + model->numeric_adr[id];
+      int size = model->numeric_size[id];
+      double* fields[4] = {&rule.set, &rule.clear, &rule.min_on,
+                           &rule.min_off};
+      for (int j = 0; j < std::min(size, 4); j++) *fields[j] = data[j];
+      // 只给出 set 时沿用默认的回差方向与宽度
+      if (size == 1) {
+        rule.clear = rule.set + (kDefaultAlertRules[i].clear -
+                                 kDefaultAlertRules[i].set);
+      }
+      rule.min_on = std::max(0.0, rule.min_on);
+      rule.min_off = std::max(0.0, rule.min_off);
+    }
+    rules_[i] = rule;
+  }
+}
+
+void AlertEngine::Reset() {
+  active_ = 0;
+  std::fill_n(pending_since_, kNumAlerts, -1.0);
+  last_time_ = -1.0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (AlertMetrics& metrics : metrics_) metrics = AlertMetrics();
+}
+
+uint32_t AlertEngine::Update(const DashboardSnapshot& snapshot) {
+  double time = snapshot.time;
+  if (time < last_time_) Reset();
+  double dt = last_time_ >= 0.0 ? time - last_time_ : 0.0;
+  last_time_ = time;
+
+  for (int i = 0; i < kNumAlerts; i++) {
+    const AlertRule& rule = rules_[i];
+    double value = AlertValue(snapshot, i);
+    bool active = active_ & (1u << i);
+
+    // 未告警时检查触发条件，告警中检查解除条件
+    bool change;
+    if (!active) {
+      change = Rising(rule) ? value > rule.set : value < rule.set;
+    } else {
+      change = Rising(rule) ? value < rule.clear : value > rule.clear;
+    }
+
+    if (!change) {
+      pending_since_[i] = -1.0;
+    } else {
+      if (pending_since_[i] < 0.0) pending_since_[i] = time;
+      double hold = active ? rule.min_off : rule.min_on;
+      if (time - pending_since_[i] >= hold) {
+        active_ ^= 1u << i;
+        pending_since_[i] = -1.0;
+        Emit(time, i, !active, value);
+      }
+    }
+
+    if (active && dt > 0.0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      metrics_[i].active_time += dt;
+    }
+  }
+  return active_;
+}
+
+void AlertEngine::Emit(double time, int alert, bool raised, double value) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AlertEvent& event = events_[event_count_ % kEventCapacity];
+    event.time = time;
+    event.alert = alert;
+    event.raised = raised;
+    event.value = value;
+    event_count_++;
+    if (raised) {
+      metrics_[alert].raised++;
+      metrics_[alert].last_raised = time;
+    }
+  }
+  printf("Alert %s %s at t=%.2f (value %.1f)\n", rules_[alert].name,
+         raised ? "raised" : "cleared", time, value);
+}
+
+uint64_t AlertEngine::event_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return event_count_;
+}
+
+int AlertEngine::Events(uint64_t since, AlertEvent* events, int max) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t first = event_count_ > kEventCapacity ? event_count_ - kEventCapacity
+                                                 : 0;
+  since = std::max(since, first);
+  int count = 0;
+  for (uint64_t i = since; i < event_count_ && count < max; i++) {
+    events[count++] = events_[i % kEventCapacity];
+  }
+  return count;
+}
+
+AlertMetrics AlertEngine::metrics(int alert) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return metrics_[alert];
+}
+
+void AlertEngine::PrintMetrics() const {
+  printf("Dashboard alerts:\n");
+  printf("  %-10s %10s %10s %8s %12s\n", "alert", "set", "clear", "raised",
+         "active (s)");
+  for (int i = 0; i < kNumAlerts; i++) {
+    AlertMetrics stats = metrics(i);
+    printf("  %-10s %10.1f %10.1f %8llu %12.2f\n", rules_[i].name,
+           rules_[i].set, rules_[i].clear,
+           static_cast<unsigned long long>(stats.raised), stats.active_time);
+  }
+}
+
+}  // namespace mjpc
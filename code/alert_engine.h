@@ -0,0 +1,116 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_ALERT_ENGINE_H_
+#define MJPC_TASKS_SIMPLE_CAR_ALERT_ENGINE_H_
+
+#include <cstdint>
+#include <mutex>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/telemetry.h"
+
+namespace mjpc {
+
+// 仪表盘告警
+enum DashboardAlert : int {
+  kAlertHighRpm = 0,
+  kAlertLowFuel,
+  kAlertOverheat,
+  kNumAlerts,
+};
+
+inline constexpr uint32_t AlertBit(DashboardAlert alert) { return 1u << alert; }
+
+// 告警规则：set 为触发阈值，clear 为解除阈值（两者之差即回差）
+//   set > clear 时数值升高告警，set < clear 时数值降低告警
+//   条件需连续保持 min_on 秒才触发，解除条件需连续保持 min_off 秒才解除
+struct AlertRule {
+  const char* name;   // numeric 名称（alert_<name>）与事件名
+  const char* label;  // 仪表盘上显示的文字
+  double set;
+  double clear;
+  double min_on;
+  double min_off;
+};
+
+inline constexpr AlertRule kDefaultAlertRules[kNumAlerts] = {
+    {"high_rpm", "HIGH RPM!", 6000.0, 5800.0, 0.2, 0.5},
+    {"low_fuel", "LOW FUEL!", 20.0, 22.0, 0.5, 1.0},
+    {"overheat", "OVERHEAT!", 100.0, 97.0, 0.5, 1.0},
+};
+
+// 触发/解除事件（边沿）
+struct AlertEvent {
+  double time = 0.0;
+  int alert = 0;
+  bool raised = false;
+  double value = 0.0;  // 边沿时刻的读数
+};
+
+// 每个告警的统计
+struct AlertMetrics {
+  uint64_t raised = 0;       // 触发次数
+  double active_time = 0.0;  // 累计告警时长（s）
+  double last_raised = -1.0; // 最近一次触发时刻（-1 表示未触发）
+};
+
+// 告警引擎：每次发布仪表盘快照时评估一次，渲染只读结果位掩码
+//   事件写入环形缓冲区，可在其它线程按事件序号增量读取
+class AlertEngine {
+ public:
+  static constexpr int kEventCapacity = 64;
+
+  AlertEngine();
+
+  // 从 <numeric name="alert_<name>" data="set clear min_on min_off"/> 读取规则，
+  //   缺少的值取默认规则
+  void ReadRules(const mjModel* model);
+  const AlertRule& rule(int alert) const { return rules_[alert]; }
+
+  // 清除告警状态与统计（回合开始时调用）
+  void Reset();
+
+  // 评估一个快照，返回当前告警位掩码；仿真时间回退时自动 Reset
+  uint32_t Update(const DashboardSnapshot& snapshot);
+
+  uint32_t active() const { return active_; }
+
+  // 已产生的事件总数（事件序号从 0 开始）
+  uint64_t event_count() const;
+
+  // 读取序号 >= since 的事件（最多 max 个），返回读到的个数；
+  //   被环形缓冲区覆盖的旧事件会被跳过
+  int Events(uint64_t since, AlertEvent* events, int max) const;
+
+  AlertMetrics metrics(int alert) const;
+  void PrintMetrics() const;
+
+ private:
+  void Emit(double time, int alert, bool raised, double value);
+
+  AlertRule rules_[kNumAlerts];
+  uint32_t active_ = 0;
+  double pending_since_[kNumAlerts];  // 状态切换条件开始成立的时刻，-1 表示不成立
+  double last_time_ = -1.0;
+
+  mutable std::mutex mutex_;  // 保护事件与统计
+  AlertEvent events_[kEventCapacity];
+  uint64_t event_count_ = 0;
+  AlertMetrics metrics_[kNumAlerts];
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_ALERT_ENGINE_H_
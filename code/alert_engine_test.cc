@@ -0,0 +1,116 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/alert_engine.h"
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+#include "mjpc/tasks/simple_car/telemetry.h"
+
+namespace mjpc {
+namespace {
+
+// 步长取二进制精确的 0.125 s，保持时间比较不受舍入影响
+constexpr double kStep = 0.125;
+
+// 默认规则：high_rpm 6000/5800，触发前保持 0.2 s，解除前保持 0.5 s；
+//   low_fuel 20/22（数值降低告警）
+class AlertEngineTest : public ::testing::Test {
+ protected:
+  uint32_t Feed(double rpm, double fuel = 50.0) {
+    DashboardSnapshot snapshot;
+    snapshot.time = time_;
+    snapshot.rpm = rpm;
+    snapshot.fuel = fuel;
+    snapshot.temperature = 80.0;
+    time_ += kStep;
+    return engine_.Update(snapshot);
+  }
+
+  AlertEngine engine_;
+  double time_ = 0.0;
+};
+
+TEST_F(AlertEngineTest, RaisesAfterMinOn) {
+  EXPECT_EQ(Feed(6100.0), 0u);  // t = 0：条件开始成立
+  EXPECT_EQ(Feed(6100.0), 0u);  // t = 0.125 < 0.2
+  EXPECT_EQ(Feed(6100.0), AlertBit(kAlertHighRpm));  // t = 0.25
+
+  ASSERT_EQ(engine_.event_count(), 1u);
+  AlertEvent event;
+  ASSERT_EQ(engine_.Events(0, &event, 1), 1);
+  EXPECT_EQ(event.alert, kAlertHighRpm);
+  EXPECT_TRUE(event.raised);
+  EXPECT_DOUBLE_EQ(event.time, 0.25);
+  EXPECT_EQ(engine_.metrics(kAlertHighRpm).raised, 1u);
+}
+
+TEST_F(AlertEngineTest, IgnoresShortSpike) {
+  Feed(5000.0);
+  Feed(6100.0);  // 只持续一个步长
+  Feed(5000.0);
+  Feed(6100.0);
+  Feed(5000.0);
+  EXPECT_EQ(engine_.active(), 0u);
+  EXPECT_EQ(engine_.event_count(), 0u);
+}
+
+TEST_F(AlertEngineTest, HoldsInsideHysteresisBand) {
+  for (int i = 0; i < 3; i++) Feed(6100.0);
+  ASSERT_EQ(engine_.active(), AlertBit(kAlertHighRpm));
+
+  // 回差带内（低于 set、高于 clear）保持告警
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(Feed(5900.0), AlertBit(kAlertHighRpm));
+  }
+
+  // 低于 clear 不足 min_off 后回到带内：不解除
+  for (int i = 0; i < 3; i++) Feed(5700.0);
+  EXPECT_EQ(Feed(5900.0), AlertBit(kAlertHighRpm));
+
+  // 低于 clear 持续 min_off（0.5 s = 4 步）后解除
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(Feed(5700.0), AlertBit(kAlertHighRpm));
+  }
+  EXPECT_EQ(Feed(5700.0), 0u);
+
+  ASSERT_EQ(engine_.event_count(), 2u);
+  AlertEvent events[2];
+  ASSERT_EQ(engine_.Events(0, events, 2), 2);
+  EXPECT_TRUE(events[0].raised);
+  EXPECT_FALSE(events[1].raised);
+  EXPECT_GT(engine_.metrics(kAlertHighRpm).active_time, 0.0);
+}
+
+TEST_F(AlertEngineTest, FallingRule) {
+  // low_fuel：低于 20 触发，高于 22 解除，21 处于回差带内
+  for (int i = 0; i < 5; i++) Feed(1000.0, 19.0);
+  EXPECT_EQ(engine_.active(), AlertBit(kAlertLowFuel));
+  for (int i = 0; i < 20; i++) Feed(1000.0, 21.0);
+  EXPECT_EQ(engine_.active(), AlertBit(kAlertLowFuel));
+  for (int i = 0; i < 10; i++) Feed(1000.0, 23.0);
+  EXPECT_EQ(engine_.active(), 0u);
+}
+
+TEST_F(AlertEngineTest, ResetsWhenTimeGoesBack) {
+  for (int i = 0; i < 3; i++) Feed(6100.0);
+  ASSERT_EQ(engine_.active(), AlertBit(kAlertHighRpm));
+  time_ = 0.0;
+  EXPECT_EQ(Feed(5900.0), 0u);
+  EXPECT_EQ(engine_.metrics(kAlertHighRpm).raised, 0u);
+}
+
+}  // namespace
+}  // namespace mjpc
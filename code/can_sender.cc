@@ -0,0 +1,229 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/can_sender.h"
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include "mjpc/tasks/simple_car/telemetry.h"
+
+namespace mjpc {
+
+namespace {
+
+constexpr int64_t kNanosecondsPerMs = 1000000;
+
+int64_t Now() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void SleepUntil(int64_t deadline) {
+  timespec when;
+  when.tv_sec = deadline / 1000000000LL;
+  when.tv_nsec = deadline % 1000000000LL;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, nullptr) ==
+         EINTR) {
+  }
+}
+
+uint16_t Scale(double value, double resolution, double offset = 0.0) {
+  double raw = std::round((value - offset) / resolution);
+  if (!std::isfinite(raw)) raw = 0.0;
+  return std::clamp(raw, 0.0, 65535.0);
+}
+
+}  // namespace
+
+void EncodeCanPayload(int message, const DashboardSnapshot& snapshot,
+                      uint8_t counter, uint8_t payload[8]) {
+  std::memset(payload, 0, 8);
+  uint16_t signal = 0;
+  switch (message) {
+    case 0:
+      signal = Scale(snapshot.speed_kmh, 0.01);
+      break;
+    case 1:
+      signal = Scale(snapshot.rpm, 0.25);
+      break;
+    case 2:
+      signal = Scale(snapshot.fuel, 0.01);
+      break;
+    case 3:
+      signal = Scale(snapshot.temperature, 0.1, -40.0);
+      break;
+  }
+  payload[0] = signal & 0xFF;
+  payload[1] = signal >> 8;
+  payload[6] = counter & 0x0F;
+
+  uint32_t id = kCanMessages[message].id;
+  uint32_t sum = (id & 0xFF) + (id >> 8);
+  for (int i = 0; i < 7; i++) sum += payload[i];
+  payload[7] = sum & 0xFF;
+}
+
+CanSender::~CanSender() { Stop(); }
+
+bool CanSender::Start(const DashboardTelemetry* telemetry,
+                      const std::string& interface) {
+  if (IsRunning()) return true;
+  telemetry_ = telemetry;
+  interface_ = interface;
+
+  socket_ = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+  if (socket_ < 0) return false;
+
+  ifreq request = {};
+  std::strncpy(request.ifr_name, interface.c_str(), IFNAMSIZ - 1);
+  if (ioctl(socket_, SIOCGIFINDEX, &request) < 0) {
+    close(socket_);
+    socket_ = -1;
+    return false;
+  }
+
+  sockaddr_can addr = {};
+  addr.can_family = AF_CAN;
+  addr.can_ifindex = request.ifr_ifindex;
+  if (bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(socket_);
+    socket_ = -1;
+    return false;
+  }
+
+  // 只发送：不接收总线上的报文
+  setsockopt(socket_, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0);
+
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    for (Histogram& stats : stats_) stats = Histogram();
+  }
+  stop_.store(false);
+  thread_ = std::thread(&CanSender::Loop, this);
+  return true;
+}
+
+void CanSender::Stop() {
+  if (!IsRunning()) return;
+  stop_.store(true);
+  thread_.join();
+  close(socket_);
+  socket_ = -1;
+}
+
+void CanSender::Loop() {
+  // 尽量使用实时优先级；没有权限时保持普通调度
+  sched_param param = {};
+  param.sched_priority = 10;
+  pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+  int64_t due[kCanNumMessages];
+  uint8_t counter[kCanNumMessages] = {0};
+  int64_t start = Now();
+  for (int i = 0; i < kCanNumMessages; i++) due[i] = start;
+
+  while (!stop_.load(std::memory_order_relaxed)) {
+    int64_t next = *std::min_element(due, due + kCanNumMessages);
+    SleepUntil(next);
+
+    DashboardSnapshot snapshot;
+    telemetry_->Read(&snapshot);
+
+    for (int i = 0; i < kCanNumMessages; i++) {
+      if (due[i] > next) continue;
+
+      can_frame frame = {};
+      frame.can_id = kCanMessages[i].id;
+      frame.can_dlc = 8;
+      EncodeCanPayload(i, snapshot, counter[i]++, frame.data);
+      bool ok = write(socket_, &frame, sizeof(frame)) == sizeof(frame);
+      double late_us = (Now() - due[i]) * 1e-3;
+
+      {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        Histogram& stats = stats_[i];
+        if (!ok) {
+          stats.errors++;
+        } else {
+          int bin =
+              std::clamp(static_cast<int>(late_us / kBinUs), 0, kBins - 1);
+          stats.counts[bin]++;
+          stats.frames++;
+          stats.sum_us += late_us;
+          stats.max_us = std::max(stats.max_us, late_us);
+        }
+      }
+
+      // 按计划时刻推进，偏差不累积；严重落后（例如挂起）时重新对齐
+      due[i] += kCanMessages[i].period_ms * kNanosecondsPerMs;
+      if (due[i] < Now()) due[i] = Now();
+    }
+  }
+}
+
+CanJitter CanSender::Jitter(int message) const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  const Histogram& stats = stats_[message];
+  CanJitter jitter;
+  jitter.frames = stats.frames;
+  jitter.errors = stats.errors;
+  if (stats.frames == 0) return jitter;
+  jitter.mean_us = stats.sum_us / stats.frames;
+  jitter.max_us = stats.max_us;
+
+  uint64_t p50 = (stats.frames + 1) / 2;
+  uint64_t p99 = std::max<uint64_t>(1, std::ceil(0.99 * stats.frames));
+  uint64_t cumulative = 0;
+  for (int bin = 0; bin < kBins; bin++) {
+    uint64_t before = cumulative;
+    cumulative += stats.counts[bin];
+    double upper = std::min((bin + 1) * kBinUs, stats.max_us);
+    if (before < p50 && cumulative >= p50) jitter.p50_us = upper;
+    if (before < p99 && cumulative >= p99) jitter.p99_us = upper;
+  }
+  return jitter;
+}
+
+void CanSender::PrintJitter() const {
+  printf("CAN %s jitter (us):\n", interface_.c_str());
+  printf("  %-14s %6s %10s %8s %8s %8s %8s %7s\n", "message", "id", "frames",
+         "mean", "p50", "p99", "max", "errors");
+  for (int i = 0; i < kCanNumMessages; i++) {
+    CanJitter jitter = Jitter(i);
+    printf("  %-14s %#6x %10llu %8.1f %8.1f %8.1f %8.1f %7llu\n",
+           kCanMessages[i].name, kCanMessages[i].id,
+           static_cast<unsigned long long>(jitter.frames), jitter.mean_us,
+           jitter.p50_us, jitter.p99_us, jitter.max_us,
+           static_cast<unsigned long long>(jitter.errors));
+  }
+}
+
+}  // namespace mjpc
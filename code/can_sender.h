@@ -0,0 +1,104 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_CAN_SENDER_H_
+#define MJPC_TASKS_SIMPLE_CAR_CAN_SENDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "mjpc/tasks/simple_car/telemetry.h"
+
+namespace mjpc {
+
+// 仪表盘 CAN 报文（标准帧，DLC 8，小端）：
+//   byte 0-1 信号 1，byte 2-3 信号 2（无则为 0），
+//   byte 6 低 4 位滚动计数，byte 7 校验和（id 与 byte 0-6 之和取低 8 位）
+struct CanMessage {
+  uint32_t id;
+  int period_ms;
+  const char* name;
+};
+
+inline constexpr int kCanNumMessages = 4;
+inline constexpr CanMessage kCanMessages[kCanNumMessages] = {
+    {0x100, 10, "VehicleSpeed"},    // u16 速度，0.01 km/h
+    {0x110, 20, "EngineSpeed"},     // u16 转速，0.25 rpm
+    {0x200, 100, "FuelLevel"},      // u16 油量，0.01 %
+    {0x210, 100, "CoolantTemp"},    // u16 温度，0.1 °C，偏移 -40 °C
+};
+
+// 编码一帧数据区
+void EncodeCanPayload(int message, const DashboardSnapshot& snapshot,
+                      uint8_t counter, uint8_t payload[8]);
+
+// 发送时刻相对计划时刻的偏差统计（微秒）
+struct CanJitter {
+  uint64_t frames = 0;
+  uint64_t errors = 0;  // 写入失败（例如接口缓冲区满）
+  double mean_us = 0.0;
+  double p50_us = 0.0;
+  double p99_us = 0.0;
+  double max_us = 0.0;
+};
+
+// SocketCAN 发送线程：按各报文周期从顺序锁读取最新快照并写入接口
+//   用绝对时刻 clock_nanosleep 调度，偏差不会累积；仿真线程只发布快照
+class CanSender {
+ public:
+  CanSender() = default;
+  ~CanSender();
+  CanSender(const CanSender&) = delete;
+  CanSender& operator=(const CanSender&) = delete;
+
+  // 打开接口（例如 vcan0）并启动发送线程
+  bool Start(const DashboardTelemetry* telemetry,
+             const std::string& interface);
+  void Stop();
+  bool IsRunning() const { return thread_.joinable(); }
+
+  // 偏差统计（任意线程）
+  CanJitter Jitter(int message) const;
+  void PrintJitter() const;
+
+ private:
+  // 偏差直方图：10 us 一格，最后一格收集更大的偏差
+  static constexpr int kBins = 1000;
+  static constexpr double kBinUs = 10.0;
+  struct Histogram {
+    uint64_t counts[kBins] = {0};
+    uint64_t frames = 0;
+    uint64_t errors = 0;
+    double sum_us = 0.0;
+    double max_us = 0.0;
+  };
+
+  void Loop();
+
+  const DashboardTelemetry* telemetry_ = nullptr;
+  std::string interface_;
+  int socket_ = -1;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+
+  mutable std::mutex stats_mutex_;
+  Histogram stats_[kCanNumMessages];
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_CAN_SENDER_H_
@@ -0,0 +1,548 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/car_mppi.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/task.h"
+#include "mjpc/threadpool.h"
+#include "mjpc/utilities.h"
+#include "mjpc/tasks/simple_car/car_rollout.h"
+#include "mjpc/tasks/simple_car/car_sysid.h"
+#include "mjpc/tasks/simple_car/mlp_surrogate.h"
+#include "mjpc/tasks/simple_car/param_reload.h"
+#include "mjpc/tasks/simple_car/planner_warmup.h"
+#include "mjpc/tasks/simple_car/rollout_grid.h"
+
+namespace mjpc {
+
+namespace {
+
+// 每次从任务队列取的样本数
+constexpr int kSamplesPerBlock = 4;
+
+// 以下归约都用 4 路独立累加：不依赖 -ffast-math 编译器也能向量化，
+//   且求和顺序固定，结果与线程数无关
+
+double Dot(const double* a, const double* b, int n) {
+  double acc[4] = {0.0, 0.0, 0.0, 0.0};
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (int k = 0; k < 4; k++) acc[k] += a[i + k] * b[i + k];
+  }
+  for (; i < n; i++) acc[0] += a[i] * b[i];
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// 最小值、和、平方和
+void Moments(const double* x, int n, double* min, double* sum, double* sum2) {
+  double lo[4], s[4] = {0.0}, s2[4] = {0.0};
+  std::fill(lo, lo + 4, std::numeric_limits<double>::infinity());
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (int k = 0; k < 4; k++) {
+      lo[k] = std::min(lo[k], x[i + k]);
+      s[k] += x[i + k];
+      s2[k] += x[i + k] * x[i + k];
+    }
+  }
+  for (; i < n; i++) {
+    lo[0] = std::min(lo[0], x[i]);
+    s[0] += x[i];
+    s2[0] += x[i] * x[i];
+  }
+  *min = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+  *sum = (s[0] + s[1]) + (s[2] + s[3]);
+  *sum2 = (s2[0] + s2[1]) + (s2[2] + s2[3]);
+}
+
+// 有限值的最小值、和、平方和与个数（非有限值跳过）
+void FiniteMoments(const double* x, int n, double* min, double* sum,
+                   double* sum2, int* count) {
+  double lo[4], s[4] = {0.0}, s2[4] = {0.0};
+  int c[4] = {0};
+  std::fill(lo, lo + 4, std::numeric_limits<double>::infinity());
+  for (int i = 0; i < n; i++) {
+    int k = i & 3;
+    double v = x[i];
+    if (!std::isfinite(v)) continue;
+    lo[k] = std::min(lo[k], v);
+    s[k] += v;
+    s2[k] += v * v;
+    c[k]++;
+  }
+  *min = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+  *sum = (s[0] + s[1]) + (s[2] + s[3]);
+  *sum2 = (s2[0] + s2[1]) + (s2[2] + s2[3]);
+  *count = (c[0] + c[1]) + (c[2] + c[3]);
+}
+
+}  // namespace
+
+MppiWeighting ComputeMppiWeights(const double* costs, int n,
+                                 double temperature, double* weights) {
+  // 第一遍：有限代价的最小值、均值、标准差（发散的 rollout 不参与统计）
+  MppiWeighting result;
+  double min, sum, sum2;
+  FiniteMoments(costs, n, &min, &sum, &sum2, &result.finite);
+  if (result.finite == 0) return result;
+  result.min = min;
+  result.mean = sum / result.finite;
+  double variance = sum2 / result.finite - result.mean * result.mean;
+  result.deviation = std::sqrt(std::max(variance, 0.0));
+  for (int i = 0; i < n; i++) {
+    if (costs[i] == min) {
+      result.best = i;
+      break;
+    }
+  }
+  if (!weights) {
+    result.free_energy = min;
+    result.effective_samples = 1.0;
+    return result;
+  }
+
+  // 第二遍：指数权重（减去最小值，最大权重为 1，不会上溢；非有限代价为 0）
+  result.lambda =
+      temperature *
+      std::max(result.deviation, 1e-9 * std::max(1.0, std::abs(result.mean)));
+  double scale = -1.0 / result.lambda;
+  for (int i = 0; i < n; i++) {
+    weights[i] =
+        std::isfinite(costs[i]) ? std::exp(scale * (costs[i] - min)) : 0.0;
+  }
+  double weight_sum, weight_sum2, weight_min;
+  Moments(weights, n, &weight_min, &weight_sum, &weight_sum2);
+  result.weight_sum = weight_sum;
+
+  // log-sum-exp：log Σ exp(-c / λ) = -c_min / λ + log Σ w
+  result.free_energy =
+      min - result.lambda * std::log(weight_sum / result.finite);
+  result.effective_samples = weight_sum * weight_sum / weight_sum2;
+  return result;
+}
+
+bool AdaptiveSamplesConverged(const double* costs, int n, int top_k,
+                              double tolerance, double* scratch) {
+  int finite = 0;
+  for (int i = 0; i < n; i++) {
+    if (std::isfinite(costs[i])) scratch[finite++] = costs[i];
+  }
+  if (finite == 0) return false;
+  int k = std::clamp(top_k, 1, finite);
+  std::partial_sort(scratch, scratch + k, scratch + finite);
+  double best = scratch[0];
+  // 尺度取最优代价：名义代价很大（例如刚换目标）时不会过早停止
+  double threshold = tolerance * std::max(std::abs(best), 1e-12);
+
+  // 最优样本几乎没有改进名义控制：名义控制已接近最优（例如直行驶向目标）
+  if (std::isfinite(costs[0]) && costs[0] - best < threshold) return true;
+
+  // 前 k 个代价几乎相同：新样本很难再明显优于当前最优
+  if (k < 2) return false;
+  return scratch[k - 1] - best < threshold;
+}
+
+CarMppiPlanner::Config CarMppiPlanner::Config::FromModel(
+    const mjModel* model) {
+  Config config;
+  config.num_samples =
+      GetNumberOrDefault(config.num_samples, model, "mppi_samples");
+  config.num_knots =
+      GetNumberOrDefault(config.num_knots, model, "sampling_spline_points");
+  config.horizon = GetNumberOrDefault(config.horizon, model, "agent_horizon");
+  config.exploration =
+      GetNumberOrDefault(config.exploration, model, "sampling_exploration");
+  config.min_samples =
+      GetNumberOrDefault(config.min_samples, model, "mppi_samples_min");
+  config.tolerance =
+      GetNumberOrDefault(config.tolerance, model, "mppi_adaptive_tolerance");
+  config.sample_batch =
+      GetNumberOrDefault(config.sample_batch, model, "mppi_sample_batch");
+  config.top_k = GetNumberOrDefault(config.top_k, model, "mppi_top_k");
+  config.temperature =
+      GetNumberOrDefault(config.temperature, model, "mppi_temperature");
+  config.grid = RolloutGridConfig::FromModel(model);
+  config.update = GetNumberOrDefault(static_cast<int>(config.update), model,
+                                     "mppi_update") == kBestSample
+                      ? kBestSample
+                      : kMppi;
+  config.backend = GetNumberOrDefault(static_cast<int>(config.backend), model,
+                                      "mppi_rollout_backend") == kMlp
+                       ? kMlp
+                       : kPhysics;
+  return config;
+}
+
+CarMppiPlanner::~CarMppiPlanner() {
+  for (Worker& worker : workers_) {
+    if (worker.data) mj_deleteData(worker.data);
+  }
+  if (coarse_model_) mj_deleteModel(coarse_model_);
+}
+
+void CarMppiPlanner::Allocate(const mjModel* model, const Config& config,
+                              int num_residual, int num_threads) {
+  model_ = model;
+  config_ = config;
+  num_residual_ = num_residual;
+  config_.num_samples = std::max(config_.num_samples, 1);
+  config_.num_knots = std::max(config_.num_knots, 1);
+  config_.sample_batch = std::max(config_.sample_batch, 1);
+  nu_ = model->nu;
+  rows_ = config_.num_knots * nu_;
+  stride_ = (config_.num_samples + 3) / 4 * 4;
+  grid_.Build(config_.horizon, model->opt.timestep, config_.grid);
+  steps_ = grid_.steps();
+  if (coarse_model_) mj_deleteModel(coarse_model_);
+  coarse_model_ =
+      grid_.uniform() ? nullptr : MakeCoarseRolloutModel(model, config_.grid);
+  coarse_fingerprint_ = coarse_model_ ? CarModelFingerprint(model) : 0;
+  knot_dt_ = config_.num_knots > 1
+                 ? config_.horizon / (config_.num_knots - 1)
+                 : config_.horizon;
+
+  nominal_.assign(rows_, 0.0);
+  noise_.assign(rows_ * stride_, 0.0);
+  costs_.assign(stride_, 0.0);
+  weights_.assign(stride_, 0.0);
+  scratch_.resize(rows_);
+  top_.resize(stride_);
+
+  ctrl_lower_.resize(nu_);
+  ctrl_upper_.resize(nu_);
+  ctrl_scale_.resize(nu_);
+  for (int j = 0; j < nu_; j++) {
+    bool limited = model->actuator_ctrllimited[j];
+    ctrl_lower_[j] = limited ? model->actuator_ctrlrange[2 * j] : -mjMAXVAL;
+    ctrl_upper_[j] = limited ? model->actuator_ctrlrange[2 * j + 1] : mjMAXVAL;
+    ctrl_scale_[j] = limited ? 0.5 * (ctrl_upper_[j] - ctrl_lower_[j]) : 1.0;
+  }
+
+  step_knot_.resize(steps_);
+  step_fraction_.resize(steps_);
+  for (int t = 0; t < steps_; t++) {
+    double s = grid_.times[t] / knot_dt_;
+    int k = std::min(static_cast<int>(s), config_.num_knots - 1);
+    step_knot_[t] = k;
+    step_fraction_[t] =
+        k + 1 < config_.num_knots ? std::min(s - k, 1.0) : 0.0;
+  }
+
+  for (Worker& worker : workers_) {
+    if (worker.data) mj_deleteData(worker.data);
+  }
+  // Allocate 也是模型重载后的重新分配路径：每线程 mjData 在这里预触碰，
+  //   第一次迭代不再为 arena 缺页（其余缓冲区由 assign/resize 清零时触碰）
+  workers_.resize(std::max(num_threads, 1));
+  for (Worker& worker : workers_) {
+    worker.data = mj_makeData(model);
+    PrefaultData(model, worker.data);
+    worker.rollout.Allocate(model, num_residual, steps_);
+    worker.rollout.set_mode(CarRollout::kFused);
+    worker.ctrl.resize(steps_ * nu_);
+    worker.residual.resize(num_residual);
+    worker.surrogate = surrogate_;
+  }
+  CarControlIndices(model, ctrl_index_);
+
+  rng_.seed(config_.seed);
+  stats_ = Stats();
+}
+
+void CarMppiPlanner::set_surrogate(const MlpSurrogate& surrogate) {
+  surrogate_ = surrogate;
+  for (Worker& worker : workers_) worker.surrogate = surrogate_;
+}
+
+void CarMppiPlanner::UpdateModel() {
+  if (!coarse_model_) return;
+  UpdateCoarseRolloutModel(coarse_model_, model_, config_.grid);
+  coarse_fingerprint_ = CarModelFingerprint(model_);
+}
+
+void CarMppiPlanner::Reload(const ParamChange& change,
+                            const std::function<void(Config*)>& adjust) {
+  if (!model_) return;
+  if (!change.planner) {
+    UpdateModel();
+    return;
+  }
+  Config config = Config::FromModel(model_);
+  config.seed = config_.seed;
+  if (adjust) adjust(&config);
+  std::vector<double> nominal = std::move(nominal_);
+  Allocate(model_, config, num_residual_, static_cast<int>(workers_.size()));
+  if (nominal.size() == nominal_.size()) nominal_ = std::move(nominal);
+}
+
+void CarMppiPlanner::Reset() {
+  std::fill(nominal_.begin(), nominal_.end(), 0.0);
+  for (int j = 0; j < nu_; j++) {
+    // 零不在控制范围内时取范围中点
+    if (ctrl_lower_[j] > 0.0 || ctrl_upper_[j] < 0.0) {
+      for (int k = 0; k < config_.num_knots; k++) {
+        nominal_[k * nu_ + j] = 0.5 * (ctrl_lower_[j] + ctrl_upper_[j]);
+      }
+    }
+  }
+  stats_ = Stats();
+}
+
+void CarMppiPlanner::Sample() {
+  // 样本 0 为名义控制；扰动后的节点截断到控制范围，保存截断后的实际扰动，
+  //   这样加权平均仍在范围内
+  std::normal_distribution<double> gaussian(0.0, 1.0);
+  for (int r = 0; r < rows_; r++) {
+    int j = r % nu_;
+    double sigma = config_.exploration * ctrl_scale_[j];
+    double* row = noise_.data() + r * stride_;
+    row[0] = 0.0;
+    for (int i = 1; i < config_.num_samples; i++) {
+      double u = std::clamp(nominal_[r] + sigma * gaussian(rng_),
+                            ctrl_lower_[j], ctrl_upper_[j]);
+      row[i] = u - nominal_[r];
+    }
+    std::fill(row + config_.num_samples, row + stride_, 0.0);
+  }
+}
+
+void CarMppiPlanner::SampleControl(int i, int t, double* ctrl) const {
+  // 样本 i 的节点（SoA 中的第 i 列）在第 t 步起点的插值
+  int k = step_knot_[t];
+  double f = step_fraction_[t];
+  int k1 = f > 0.0 ? k + 1 : k;
+  for (int j = 0; j < nu_; j++) {
+    int r0 = k * nu_ + j, r1 = k1 * nu_ + j;
+    double u0 = nominal_[r0] + noise_[r0 * stride_ + i];
+    double u1 = nominal_[r1] + noise_[r1 * stride_ + i];
+    ctrl[j] = u0 + f * (u1 - u0);
+  }
+}
+
+void CarMppiPlanner::RolloutSamples(const mjData* state,
+                                    const ResidualFn& residual,
+                                    ThreadPool& pool, int begin, int end) {
+  // 代理模型按批前进，每次取一整批样本
+  bool surrogate = uses_surrogate();
+  int block_size = surrogate ? kMlpBatchAlign : kSamplesPerBlock;
+  std::atomic<int> next_sample{begin};
+  int num_workers = std::min<int>(workers_.size(),
+                                  (end - begin + block_size - 1) / block_size);
+  int count_before = pool.GetCount();
+  for (int w = 0; w < num_workers; w++) {
+    pool.Schedule([&, w]() {
+      Worker& worker = workers_[w];
+      mjData* data = worker.data;
+      while (true) {
+        int block = next_sample.fetch_add(block_size);
+        if (block >= end) break;
+        int block_end = std::min(block + block_size, end);
+        if (surrogate) {
+          SurrogateRollout(worker, state, residual, block, block_end);
+          continue;
+        }
+        for (int i = block; i < block_end; i++) {
+          for (int t = 0; t < steps_; t++) {
+            SampleControl(i, t, worker.ctrl.data() + t * nu_);
+          }
+
+          data->time = state->time;
+          mju_copy(data->qpos, state->qpos, model_->nq);
+          mju_copy(data->qvel, state->qvel, model_->nv);
+          mju_copy(data->act, state->act, model_->na);
+          mju_copy(data->qacc_warmstart, state->qacc_warmstart, model_->nv);
+          mju_copy(data->mocap_pos, state->mocap_pos, 3 * model_->nmocap);
+          mju_copy(data->mocap_quat, state->mocap_quat, 4 * model_->nmocap);
+          mju_copy(data->userdata, state->userdata, model_->nuserdata);
+          costs_[i] =
+              worker.rollout.Rollout(model_, coarse_model_, data, residual,
+                                     worker.ctrl.data(), nu_, grid_);
+        }
+      }
+    });
+  }
+  pool.WaitCount(count_before + num_workers);
+  pool.ResetCount();
+}
+
+void CarMppiPlanner::SurrogateRollout(Worker& worker, const mjData* state,
+                                      const ResidualFn& residual, int begin,
+                                      int end) {
+  int n = end - begin;
+  PlanarCarBatch& batch = worker.batch;
+  batch.Resize(n);
+  int stride = batch.stride;
+  worker.batch_ctrl.assign(2 * stride, 0.0f);
+  worker.batch_costs.assign(n, 0.0);
+  PlanarCarState start = ExtractPlanarState(state->qpos, state->qvel);
+  for (int b = 0; b < n; b++) batch.Set(b, start);
+
+  // 残差只读平面状态、控制、时间和 mocap：其余状态保持起点的值
+  mjData* data = worker.data;
+  mju_copy(data->qpos, state->qpos, model_->nq);
+  mju_copy(data->qvel, state->qvel, model_->nv);
+  mju_copy(data->mocap_pos, state->mocap_pos, 3 * model_->nmocap);
+  mju_copy(data->mocap_quat, state->mocap_quat, 4 * model_->nmocap);
+  // userdata 是每个样本自己的 rollout 状态（如残差的目标切换锁存）
+  int nuserdata = model_->nuserdata;
+  worker.batch_userdata.resize(n * nuserdata);
+  for (int b = 0; b < n; b++) {
+    mju_copy(worker.batch_userdata.data() + b * nuserdata, state->userdata,
+             nuserdata);
+  }
+
+  const MlpSurrogate& surrogate = worker.surrogate;
+  double* r = worker.residual.data();
+  for (int t = 0; t < steps_; t++) {
+    data->time = state->time + grid_.times[t];
+    double weight = grid_.weight(t);
+    for (int b = 0; b < n; b++) {
+      SampleControl(begin + b, t, data->ctrl);
+      worker.batch_ctrl[b] = data->ctrl[ctrl_index_[0]];
+      worker.batch_ctrl[stride + b] = data->ctrl[ctrl_index_[1]];
+
+      // 平面状态写回自由关节（车身保持水平）
+      PlanarCarState s = batch.Get(b);
+      data->qpos[0] = s.pos[0];
+      data->qpos[1] = s.pos[1];
+      data->qpos[3] = std::cos(0.5 * s.heading);
+      data->qpos[4] = 0.0;
+      data->qpos[5] = 0.0;
+      data->qpos[6] = std::sin(0.5 * s.heading);
+      data->qvel[0] = s.speed * std::cos(s.heading);
+      data->qvel[1] = s.speed * std::sin(s.heading);
+      data->qvel[5] = s.yaw_rate;
+      double* userdata = worker.batch_userdata.data() + b * nuserdata;
+      mju_copy(data->userdata, userdata, nuserdata);
+      residual.Residual(model_, data, r);
+      mju_copy(userdata, data->userdata, nuserdata);
+      worker.batch_costs[b] += residual.CostValue(r) * weight;
+    }
+
+    // 网格步长按代理模型步长取整（至少一步）
+    int substeps = std::max(
+        1, static_cast<int>(std::lround(grid_.duration(t) / surrogate.dt())));
+    for (int i = 0; i < substeps; i++) {
+      surrogate.Step(worker.batch_ctrl.data(), &batch);
+    }
+  }
+  std::copy_n(worker.batch_costs.data(), n, costs_.data() + begin);
+}
+
+bool CarMppiPlanner::Converged(int n) {
+  return AdaptiveSamplesConverged(costs_.data(), n, config_.top_k,
+                                  config_.tolerance, top_.data());
+}
+
+void CarMppiPlanner::Optimize(const mjData* state, const ResidualFn& residual,
+                              ThreadPool& pool) {
+  auto start = std::chrono::steady_clock::now();
+  // 粗模型是规划模型的副本：参数被修改（如 GUI 调参）后重新复制
+  if (coarse_model_ && CarModelFingerprint(model_) != coarse_fingerprint_) {
+    UpdateModel();
+  }
+  Sample();
+
+  // 自适应：先做下限条数，之后逐批增加，收敛后停止
+  int n = config_.num_samples;
+  if (config_.min_samples > 0 && config_.min_samples < config_.num_samples) {
+    n = config_.min_samples;
+    RolloutSamples(state, residual, pool, 0, n);
+    while (n < config_.num_samples && !Converged(n)) {
+      int end = std::min(n + config_.sample_batch, config_.num_samples);
+      RolloutSamples(state, residual, pool, n, end);
+      n = end;
+    }
+  } else {
+    RolloutSamples(state, residual, pool, 0, n);
+  }
+
+  auto rolled = std::chrono::steady_clock::now();
+  UpdatePolicy(n);
+  auto updated = std::chrono::steady_clock::now();
+  stats_.samples = n;
+  stats_.rollout_ms =
+      std::chrono::duration<double, std::milli>(rolled - start).count();
+  stats_.update_us =
+      std::chrono::duration<double, std::micro>(updated - rolled).count();
+}
+
+void CarMppiPlanner::UpdatePolicy(int n) {
+  const double* costs = costs_.data();
+  bool best_sample = config_.update == kBestSample;
+  double* weights = weights_.data();
+  MppiWeighting weighting = ComputeMppiWeights(
+      costs, n, config_.temperature, best_sample ? nullptr : weights);
+  stats_.cost_nominal = costs[0];
+  stats_.cost_min = weighting.min;
+  stats_.cost_mean = weighting.mean;
+  stats_.cost_std = weighting.deviation;
+  stats_.free_energy = weighting.free_energy;
+  stats_.effective_samples = weighting.effective_samples;
+  stats_.best = weighting.best;
+  stats_.rejected = n - weighting.finite;
+
+  // 所有 rollout 都发散：保持名义控制
+  if (weighting.finite == 0) return;
+
+  if (best_sample) {
+    int best = weighting.best;
+    for (int r = 0; r < rows_; r++) nominal_[r] += noise_[r * stride_ + best];
+    return;
+  }
+
+  // 第三遍：每行（节点 × 控制）与权重做点积
+  double normalize = 1.0 / weighting.weight_sum;
+  for (int r = 0; r < rows_; r++) {
+    nominal_[r] += normalize * Dot(weights, noise_.data() + r * stride_, n);
+  }
+}
+
+void CarMppiPlanner::Interpolate(const double* knots, double time,
+                                 double* ctrl) const {
+  double s = std::max(time, 0.0) / knot_dt_;
+  int k = std::min(static_cast<int>(s), config_.num_knots - 1);
+  double f = k + 1 < config_.num_knots ? std::min(s - k, 1.0) : 0.0;
+  int k1 = f > 0.0 ? k + 1 : k;
+  for (int j = 0; j < nu_; j++) {
+    double u0 = knots[k * nu_ + j], u1 = knots[k1 * nu_ + j];
+    ctrl[j] = u0 + f * (u1 - u0);
+  }
+}
+
+void CarMppiPlanner::Shift(double time) {
+  if (time <= 0.0) return;
+  for (int k = 0; k < config_.num_knots; k++) {
+    Interpolate(nominal_.data(), k * knot_dt_ + time,
+                scratch_.data() + k * nu_);
+  }
+  nominal_.swap(scratch_);
+}
+
+void CarMppiPlanner::Action(double time, double* ctrl) const {
+  Interpolate(nominal_.data(), time, ctrl);
+}
+
+}  // namespace mjpc
@@ -0,0 +1,221 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_CAR_MPPI_H_
+#define MJPC_TASKS_SIMPLE_CAR_CAR_MPPI_H_
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/task.h"
+#include "mjpc/threadpool.h"
+#include "mjpc/tasks/simple_car/car_rollout.h"
+#include "mjpc/tasks/simple_car/mlp_surrogate.h"
+#include "mjpc/tasks/simple_car/param_reload.h"
+#include "mjpc/tasks/simple_car/rollout_grid.h"
+
+namespace mjpc {
+
+// 代价统计与 MPPI 权重（只计有限代价，非有限代价的权重为 0）
+struct MppiWeighting {
+  int finite = 0;  // 有限代价个数（为 0 时不更新名义控制）
+  int best = 0;    // 最小有限代价的样本
+  double min = 0.0;
+  double mean = 0.0;
+  double deviation = 0.0;
+  double lambda = 0.0;       // temperature × 代价标准差
+  double weight_sum = 0.0;   // Σw，w_i = exp(-(c_i - c_min) / λ)，最大为 1
+  double free_energy = 0.0;  // -λ log mean exp(-c / λ)（log-sum-exp）
+  double effective_samples = 0.0;  // (Σw)² / Σw²
+};
+
+// weights 为 nullptr 时只计算代价统计（最优样本更新），free_energy 取 min
+MppiWeighting ComputeMppiWeights(const double* costs, int n,
+                                 double temperature, double* weights);
+
+// 自适应样本数的停止判据（非有限代价不计），scratch 至少 n 个元素
+//   最优有限代价相对 costs[0] 的改进，或前 top_k 个有限代价的差距，
+//   小于 tolerance × max(|最优代价|, ε) 时返回 true
+bool AdaptiveSamplesConverged(const double* costs, int n, int top_k,
+                              double tolerance, double* scratch);
+
+// SimpleCar 采样规划器：名义控制为线性插值样条，每次迭代在节点上加高斯扰动，
+//   并行 rollout 后更新名义控制
+//   kBestSample：取代价最小的样本（与 mjpc 采样规划器相同）
+//   kMppi：路径积分加权平均，w_i = exp(-(c_i - c_min) / λ)，λ = temperature × 代价标准差
+// 扰动按 [节点 × 控制][样本] 存放（SoA），统计、权重和加权更新都是对连续数组的单遍扫描
+// 自适应样本数（min_samples < num_samples 时）：先做 min_samples 条，之后每批 sample_batch 条，
+//   每批后检查代价统计，名义控制已接近最优（最优样本相对名义的改进小于 tolerance）
+//   或前 top_k 个代价已几乎相同（相对差小于 tolerance）时停止，最多 num_samples 条；
+//   相对差以 max(|最优代价|, ε) 为尺度
+// rollout 按 RolloutGrid 执行：近端逐步仿真，远端粗步长多子步，代价按步长加权
+// kMlp 后端用 MlpSurrogate 按批前进平面状态，残差在写回 qpos / qvel 的 data 上评估
+//   （不调用 mj_step；只适用于残差只读位置、速度、控制和 mocap 的任务，如 SimpleCar）
+class CarMppiPlanner {
+ public:
+  enum Update : int {
+    kBestSample = 0,
+    kMppi,
+  };
+
+  // rollout 后端
+  enum Backend : int {
+    kPhysics = 0,  // MuJoCo（规划模型 / 粗模型）
+    kMlp,          // MLP 代理模型（未设置有效代理模型时退回 kPhysics）
+  };
+
+  struct Config {
+    int num_samples = 64;     // 每次迭代的 rollout 数上限（含名义控制本身）
+    int min_samples = 0;      // mppi_samples_min：自适应下限（0 或不小于上限时固定）
+    int sample_batch = 8;     // mppi_sample_batch：达到下限后每批增加的样本数
+    int top_k = 8;            // mppi_top_k：判断收敛的最优代价个数
+    double tolerance = 0.01;  // mppi_adaptive_tolerance：相对代价差
+    int num_knots = 10;       // sampling_spline_points
+    double horizon = 2.0;     // agent_horizon（秒）
+    double exploration = 0.5;  // sampling_exploration：扰动标准差 / 控制范围半宽
+    double temperature = 0.2;  // mppi_temperature
+    Update update = kBestSample;  // mppi_update
+    RolloutGridConfig grid;   // rollout 时间网格（默认均匀）
+    Backend backend = kPhysics;  // mppi_rollout_backend
+    uint64_t seed = 0;
+
+    // 从任务 numeric 读取（缺省时取上面的默认值）
+    static Config FromModel(const mjModel* model);
+  };
+
+  struct Stats {
+    double cost_nominal = 0.0;  // 名义控制（样本 0）的代价
+    double cost_min = 0.0;
+    double cost_mean = 0.0;
+    double cost_std = 0.0;
+    double free_energy = 0.0;        // -λ log mean exp(-c / λ)（log-sum-exp）
+    double effective_samples = 0.0;  // (Σw)² / Σw²，kBestSample 时为 1
+    int best = 0;
+    int samples = 0;  // 本次迭代实际使用的样本数
+    int rejected = 0;  // 其中代价非有限（粗步发散）的样本数
+    double rollout_ms = 0.0;
+    double update_us = 0.0;  // 统计与名义控制更新
+  };
+
+  CarMppiPlanner() = default;
+  ~CarMppiPlanner();
+  CarMppiPlanner(const CarMppiPlanner&) = delete;
+  CarMppiPlanner& operator=(const CarMppiPlanner&) = delete;
+
+  // 分配缓冲区和每个线程的 mjData / rollout；model 为规划模型
+  //   （时间步长即精细段的 rollout 步长），在规划器之后释放
+  void Allocate(const mjModel* model, const Config& config, int num_residual,
+                int num_threads);
+
+  // 名义控制置零
+  void Reset();
+
+  // 规划模型参数被修改后（尺寸不变）重新复制粗模型；
+  //   Optimize 按 CarModelFingerprint 检测到变化时也会调用
+  void UpdateModel();
+
+  // 参数热重载：规划模型已按 change.snapshot 修改（PatchModelParameters）。
+  //   规划器设置变化时按 Config::FromModel 重新读取并重新分配（名义控制尺寸
+  //   不变时保留），否则只更新粗模型；adjust 在重新读取后应用调用方的覆盖。
+  //   不能与 Optimize 同时调用
+  void Reload(const ParamChange& change,
+              const std::function<void(Config*)>& adjust = nullptr);
+
+  // 从 state 的当前状态做一次迭代（residual 只读，各线程共用）
+  void Optimize(const mjData* state, const ResidualFn& residual,
+                ThreadPool& pool);
+
+  // 名义控制沿时间平移（重新规划前调用），超出 horizon 的部分保持末端值
+  void Shift(double time);
+
+  // 名义控制在 time（相对本次规划起点）的取值
+  void Action(double time, double* ctrl) const;
+
+  // kMlp 后端使用的代理模型：复制到每个线程（推理缓冲区不能共享），
+  //   Allocate 前后调用均可；dt 应不大于网格步长
+  void set_surrogate(const MlpSurrogate& surrogate);
+  bool uses_surrogate() const {
+    return config_.backend == kMlp && surrogate_.valid() &&
+           surrogate_.dt() > 0.0;
+  }
+
+  void set_update(Update update) { config_.update = update; }
+  const Config& config() const { return config_; }
+  const Stats& stats() const { return stats_; }
+  int steps() const { return steps_; }  // 网格步数（残差评估次数）
+  const RolloutGrid& grid() const { return grid_; }
+  const double* nominal() const { return nominal_.data(); }  // [num_knots][nu]
+
+ private:
+  struct Worker {
+    mjData* data = nullptr;
+    CarRollout rollout;
+    std::vector<double> ctrl;  // [steps][nu]
+    std::vector<double> residual;  // [num_residual]
+    MlpSurrogate surrogate;
+    PlanarCarBatch batch;
+    std::vector<float> batch_ctrl;     // [2][batch.stride]
+    std::vector<double> batch_costs;   // [kMlpBatchAlign]
+    std::vector<double> batch_userdata;  // [kMlpBatchAlign][nuserdata]
+  };
+
+  void Sample();
+  void RolloutSamples(const mjData* state, const ResidualFn& residual,
+                      ThreadPool& pool, int begin, int end);
+  // 样本 i 在网格第 t 步的控制量
+  void SampleControl(int i, int t, double* ctrl) const;
+  // 代理模型 rollout：样本 [begin, end)（不超过 kMlpBatchAlign 条）同时前进
+  void SurrogateRollout(Worker& worker, const mjData* state,
+                        const ResidualFn& residual, int begin, int end);
+  bool Converged(int n);
+  void UpdatePolicy(int n);
+  void Interpolate(const double* knots, double time, double* ctrl) const;
+
+  const mjModel* model_ = nullptr;
+  mjModel* coarse_model_ = nullptr;  // 非均匀网格的粗段模型（自有）
+  uint64_t coarse_fingerprint_ = 0;  // 复制粗模型时规划模型的指纹
+  RolloutGrid grid_;
+  Config config_;
+  int num_residual_ = 0;
+  MlpSurrogate surrogate_;
+  int ctrl_index_[2] = {0, 1};  // forward / turn 执行器（代理模型输入）
+  int nu_ = 0;
+  int rows_ = 0;    // num_knots * nu
+  int stride_ = 0;  // num_samples 向上取整到 4
+  int steps_ = 0;
+  double knot_dt_ = 0.0;
+
+  std::vector<double> nominal_;  // [rows]
+  std::vector<double> noise_;    // [rows][stride]，已按控制范围截断
+  std::vector<double> costs_;    // [stride]
+  std::vector<double> weights_;  // [stride]
+  std::vector<double> scratch_;  // [rows]
+  std::vector<double> top_;      // [stride]，收敛判据的临时缓冲区
+  std::vector<double> ctrl_lower_, ctrl_upper_, ctrl_scale_;  // [nu]
+
+  // 每个网格步起点所在的节点区间与插值系数
+  std::vector<int> step_knot_;
+  std::vector<double> step_fraction_;
+
+  std::vector<Worker> workers_;
+  std::mt19937_64 rng_;
+  Stats stats_;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_CAR_MPPI_H_
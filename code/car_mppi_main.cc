@@ -0,0 +1,305 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 采样规划器对比：最优样本与 MPPI 加权平均，相同样本数、horizon 和样条节点
+//   （每次迭代的 rollout 步数相同，即计算量相同）
+//   car_mppi --episodes=8 --duration=6 --samples=64
+// 使用非均匀 rollout 网格（rollout_grid_fine > 0）时，另外给出均匀网格的 MPPI 作为对照
+// 设置了自适应下限（--min_samples 或 mppi_samples_min）时，另外对比两种更新方式的
+//   自适应样本数版本，报告每次迭代的平均样本数与耗时
+// 给出 --surrogate（MlpSurrogate 权重）时，另加一行 MLP rollout 后端的 MPPI
+// 每个回合从相同的随机初始状态和目标出发闭环仿真，报告闭环代价、末端距离、
+//   控制量变化（平滑程度）和每次迭代耗时
+// 模型中 task_param_reload > 0 时，回合之间检查 task.xml 的参数修改：
+//   规划器作为任务的参数监听者同步规划模型，规划器设置变化时重新读取并重新分配
+//   （命令行和各行的覆盖保留）
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/threadpool.h"
+#include "mjpc/tasks/simple_car/car_mppi.h"
+#include "mjpc/tasks/simple_car/car_rollout.h"
+#include "mjpc/tasks/simple_car/car_sysid.h"
+#include "mjpc/tasks/simple_car/mlp_surrogate.h"
+#include "mjpc/tasks/simple_car/rollout_grid.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+#include "mjpc/utilities.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(int, episodes, 8, "closed-loop episodes per update rule");
+ABSL_FLAG(double, duration, 6.0, "episode duration (s)");
+ABSL_FLAG(int, samples, 0, "rollouts per iteration (0: mppi_samples)");
+ABSL_FLAG(int, min_samples, -1,
+          "adaptive lower bound (-1: mppi_samples_min, 0: fixed only)");
+ABSL_FLAG(double, temperature, 0.0, "mppi temperature (0: mppi_temperature)");
+ABSL_FLAG(double, replan, 0.05, "replanning period (s)");
+ABSL_FLAG(double, reach, 0.1, "goal reached within this distance (m)");
+ABSL_FLAG(int, seed, 1, "episode seed");
+ABSL_FLAG(std::string, surrogate, "",
+          "MLP surrogate weights for an extra mppi row (mlp_surrogate --out)");
+ABSL_FLAG(int, threads, 0, "worker threads (0: hardware concurrency)");
+
+namespace {
+
+struct EpisodeSummary {
+  double cost = 0.0;            // 闭环代价（按时间积分）
+  double final_distance = 0.0;  // 末端到目标距离（米）
+  double reach_time = 0.0;      // 首次进入 reach 范围的时间（未到达为 duration）
+  double ctrl_variation = 0.0;  // 每秒控制量变化 Σ|Δu|
+  double iteration_ms = 0.0;
+  double update_us = 0.0;
+  double effective_samples = 0.0;
+  double samples = 0.0;  // 每次迭代的平均样本数
+  double rejected = 0.0;  // 每次迭代因粗步发散作废的平均样本数
+  int iterations = 0;
+};
+
+EpisodeSummary RunEpisode(const mjModel* model, mjData* data,
+                          const mjpc::ResidualFn& residual, int num_residual,
+                          mjpc::CarMppiPlanner* planner, mjpc::ThreadPool& pool,
+                          const mjpc::CarInitialState& initial) {
+  double duration = absl::GetFlag(FLAGS_duration);
+  double replan = std::max(absl::GetFlag(FLAGS_replan), model->opt.timestep);
+  double reach = absl::GetFlag(FLAGS_reach);
+
+  mjpc::CarRollout::SetState(model, data, initial);
+  planner->Reset();
+
+  EpisodeSummary summary;
+  summary.reach_time = duration;
+  std::vector<double> r(num_residual);
+  std::vector<double> previous(model->nu, 0.0);
+  double plan_time = 0.0;
+  bool planned = false;
+  bool reached = false;
+  while (data->time < duration) {
+    if (!planned || data->time - plan_time >= replan - 1e-9) {
+      if (planned) planner->Shift(data->time - plan_time);
+      plan_time = data->time;
+      planned = true;
+      planner->Optimize(data, residual, pool);
+      const mjpc::CarMppiPlanner::Stats& stats = planner->stats();
+      summary.iteration_ms += stats.rollout_ms + 1e-3 * stats.update_us;
+      summary.update_us += stats.update_us;
+      summary.effective_samples += stats.effective_samples;
+      summary.samples += stats.samples;
+      summary.rejected += stats.rejected;
+      summary.iterations++;
+    }
+    planner->Action(data->time - plan_time, data->ctrl);
+    for (int j = 0; j < model->nu; j++) {
+      summary.ctrl_variation += std::abs(data->ctrl[j] - previous[j]);
+      previous[j] = data->ctrl[j];
+    }
+
+    residual.Residual(model, data, r.data());
+    summary.cost += residual.CostValue(r.data()) * model->opt.timestep;
+    mj_step(model, data);
+
+    double distance = std::hypot(data->qpos[0] - initial.goal[0],
+                                 data->qpos[1] - initial.goal[1]);
+    if (!reached && distance < reach) {
+      reached = true;
+      summary.reach_time = data->time;
+    }
+    summary.final_distance = distance;
+  }
+  summary.ctrl_variation /= duration;
+  summary.iteration_ms /= std::max(summary.iterations, 1);
+  summary.update_us /= std::max(summary.iterations, 1);
+  summary.effective_samples /= std::max(summary.iterations, 1);
+  summary.samples /= std::max(summary.iterations, 1);
+  summary.rejected /= std::max(summary.iterations, 1);
+  return summary;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+  task.Reset(model);
+
+  // 规划模型：与 mjpc 的 agent 相同，rollout 步长取 agent_timestep
+  mjModel* plan_model = mj_copyModel(nullptr, model);
+  plan_model->opt.timestep =
+      mjpc::GetNumberOrDefault(0.02, model, "agent_timestep");
+
+  // 命令行覆盖：初始分配和参数热重载后重新读取设置时都应用
+  auto apply_flags = [](mjpc::CarMppiPlanner::Config* config) {
+    if (absl::GetFlag(FLAGS_samples) > 0) {
+      config->num_samples = absl::GetFlag(FLAGS_samples);
+    }
+    if (absl::GetFlag(FLAGS_min_samples) >= 0) {
+      config->min_samples = absl::GetFlag(FLAGS_min_samples);
+    }
+    if (absl::GetFlag(FLAGS_temperature) > 0.0) {
+      config->temperature = absl::GetFlag(FLAGS_temperature);
+    }
+  };
+  mjpc::CarMppiPlanner::Config config =
+      mjpc::CarMppiPlanner::Config::FromModel(model);
+  apply_flags(&config);
+
+  int threads = absl::GetFlag(FLAGS_threads);
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  mjpc::ThreadPool pool(threads);
+
+  // 所有回合共用的随机初始状态和目标
+  int episodes = std::max(1, absl::GetFlag(FLAGS_episodes));
+  std::mt19937 rng(absl::GetFlag(FLAGS_seed));
+  std::uniform_real_distribution<double> unit(-1.0, 1.0);
+  std::vector<mjpc::CarInitialState> initial(episodes);
+  for (mjpc::CarInitialState& state : initial) {
+    state.heading = M_PI * unit(rng);
+    state.goal[0] = 2.0 * unit(rng);
+    state.goal[1] = 2.0 * unit(rng);
+  }
+
+  mjData* data = mj_makeData(model);
+  mjpc::SimpleCar::ResidualFn residual(&task);
+
+  mjpc::MlpSurrogate surrogate;
+  std::string surrogate_path = absl::GetFlag(FLAGS_surrogate);
+  if (!surrogate_path.empty()) {
+    if (!surrogate.Load(surrogate_path)) {
+      std::fprintf(stderr, "failed to load '%s'\n", surrogate_path.c_str());
+      return 1;
+    }
+    if (surrogate.model_fingerprint() != mjpc::CarModelFingerprint(model)) {
+      std::fprintf(stderr, "warning: surrogate was trained on another model\n");
+    }
+  }
+
+  // 参数热重载：任务模型已修改，规划模型是副本，需按同一快照修改
+  mjpc::CarMppiPlanner* active_planner = nullptr;
+  std::function<void(mjpc::CarMppiPlanner::Config*)> active_overrides;
+  task.AddParamReloadListener([&](const mjpc::ParamChange& change) {
+    if (!mjpc::PatchModelParameters(*change.snapshot, plan_model)) return;
+    plan_model->opt.timestep =
+        mjpc::GetNumberOrDefault(0.02, plan_model, "agent_timestep");
+    if (active_planner) active_planner->Reload(change, active_overrides);
+  });
+
+  mjpc::RolloutGrid grid;
+  grid.Build(config.horizon, plan_model->opt.timestep, config.grid);
+  std::printf("%d episodes x %.1f s, up to %d samples per iteration "
+              "(%d knots, exploration %.2f), replan every %.3f s, "
+              "%d threads\n",
+              episodes, absl::GetFlag(FLAGS_duration), config.num_samples,
+              config.num_knots, config.exploration,
+              absl::GetFlag(FLAGS_replan), threads);
+  std::printf("rollout grid: %d steps, %d physics steps over %.2f s",
+              grid.steps(), grid.physics_steps, grid.times.back());
+  if (!grid.uniform()) {
+    std::printf(" (fine %.3f s for %.2f s, then %.3f s = substeps of %.3f s)",
+                grid.fine_step, config.grid.fine_duration,
+                config.grid.coarse_step, config.grid.coarse_substep);
+  }
+  std::printf("\n");
+  std::printf("  %-16s %9s %9s %9s %9s %8s %6s %6s %9s %9s %7s\n", "update",
+              "cost", "final m", "reach s", "|du|/s", "samples", "rej",
+              "phys", "iter ms", "update us", "ess");
+
+  // 非均匀网格时另加一行均匀网格的 MPPI 作为对照，有代理模型时另加一行 MLP 后端
+  bool adaptive = config.min_samples > 0 &&
+                  config.min_samples < config.num_samples;
+  struct {
+    const char* name;
+    mjpc::CarMppiPlanner::Update update;
+    bool adaptive;
+    bool uniform_grid;
+    bool mlp;
+  } rows[6] = {
+      {"best-sample", mjpc::CarMppiPlanner::kBestSample, false, false, false},
+      {"mppi", mjpc::CarMppiPlanner::kMppi, false, false, false},
+      {"mppi uniform", mjpc::CarMppiPlanner::kMppi, false, true, false},
+      {"mppi mlp", mjpc::CarMppiPlanner::kMppi, false, false, true},
+      {"best-sample ad.", mjpc::CarMppiPlanner::kBestSample, true, false,
+       false},
+      {"mppi adaptive", mjpc::CarMppiPlanner::kMppi, true, false, false}};
+  for (const auto& row : rows) {
+    if (row.adaptive && !adaptive) continue;
+    if (row.uniform_grid && grid.uniform()) continue;
+    if (row.mlp && !surrogate.valid()) continue;
+    mjpc::CarMppiPlanner planner;
+    auto overrides = [&](mjpc::CarMppiPlanner::Config* row_config) {
+      apply_flags(row_config);
+      row_config->update = row.update;
+      row_config->seed = absl::GetFlag(FLAGS_seed);
+      if (!row.adaptive) row_config->min_samples = 0;
+      if (row.uniform_grid) row_config->grid.fine_duration = 0.0;
+      row_config->backend = row.mlp ? mjpc::CarMppiPlanner::kMlp
+                                    : mjpc::CarMppiPlanner::kPhysics;
+    };
+    mjpc::CarMppiPlanner::Config row_config = config;
+    overrides(&row_config);
+    planner.set_surrogate(surrogate);
+    planner.Allocate(plan_model, row_config, task.num_residual, threads);
+    active_planner = &planner;
+    active_overrides = overrides;
+
+    EpisodeSummary mean;
+    for (const mjpc::CarInitialState& state : initial) {
+      task.PollParameters(model);
+      EpisodeSummary summary = RunEpisode(
+          model, data, residual, task.num_residual, &planner, pool, state);
+      mean.cost += summary.cost / episodes;
+      mean.final_distance += summary.final_distance / episodes;
+      mean.reach_time += summary.reach_time / episodes;
+      mean.ctrl_variation += summary.ctrl_variation / episodes;
+      mean.iteration_ms += summary.iteration_ms / episodes;
+      mean.update_us += summary.update_us / episodes;
+      mean.effective_samples += summary.effective_samples / episodes;
+      mean.samples += summary.samples / episodes;
+      mean.rejected += summary.rejected / episodes;
+    }
+    std::printf(
+        "  %-16s %9.3f %9.3f %9.2f %9.3f %8.1f %6.2f %6d %9.2f %9.1f %7.1f\n",
+        row.name, mean.cost, mean.final_distance, mean.reach_time,
+        mean.ctrl_variation, mean.samples, mean.rejected,
+        planner.grid().physics_steps,
+        mean.iteration_ms, mean.update_us, mean.effective_samples);
+    active_planner = nullptr;
+    active_overrides = nullptr;
+  }
+
+  mj_deleteData(data);
+  mj_deleteModel(plan_model);
+  mj_deleteModel(model);
+  return 0;
+}
@@ -0,0 +1,141 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/car_mppi.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace mjpc {
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr double kNan = std::numeric_limits<double>::quiet_NaN();
+
+TEST(MppiWeightsTest, MatchesDirectFormula) {
+  std::vector<double> costs = {3.0, 1.0, 2.0, 5.0, 1.5};
+  int n = costs.size();
+  std::vector<double> weights(n);
+  MppiWeighting w = ComputeMppiWeights(costs.data(), n, 0.5, weights.data());
+
+  EXPECT_EQ(w.finite, n);
+  EXPECT_EQ(w.best, 1);
+  EXPECT_DOUBLE_EQ(w.min, 1.0);
+  EXPECT_DOUBLE_EQ(w.mean, 2.5);
+  double deviation = std::sqrt((0.25 + 2.25 + 0.25 + 6.25 + 1.0) / n);
+  EXPECT_NEAR(w.deviation, deviation, 1e-12);
+  EXPECT_NEAR(w.lambda, 0.5 * deviation, 1e-12);
+
+  // 直接按定义计算（代价较小，不会下溢）
+  double sum = 0.0, sum2 = 0.0, partition = 0.0;
+  for (int i = 0; i < n; i++) {
+    double expected = std::exp(-(costs[i] - 1.0) / w.lambda);
+    EXPECT_NEAR(weights[i], expected, 1e-12);
+    sum += expected;
+    sum2 += expected * expected;
+    partition += std::exp(-costs[i] / w.lambda);
+  }
+  EXPECT_DOUBLE_EQ(weights[1], 1.0);
+  EXPECT_NEAR(w.weight_sum, sum, 1e-12);
+  EXPECT_NEAR(w.effective_samples, sum * sum / sum2, 1e-12);
+  EXPECT_NEAR(w.free_energy, -w.lambda * std::log(partition / n), 1e-12);
+}
+
+TEST(MppiWeightsTest, LogSumExpDoesNotOverflow) {
+  // exp(-c / λ) 直接计算会下溢为 0；减去最小值后权重与平移前相同
+  std::vector<double> small = {0.0, 1.0, 2.0, 4.0};
+  std::vector<double> large = small;
+  for (double& c : large) c += 1e6;
+  std::vector<double> w_small(4), w_large(4);
+  MppiWeighting a = ComputeMppiWeights(small.data(), 4, 0.2, w_small.data());
+  MppiWeighting b = ComputeMppiWeights(large.data(), 4, 0.2, w_large.data());
+  for (int i = 0; i < 4; i++) EXPECT_NEAR(w_small[i], w_large[i], 1e-9);
+  EXPECT_TRUE(std::isfinite(b.free_energy));
+  EXPECT_NEAR(b.free_energy - 1e6, a.free_energy, 1e-6);
+  EXPECT_NEAR(b.effective_samples, a.effective_samples, 1e-9);
+}
+
+TEST(MppiWeightsTest, NonFiniteCostsGetZeroWeight) {
+  std::vector<double> costs = {2.0, kNan, 1.0, kInf, 3.0};
+  std::vector<double> weights(costs.size());
+  MppiWeighting w =
+      ComputeMppiWeights(costs.data(), costs.size(), 0.5, weights.data());
+
+  // 统计只计有限代价
+  EXPECT_EQ(w.finite, 3);
+  EXPECT_EQ(w.best, 2);
+  EXPECT_DOUBLE_EQ(w.min, 1.0);
+  EXPECT_DOUBLE_EQ(w.mean, 2.0);
+  EXPECT_NEAR(w.deviation, std::sqrt(2.0 / 3.0), 1e-12);
+  EXPECT_EQ(weights[1], 0.0);
+  EXPECT_EQ(weights[3], 0.0);
+  EXPECT_DOUBLE_EQ(weights[2], 1.0);
+  EXPECT_TRUE(std::isfinite(w.weight_sum));
+  EXPECT_TRUE(std::isfinite(w.free_energy));
+
+  // 最优样本更新同样跳过非有限代价
+  MppiWeighting best =
+      ComputeMppiWeights(costs.data(), costs.size(), 0.5, nullptr);
+  EXPECT_EQ(best.best, 2);
+  EXPECT_DOUBLE_EQ(best.free_energy, 1.0);
+  EXPECT_DOUBLE_EQ(best.effective_samples, 1.0);
+}
+
+TEST(MppiWeightsTest, AllNonFinite) {
+  std::vector<double> costs = {kNan, kInf};
+  std::vector<double> weights(costs.size());
+  MppiWeighting w =
+      ComputeMppiWeights(costs.data(), costs.size(), 0.5, weights.data());
+  EXPECT_EQ(w.finite, 0);
+  EXPECT_EQ(w.weight_sum, 0.0);
+}
+
+bool Converged(std::vector<double> costs, int top_k, double tolerance) {
+  std::vector<double> scratch(costs.size());
+  return AdaptiveSamplesConverged(costs.data(), costs.size(), top_k, tolerance,
+                                  scratch.data());
+}
+
+TEST(AdaptiveSamplesTest, NominalNearOptimal) {
+  // 改进 0.05 < 0.01 × 10
+  EXPECT_TRUE(Converged({10.05, 10.0, 20.0, 30.0}, 3, 0.01));
+  EXPECT_FALSE(Converged({10.2, 10.0, 20.0, 30.0}, 3, 0.01));
+}
+
+TEST(AdaptiveSamplesTest, TopKClustered) {
+  // 名义代价远大于最优，但前 3 个代价相差 0.08 < 0.01 × 10
+  EXPECT_TRUE(Converged({100.0, 10.0, 10.05, 10.08, 50.0}, 3, 0.01));
+  EXPECT_FALSE(Converged({100.0, 10.0, 10.05, 10.2, 50.0}, 3, 0.01));
+  EXPECT_FALSE(Converged({100.0, 10.0}, 1, 0.01));
+}
+
+TEST(AdaptiveSamplesTest, ScalesByBestCost) {
+  // 以名义代价为尺度时 0.9 < 0.01 × 100 会误判收敛；以最优代价为尺度不收敛
+  EXPECT_FALSE(Converged({100.0, 1.0, 1.9, 50.0}, 2, 0.01));
+  // 同一组相对差，整体缩放后结论不变
+  EXPECT_TRUE(Converged({1e-3, 1e-3 - 5e-6, 5e-3}, 2, 0.01));
+  EXPECT_TRUE(Converged({1e3, 1e3 - 5.0, 5e3}, 2, 0.01));
+}
+
+TEST(AdaptiveSamplesTest, SkipsNonFiniteCosts) {
+  EXPECT_TRUE(Converged({kNan, 10.0, kInf, 10.05}, 2, 0.01));
+  EXPECT_FALSE(Converged({kInf, 10.0, kNan, 12.0}, 2, 0.01));
+  EXPECT_FALSE(Converged({kNan, kInf}, 2, 0.01));
+}
+
+}  // namespace
+}  // namespace mjpc
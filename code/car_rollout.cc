@@ -0,0 +1,221 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/car_rollout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/task.h"
+#include "mjpc/tasks/simple_car/goal_switch.h"
+
+namespace mjpc {
+
+namespace {
+
+// 后轮半径（car_model.xml 中 wheel 类的圆柱半径）
+constexpr double kWheelRadius = 0.03;
+
+// MuJoCo 警告总数（BADQACC 等会让 mj_step 自动重置状态，只能从计数看出）
+int WarningCount(const mjData* data) {
+  int count = 0;
+  for (int i = 0; i < mjNWARNING; i++) count += data->warning[i].number;
+  return count;
+}
+
+bool FiniteState(const mjModel* model, const mjData* data) {
+  for (int i = 0; i < model->nq; i++) {
+    if (!std::isfinite(data->qpos[i])) return false;
+  }
+  for (int i = 0; i < model->nv; i++) {
+    if (!std::isfinite(data->qvel[i])) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int CarGoalMocapId(const mjModel* model) {
+  int goal = mj_name2id(model, mjOBJ_BODY, "goal");
+  return goal >= 0 ? model->body_mocapid[goal] : -1;
+}
+
+void CarRollout::Allocate(const mjModel* model, int num_residual,
+                          int max_steps) {
+  nq_ = model->nq;
+  nv_ = model->nv;
+  nu_ = model->nu;
+  nmocap_ = model->nmocap;
+  num_residual_ = num_residual;
+  goal_mocap_ = CarGoalMocapId(model);
+
+  // 融合模式不需要状态缓冲区，但保留分配以便切换模式
+  times_.resize(max_steps);
+  qpos_.resize(max_steps * model->nq);
+  qvel_.resize(max_steps * model->nv);
+  ctrl_.resize(max_steps * model->nu);
+  mocap_pos_.resize(max_steps * 3 * model->nmocap);
+  residual_.resize(max_steps * num_residual);
+  costs_.resize(max_steps);
+}
+
+void CarRollout::SetState(const mjModel* model, mjData* data,
+                          const CarInitialState& state) {
+  data->time = 0.0;
+  mju_copy(data->qpos, model->qpos0, model->nq);
+  mju_zero(data->qvel, model->nv);
+  mju_zero(data->qacc_warmstart, model->nv);
+  mju_zero(data->ctrl, model->nu);
+
+  // 自由关节：位置 + 绕 z 轴的朝向
+  data->qpos[0] = state.pos[0];
+  data->qpos[1] = state.pos[1];
+  data->qpos[3] = std::cos(0.5 * state.heading);
+  data->qpos[4] = 0.0;
+  data->qpos[5] = 0.0;
+  data->qpos[6] = std::sin(0.5 * state.heading);
+
+  // 初速度沿车头方向，后轮按纯滚动给角速度
+  data->qvel[0] = state.speed * std::cos(state.heading);
+  data->qvel[1] = state.speed * std::sin(state.heading);
+  if (model->nv >= 8) {
+    data->qvel[6] = state.speed / kWheelRadius;
+    data->qvel[7] = state.speed / kWheelRadius;
+  }
+
+  int goal = CarGoalMocapId(model);
+  if (goal >= 0) {
+    data->mocap_pos[3 * goal + 0] = state.goal[0];
+    data->mocap_pos[3 * goal + 1] = state.goal[1];
+  }
+
+  mj_forward(model, data);
+}
+
+void CarRollout::SetNextGoal(const double* next_goal) {
+  has_next_goal_ = next_goal != nullptr;
+  if (has_next_goal_) {
+    next_goal_[0] = next_goal[0];
+    next_goal_[1] = next_goal[1];
+  }
+}
+
+double CarRollout::Rollout(const mjModel* model, mjData* data,
+                           const ResidualFn& residual, const double* ctrl,
+                           int steps, int ctrl_stride) {
+  steps_ = steps;
+  bool fused = mode_ == kFused;
+  double total = 0.0;
+
+  // 第一遍：仿真并保存状态；融合模式下直接评估，状态仍在缓存中
+  bool switched = false;
+  for (int t = 0; t < steps; t++) {
+    mju_copy(data->ctrl, ctrl + t * ctrl_stride, nu_);
+
+    if (fused) {
+      double* r = residual_.data() + t * num_residual_;
+      residual.Residual(model, data, r);
+      costs_[t] = residual.CostValue(r);
+      total += costs_[t];
+    } else {
+      times_[t] = data->time;
+      mju_copy(qpos_.data() + t * nq_, data->qpos, nq_);
+      mju_copy(qvel_.data() + t * nv_, data->qvel, nv_);
+      mju_copy(ctrl_.data() + t * nu_, data->ctrl, nu_);
+      mju_copy(mocap_pos_.data() + t * 3 * nmocap_, data->mocap_pos,
+               3 * nmocap_);
+    }
+
+    double previous_pos[2] = {data->qpos[0], data->qpos[1]};
+    mj_step(model, data);
+    SwitchGoal(previous_pos, data, &switched);
+  }
+
+  if (fused) return total;
+
+  // 第二遍：逐个恢复保存的状态并评估残差
+  //   SimpleCar 的残差只读 qpos/qvel/ctrl/mocap/time，无需 mj_forward
+  for (int t = 0; t < steps; t++) {
+    data->time = times_[t];
+    mju_copy(data->qpos, qpos_.data() + t * nq_, nq_);
+    mju_copy(data->qvel, qvel_.data() + t * nv_, nv_);
+    mju_copy(data->ctrl, ctrl_.data() + t * nu_, nu_);
+    mju_copy(data->mocap_pos, mocap_pos_.data() + t * 3 * nmocap_,
+             3 * nmocap_);
+
+    double* r = residual_.data() + t * num_residual_;
+    residual.Residual(model, data, r);
+    costs_[t] = residual.CostValue(r);
+    total += costs_[t];
+  }
+  return total;
+}
+
+double CarRollout::Rollout(const mjModel* model, const mjModel* coarse_model,
+                           mjData* data, const ResidualFn& residual,
+                           const double* ctrl, int ctrl_stride,
+                           const RolloutGrid& grid) {
+  int steps = grid.steps();
+  steps_ = steps;
+  double total = 0.0;
+  bool switched = false;
+  int warnings = WarningCount(data);
+  for (int t = 0; t < steps; t++) {
+    mju_copy(data->ctrl, ctrl + t * ctrl_stride, nu_);
+
+    double* r = residual_.data() + t * num_residual_;
+    residual.Residual(model, data, r);
+    costs_[t] = residual.CostValue(r) * grid.weight(t);
+    total += costs_[t];
+
+    const mjModel* step_model = grid.coarse[t] ? coarse_model : model;
+    for (int i = 0; i < grid.substeps[t]; i++) {
+      double previous_pos[2] = {data->qpos[0], data->qpos[1]};
+      mj_step(step_model, data);
+      SwitchGoal(previous_pos, data, &switched);
+    }
+
+    // 粗步发散：拒绝该样本（规划器不计非有限代价）
+    if (grid.coarse[t] &&
+        (WarningCount(data) != warnings || !FiniteState(model, data))) {
+      std::fill(costs_.begin() + t + 1, costs_.begin() + steps, 0.0);
+      return std::numeric_limits<double>::infinity();
+    }
+  }
+  return total;
+}
+
+void CarRollout::SwitchGoal(const double previous_pos[2], mjData* data,
+                            bool* switched) {
+  if (!has_next_goal_ || *switched || goal_mocap_ < 0) return;
+  double* goal = data->mocap_pos + 3 * goal_mocap_;
+  double fraction;
+  if (SweptGoalReached(previous_pos, data->qpos, goal, &fraction)) {
+    goal[0] = next_goal_[0];
+    goal[1] = next_goal_[1];
+    *switched = true;
+  }
+}
+
+int CarRollout::BufferBytesPerStep(Mode mode) const {
+  int outputs = (num_residual_ + 1) * sizeof(double);  // 残差 + 代价
+  if (mode == kFused) return outputs;
+  // 保存状态（写）并在第二遍读回写入 data
+  int state = (1 + nq_ + nv_ + nu_ + 3 * nmocap_) * sizeof(double);
+  return 2 * state + outputs;
+}
+
+}  // namespace mjpc
@@ -0,0 +1,113 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_CAR_ROLLOUT_H_
+#define MJPC_TASKS_SIMPLE_CAR_CAR_ROLLOUT_H_
+
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/task.h"
+#include "mjpc/tasks/simple_car/rollout_grid.h"
+
+namespace mjpc {
+
+// 车辆初始状态（平面）
+struct CarInitialState {
+  double pos[2] = {0.0, 0.0};
+  double heading = 0.0;  // 车头朝向（弧度）
+  double speed = 0.0;    // 沿车头方向的速度（m/s）
+  double goal[2] = {0.0, 0.0};
+};
+
+// 单线程 rollout 缓冲区：每个线程持有一个实例和一个 mjData
+//   默认与规划器的 Trajectory 相同：先逐步仿真并保存状态，再对保存的轨迹评估残差和代价；
+//   融合模式在每步仿真前直接评估，得到相同的代价，但不再写入和读回状态
+class CarRollout {
+ public:
+  // 残差评估方式
+  enum Mode : int {
+    kTwoPass = 0,  // 先保存整条轨迹，再逐步恢复状态评估（与规划器一致）
+    kFused,        // 每步仿真前直接在 data 上评估并累加代价，只保存残差和代价
+  };
+
+  CarRollout() = default;
+
+  // 分配缓冲区
+  void Allocate(const mjModel* model, int num_residual, int max_steps);
+
+  // 把 data 设为给定的初始状态（其余状态取 qpos0）
+  static void SetState(const mjModel* model, mjData* data,
+                       const CarInitialState& state);
+
+  // 已知下一个目标时，rollout 内按任务的切换规则移动目标（nullptr 关闭）
+  void SetNextGoal(const double* next_goal);
+
+  // rollout，返回总代价；ctrl_stride 为 0 时全程使用同一控制量，
+  //   否则第 t 步使用 ctrl + t * ctrl_stride
+  double Rollout(const mjModel* model, mjData* data, const ResidualFn& residual,
+                 const double* ctrl, int steps, int ctrl_stride = 0);
+
+  // 非均匀网格 rollout（按融合模式评估），返回总代价
+  //   第 t 步控制量为 ctrl + t * ctrl_stride，在该步起点评估残差，
+  //   粗步的代价乘以 步长 / grid.fine_step（均匀网格时与 Rollout 相同），
+  //   粗步在 coarse_model 上走 grid.substeps[t] 个物理子步；
+  //   粗步后状态非有限或 MuJoCo 警告计数增加时返回 +inf（样本作废）
+  double Rollout(const mjModel* model, const mjModel* coarse_model,
+                 mjData* data, const ResidualFn& residual, const double* ctrl,
+                 int ctrl_stride, const RolloutGrid& grid);
+
+  void set_mode(Mode mode) { mode_ = mode; }
+  Mode mode() const { return mode_; }
+
+  // 每个仿真步写入和读回的 rollout 缓冲区字节数（不含 mj_step 本身）
+  int BufferBytesPerStep(Mode mode) const;
+
+  int steps() const { return steps_; }
+  const double* costs() const { return costs_.data(); }
+
+ private:
+  // 仿真一步后按扫掠检测切换目标（每个 rollout 至多一次）
+  void SwitchGoal(const double previous_pos[2], mjData* data, bool* switched);
+
+  Mode mode_ = kTwoPass;
+  int nq_ = 0;
+  int nv_ = 0;
+  int nu_ = 0;
+  int nmocap_ = 0;
+  int num_residual_ = 0;
+  int steps_ = 0;
+  int goal_mocap_ = -1;
+
+  bool has_next_goal_ = false;
+  double next_goal_[2] = {0.0, 0.0};
+
+  // 保存的状态
+  std::vector<double> times_;
+  std::vector<double> qpos_;
+  std::vector<double> qvel_;
+  std::vector<double> ctrl_;
+  std::vector<double> mocap_pos_;
+
+  // 残差与代价
+  std::vector<double> residual_;
+  std::vector<double> costs_;
+};
+
+// 目标 mocap 索引（找不到 goal 时返回 -1）
+int CarGoalMocapId(const mjModel* model);
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_CAR_ROLLOUT_H_
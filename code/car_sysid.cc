@@ -0,0 +1,578 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/car_sysid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_rollout.h"
+#include "mjpc/threadpool.h"
+
+namespace mjpc {
+
+namespace {
+
+// 拟合的方程
+enum Equation : int {
+  kWheelRadius = 0,  // v = r * (左 + 右) / 2
+  kTrackWidth,       // w = (r / b) * (右 - 左)
+  kForward,          // v' = a u - c1 v - c2 v|v|
+  kTurn,             // w' = a u - c w
+  kNumEquations,
+};
+constexpr int kMaxFeatures = 3;
+constexpr int kNumFeatures[kNumEquations] = {1, 1, 3, 2};
+
+// 正规方程累加器（A^T A、A^T b 以及计算残差和决定系数所需的和）
+struct NormalEquations {
+  int n = 0;
+  double ata[kMaxFeatures * kMaxFeatures] = {0};
+  double atb[kMaxFeatures] = {0};
+  double btb = 0.0;
+  double bsum = 0.0;
+  int64_t count = 0;
+
+  void Add(const double* a, double b) {
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) ata[i * n + j] += a[i] * a[j];
+      atb[i] += a[i] * b;
+    }
+    btb += b * b;
+    bsum += b;
+    count++;
+  }
+
+  void Merge(const NormalEquations& other) {
+    for (int i = 0; i < n * n; i++) ata[i] += other.ata[i];
+    for (int i = 0; i < n; i++) atb[i] += other.atb[i];
+    btb += other.btb;
+    bsum += other.bsum;
+    count += other.count;
+  }
+
+  bool Solve(double* x) const {
+    if (count < n) return false;
+    double factor[kMaxFeatures * kMaxFeatures];
+    mju_copy(factor, ata, n * n);
+    // 对角线相对正则，避免某个输入未被激励时矩阵奇异
+    for (int i = 0; i < n; i++) factor[i * n + i] += 1e-9 * (1.0 + ata[i * n + i]);
+    if (mju_cholFactor(factor, n, 0.0) < n) return false;
+    mju_cholSolve(x, factor, atb, n);
+    return true;
+  }
+
+  // 残差平方和：b^T b - 2 x^T A^T b + x^T A^T A x
+  double Sse(const double* x) const {
+    double sse = btb;
+    for (int i = 0; i < n; i++) {
+      sse -= 2.0 * x[i] * atb[i];
+      for (int j = 0; j < n; j++) sse += x[i] * ata[i * n + j] * x[j];
+    }
+    return std::max(sse, 0.0);
+  }
+};
+
+struct SysIdLayout {
+  int nu = 0, nq = 0, nv = 0;
+  int ctrl[2] = {0, 1};           // forward, turn 执行器
+  int wheel_dof[2] = {-1, -1};    // 左、右后轮
+  double gear[2] = {1.0, 1.0};
+
+  void Initialize(const mjModel* model) {
+    nu = model->nu;
+    nq = model->nq;
+    nv = model->nv;
+    const char* wheels[2] = {"left", "right"};
+    CarControlIndices(model, ctrl);
+    for (int i = 0; i < 2; i++) {
+      gear[i] = ctrl[i] < nu ? model->actuator_gear[6 * ctrl[i]] : 1.0;
+      if (gear[i] == 0.0) gear[i] = 1.0;
+      int joint = mj_name2id(model, mjOBJ_JOINT, wheels[i]);
+      wheel_dof[i] = joint >= 0 ? model->jnt_dofadr[joint] : -1;
+    }
+  }
+
+  int stride() const { return nu + nq + nv; }
+  bool has_wheels() const { return wheel_dof[0] >= 0 && wheel_dof[1] >= 0; }
+};
+
+double WrapAngle(double angle) {
+  return std::remainder(angle, 2.0 * M_PI);
+}
+
+// FNV-1a，按位处理 double 数组
+uint64_t HashDoubles(uint64_t hash, const double* values, int n) {
+  for (int i = 0; i < n; i++) {
+    uint64_t bits;
+    std::memcpy(&bits, values + i, sizeof(bits));
+    for (int b = 0; b < 8; b++) {
+      hash ^= (bits >> (8 * b)) & 0xff;
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+// 一条训练轨迹的全部方程
+void AccumulateTrajectory(const SysIdLayout& layout, const CarTrajectory& traj,
+                          NormalEquations* equations) {
+  int stride = layout.stride();
+  int num = traj.samples.size() / stride;
+  double dt = traj.dt;
+  PlanarCarState prev;
+  for (int k = 0; k < num; k++) {
+    const double* sample = traj.samples.data() + k * stride;
+    const double* ctrl = sample;
+    const double* qpos = sample + layout.nu;
+    const double* qvel = qpos + layout.nq;
+    PlanarCarState state = ExtractPlanarState(qpos, qvel);
+
+    if (layout.has_wheels()) {
+      double left = qvel[layout.wheel_dof[0]];
+      double right = qvel[layout.wheel_dof[1]];
+      double a = 0.5 * (left + right);
+      equations[kWheelRadius].Add(&a, state.speed);
+      a = right - left;
+      equations[kTrackWidth].Add(&a, state.yaw_rate);
+    }
+
+    // 相邻采样点的差分，特征取区间中点（梯形）
+    if (k > 0 && dt > 0.0) {
+      const double* ctrl_prev = ctrl - stride;
+      double v = 0.5 * (prev.speed + state.speed);
+      double w = 0.5 * (prev.yaw_rate + state.yaw_rate);
+      double forward[3] = {layout.gear[0] * ctrl_prev[layout.ctrl[0]], -v,
+                           -v * std::abs(v)};
+      equations[kForward].Add(forward, (state.speed - prev.speed) / dt);
+      double turn[2] = {layout.gear[1] * ctrl_prev[layout.ctrl[1]], -w};
+      equations[kTurn].Add(turn, (state.yaw_rate - prev.yaw_rate) / dt);
+    }
+    prev = state;
+  }
+}
+
+}  // namespace
+
+void CarControlIndices(const mjModel* model, int index[2]) {
+  const char* actuators[2] = {"forward", "turn"};
+  for (int i = 0; i < 2; i++) {
+    int actuator = mj_name2id(model, mjOBJ_ACTUATOR, actuators[i]);
+    index[i] = actuator >= 0 ? actuator : i;
+  }
+}
+
+PlanarCarState ExtractPlanarState(const double* qpos, const double* qvel) {
+  PlanarCarState state;
+  state.pos[0] = qpos[0];
+  state.pos[1] = qpos[1];
+  const double* q = qpos + 3;  // w, x, y, z
+  state.heading = std::atan2(2.0 * (q[0] * q[3] + q[1] * q[2]),
+                             1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]));
+  state.speed = qvel[0] * std::cos(state.heading) +
+                qvel[1] * std::sin(state.heading);
+  // 自由关节的角速度在局部坐标系中，车身接近水平时局部 z 即偏航角速度
+  state.yaw_rate = qvel[5];
+  return state;
+}
+
+void PlanarCarStep(const PlanarCarParams& params, const double ctrl[2],
+                   double dt, PlanarCarState* state) {
+  double v0 = state->speed;
+  double w0 = state->yaw_rate;
+
+  // 前进：线性阻尼按指数积分，二次阻尼取步初值
+  double accel = params.forward_gain * params.gear[0] * ctrl[0] -
+                 params.drag_quadratic * v0 * std::abs(v0);
+  double v1;
+  if (params.drag_linear > 1e-9) {
+    double decay = std::exp(-params.drag_linear * dt);
+    v1 = v0 * decay + accel * (1.0 - decay) / params.drag_linear;
+  } else {
+    v1 = v0 + accel * dt;
+  }
+
+  // 转向：一阶滞后趋向稳态角速度
+  double target = params.turn_gain * params.gear[1] * ctrl[1];
+  double w1 = params.turn_lag > 1e-9
+                  ? target + (w0 - target) * std::exp(-dt / params.turn_lag)
+                  : target;
+
+  double heading = state->heading + 0.5 * (w0 + w1) * dt;
+  double mid = 0.5 * (state->heading + heading);
+  double distance = 0.5 * (v0 + v1) * dt;
+  state->pos[0] += distance * std::cos(mid);
+  state->pos[1] += distance * std::sin(mid);
+  state->heading = WrapAngle(heading);
+  state->speed = v1;
+  state->yaw_rate = w1;
+}
+
+uint64_t CarModelFingerprint(const mjModel* model) {
+  uint64_t hash = 1469598103934665603ull;
+  double integrator = model->opt.integrator;
+  hash = HashDoubles(hash, &model->opt.timestep, 1);
+  hash = HashDoubles(hash, &integrator, 1);
+  hash = HashDoubles(hash, model->body_mass, model->nbody);
+  hash = HashDoubles(hash, model->body_inertia, 3 * model->nbody);
+  hash = HashDoubles(hash, model->body_pos, 3 * model->nbody);
+  hash = HashDoubles(hash, model->body_ipos, 3 * model->nbody);
+  hash = HashDoubles(hash, model->geom_size, 3 * model->ngeom);
+  hash = HashDoubles(hash, model->geom_pos, 3 * model->ngeom);
+  hash = HashDoubles(hash, model->geom_friction, 3 * model->ngeom);
+  hash = HashDoubles(hash, model->geom_solref, mjNREF * model->ngeom);
+  hash = HashDoubles(hash, model->jnt_stiffness, model->njnt);
+  hash = HashDoubles(hash, model->dof_damping, model->nv);
+  hash = HashDoubles(hash, model->dof_armature, model->nv);
+  hash = HashDoubles(hash, model->dof_frictionloss, model->nv);
+  hash = HashDoubles(hash, model->actuator_gear, 6 * model->nu);
+  hash = HashDoubles(hash, model->actuator_gainprm, mjNGAIN * model->nu);
+  hash = HashDoubles(hash, model->actuator_biasprm, mjNBIAS * model->nu);
+  hash = HashDoubles(hash, model->wrap_prm, model->nwrap);
+  return hash;
+}
+
+bool WritePlanarCarParams(const std::string& path,
+                          const PlanarCarParams& params) {
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) return false;
+  std::fprintf(file, "# SimpleCar planar surrogate (car_sysid)\n");
+  std::fprintf(file, "model_fingerprint %016" PRIx64 "\n",
+               params.model_fingerprint);
+  std::fprintf(file, "num_samples %d\n", params.num_samples);
+  std::fprintf(file, "timestep %.17g\n", params.timestep);
+  std::fprintf(file, "wheel_radius %.17g\n", params.wheel_radius);
+  std::fprintf(file, "track_width %.17g\n", params.track_width);
+  std::fprintf(file, "drag_linear %.17g\n", params.drag_linear);
+  std::fprintf(file, "drag_quadratic %.17g\n", params.drag_quadratic);
+  std::fprintf(file, "forward_gain %.17g\n", params.forward_gain);
+  std::fprintf(file, "turn_gain %.17g\n", params.turn_gain);
+  std::fprintf(file, "turn_lag %.17g\n", params.turn_lag);
+  std::fprintf(file, "gear_forward %.17g\n", params.gear[0]);
+  std::fprintf(file, "gear_turn %.17g\n", params.gear[1]);
+  return std::fclose(file) == 0;
+}
+
+bool ReadPlanarCarParams(const std::string& path, PlanarCarParams* params) {
+  FILE* file = std::fopen(path.c_str(), "r");
+  if (!file) return false;
+  PlanarCarParams result;
+  struct Field {
+    const char* name;
+    double* value;
+  };
+  const Field fields[] = {
+      {"timestep", &result.timestep},
+      {"wheel_radius", &result.wheel_radius},
+      {"track_width", &result.track_width},
+      {"drag_linear", &result.drag_linear},
+      {"drag_quadratic", &result.drag_quadratic},
+      {"forward_gain", &result.forward_gain},
+      {"turn_gain", &result.turn_gain},
+      {"turn_lag", &result.turn_lag},
+      {"gear_forward", &result.gear[0]},
+      {"gear_turn", &result.gear[1]},
+  };
+  bool has_fingerprint = false;
+  char line[256];
+  while (std::fgets(line, sizeof(line), file)) {
+    if (line[0] == '#') continue;
+    char name[64];
+    char value[64];
+    if (std::sscanf(line, "%63s %63s", name, value) != 2) continue;
+    if (std::strcmp(name, "model_fingerprint") == 0) {
+      result.model_fingerprint = std::strtoull(value, nullptr, 16);
+      has_fingerprint = true;
+    } else if (std::strcmp(name, "num_samples") == 0) {
+      result.num_samples = std::atoi(value);
+    } else {
+      for (const Field& field : fields) {
+        if (std::strcmp(name, field.name) == 0) {
+          *field.value = std::strtod(value, nullptr);
+        }
+      }
+    }
+  }
+  std::fclose(file);
+  if (!has_fingerprint) return false;
+  *params = result;
+  return true;
+}
+
+bool WriteCarTrajectories(const std::string& path, const mjModel* model,
+                          const std::vector<CarTrajectory>& trajectories) {
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) return false;
+  int stride = model->nu + model->nq + model->nv;
+  double dt = trajectories.empty() ? 0.0 : trajectories[0].dt;
+  std::fprintf(file, "%.17g %d %d %d\n", dt, model->nu, model->nq,
+               model->nv);
+  for (const CarTrajectory& traj : trajectories) {
+    int num = traj.samples.size() / stride;
+    for (int k = 0; k < num; k++) {
+      const double* sample = traj.samples.data() + k * stride;
+      for (int i = 0; i < stride; i++) {
+        std::fprintf(file, i ? " %.9g" : "%.9g", sample[i]);
+      }
+      std::fputc('\n', file);
+    }
+    std::fputc('\n', file);
+  }
+  return std::fclose(file) == 0;
+}
+
+bool ReadCarTrajectories(const std::string& path, const mjModel* model,
+                         std::vector<CarTrajectory>* trajectories) {
+  FILE* file = std::fopen(path.c_str(), "r");
+  if (!file) return false;
+  double dt;
+  int nu, nq, nv;
+  if (std::fscanf(file, "%lf %d %d %d", &dt, &nu, &nq, &nv) != 4 ||
+      nu != model->nu || nq != model->nq || nv != model->nv || dt <= 0.0) {
+    std::fclose(file);
+    return false;
+  }
+  int stride = nu + nq + nv;
+  trajectories->clear();
+  CarTrajectory traj;
+  traj.dt = dt;
+  std::vector<double> sample(stride);
+  std::string line;
+  int c;
+  // 按行读取：空行结束当前轨迹
+  while ((c = std::fgetc(file)) != EOF) {
+    if (c != '\n') {
+      line.push_back(static_cast<char>(c));
+      continue;
+    }
+    const char* p = line.c_str();
+    int count = 0;
+    while (count < stride) {
+      char* end;
+      double value = std::strtod(p, &end);
+      if (end == p) break;
+      sample[count++] = value;
+      p = end;
+    }
+    if (count == stride) {
+      traj.samples.insert(traj.samples.end(), sample.begin(), sample.end());
+    } else if (!traj.samples.empty()) {
+      trajectories->push_back(std::move(traj));
+      traj = CarTrajectory();
+      traj.dt = dt;
+    }
+    line.clear();
+  }
+  if (!traj.samples.empty()) trajectories->push_back(std::move(traj));
+  std::fclose(file);
+  return !trajectories->empty();
+}
+
+std::vector<CarTrajectory> GenerateCarTrajectories(
+    const mjModel* model, const SysIdGenerateConfig& config) {
+  std::vector<CarTrajectory> trajectories(std::max(config.num_trajectories, 0));
+  int substeps = std::max(
+      1, static_cast<int>(std::round(config.sample_dt / model->opt.timestep)));
+  double dt = substeps * model->opt.timestep;
+  int num_samples = std::max(2, static_cast<int>(config.duration / dt) + 1);
+  int stride = model->nu + model->nq + model->nv;
+
+  int num_threads = std::max(1, config.num_threads);
+  std::atomic<int> next{0};
+  ThreadPool pool(num_threads);
+  int count_before = pool.GetCount();
+  for (int t = 0; t < num_threads; t++) {
+    pool.Schedule([&]() {
+      mjData* data = mj_makeData(model);
+      while (true) {
+        int i = next.fetch_add(1);
+        if (i >= static_cast<int>(trajectories.size())) break;
+        // 每条轨迹独立的随机数，结果与线程数无关
+        std::mt19937_64 rng(config.seed * 1000003ull + i);
+        std::uniform_real_distribution<double> unit(-1.0, 1.0);
+        std::uniform_real_distribution<double> hold(config.hold_min,
+                                                    config.hold_max);
+
+        CarInitialState initial;
+        initial.pos[0] = unit(rng);
+        initial.pos[1] = unit(rng);
+        initial.heading = M_PI * unit(rng);
+        initial.speed = 0.5 * config.max_speed * (1.0 + unit(rng));
+        CarRollout::SetState(model, data, initial);
+
+        CarTrajectory& traj = trajectories[i];
+        traj.dt = dt;
+        traj.samples.reserve(num_samples * stride);
+        double next_switch = 0.0;
+        for (int k = 0; k < num_samples; k++) {
+          if (data->time >= next_switch) {
+            for (int u = 0; u < model->nu; u++) data->ctrl[u] = unit(rng);
+            next_switch = data->time + hold(rng);
+          }
+          // 离开地面（驶出平面边缘）后截断
+          if (data->qpos[2] < -0.5) break;
+          traj.samples.insert(traj.samples.end(), data->ctrl,
+                              data->ctrl + model->nu);
+          traj.samples.insert(traj.samples.end(), data->qpos,
+                              data->qpos + model->nq);
+          traj.samples.insert(traj.samples.end(), data->qvel,
+                              data->qvel + model->nv);
+          for (int s = 0; s < substeps; s++) mj_step(model, data);
+        }
+      }
+      mj_deleteData(data);
+    });
+  }
+  pool.WaitCount(count_before + num_threads);
+  pool.ResetCount();
+  return trajectories;
+}
+
+bool FitPlanarCar(const mjModel* model,
+                  const std::vector<CarTrajectory>& trajectories,
+                  int num_threads, int validation_stride, double horizon,
+                  PlanarCarParams* params, SysIdReport* report) {
+  SysIdLayout layout;
+  layout.Initialize(model);
+  if (model->nq < 7 || model->nv < 6 || layout.nu < 2) return false;
+  auto is_validation = [validation_stride](int i) {
+    return validation_stride > 1 && i % validation_stride == validation_stride - 1;
+  };
+
+  // 每个线程累加自己的正规方程，最后合并
+  num_threads = std::max(1, num_threads);
+  std::vector<NormalEquations> partial(num_threads * kNumEquations);
+  for (int i = 0; i < num_threads * kNumEquations; i++) {
+    partial[i].n = kNumFeatures[i % kNumEquations];
+  }
+  std::atomic<int> next{0};
+  std::atomic<int> worker{0};
+  ThreadPool pool(num_threads);
+  int count_before = pool.GetCount();
+  for (int t = 0; t < num_threads; t++) {
+    pool.Schedule([&]() {
+      NormalEquations* equations =
+          partial.data() + worker.fetch_add(1) * kNumEquations;
+      while (true) {
+        int i = next.fetch_add(1);
+        if (i >= static_cast<int>(trajectories.size())) break;
+        if (is_validation(i)) continue;
+        AccumulateTrajectory(layout, trajectories[i], equations);
+      }
+    });
+  }
+  pool.WaitCount(count_before + num_threads);
+  pool.ResetCount();
+
+  NormalEquations equations[kNumEquations];
+  for (int e = 0; e < kNumEquations; e++) {
+    equations[e] = partial[e];
+    for (int t = 1; t < num_threads; t++) {
+      equations[e].Merge(partial[t * kNumEquations + e]);
+    }
+  }
+
+  // 求解
+  double x[kNumEquations][kMaxFeatures] = {{0}};
+  if (!equations[kForward].Solve(x[kForward]) ||
+      !equations[kTurn].Solve(x[kTurn])) {
+    return false;
+  }
+  bool wheels = layout.has_wheels() &&
+                equations[kWheelRadius].Solve(x[kWheelRadius]) &&
+                equations[kTrackWidth].Solve(x[kTrackWidth]);
+
+  PlanarCarParams result;
+  if (wheels && x[kTrackWidth][0] != 0.0) {
+    // 关节轴方向只影响符号
+    result.wheel_radius = std::abs(x[kWheelRadius][0]);
+    result.track_width = std::abs(x[kWheelRadius][0] / x[kTrackWidth][0]);
+  }
+  result.gear[0] = layout.gear[0];
+  result.gear[1] = layout.gear[1];
+  result.forward_gain = x[kForward][0];
+  result.drag_linear = x[kForward][1];
+  result.drag_quadratic = x[kForward][2];
+  double turn_decay = x[kTurn][1];
+  result.turn_lag = turn_decay > 1e-9 ? 1.0 / turn_decay : 0.0;
+  result.turn_gain =
+      turn_decay > 1e-9 ? x[kTurn][0] / turn_decay : x[kTurn][0];
+  result.model_fingerprint = CarModelFingerprint(model);
+  result.num_samples = equations[kForward].count;
+  result.timestep = trajectories.empty() ? 0.0 : trajectories[0].dt;
+
+  SysIdReport out;
+  out.num_samples = result.num_samples;
+  for (int e = 0; e < kNumEquations; e++) {
+    const NormalEquations& eq = equations[e];
+    if (eq.count == 0 || (!wheels && e <= kTrackWidth)) continue;
+    double sse = eq.Sse(x[e]);
+    double sst = eq.btb - eq.bsum * eq.bsum / eq.count;
+    out.rms[e] = std::sqrt(sse / eq.count);
+    out.r2[e] = sst > 0.0 ? 1.0 - sse / sst : 0.0;
+  }
+
+  // 验证：不重叠的 horizon 窗口，从真实状态出发开环预测
+  out.horizon = horizon;
+  std::vector<double> position_errors;
+  double heading_sum = 0.0;
+  int stride = layout.stride();
+  for (int i = 0; i < static_cast<int>(trajectories.size()); i++) {
+    if (!is_validation(i)) continue;
+    const CarTrajectory& traj = trajectories[i];
+    int window = std::max(1, static_cast<int>(std::round(horizon / traj.dt)));
+    int num = traj.samples.size() / stride;
+    for (int k = 0; k + window < num; k += window) {
+      const double* start = traj.samples.data() + k * stride;
+      PlanarCarState state =
+          ExtractPlanarState(start + layout.nu, start + layout.nu + layout.nq);
+      for (int j = 0; j < window; j++) {
+        const double* sample = start + j * stride;
+        double ctrl[2] = {sample[layout.ctrl[0]], sample[layout.ctrl[1]]};
+        PlanarCarStep(result, ctrl, traj.dt, &state);
+      }
+      const double* end = start + window * stride;
+      PlanarCarState truth =
+          ExtractPlanarState(end + layout.nu, end + layout.nu + layout.nq);
+      position_errors.push_back(std::hypot(state.pos[0] - truth.pos[0],
+                                           state.pos[1] - truth.pos[1]));
+      heading_sum += std::abs(WrapAngle(state.heading - truth.heading));
+    }
+  }
+  out.num_validation = position_errors.size();
+  if (!position_errors.empty()) {
+    double sum = 0.0;
+    for (double e : position_errors) sum += e;
+    out.position_error_mean = sum / position_errors.size();
+    out.heading_error_mean = heading_sum / position_errors.size();
+    size_t p95 = static_cast<size_t>(0.95 * (position_errors.size() - 1));
+    std::nth_element(position_errors.begin(), position_errors.begin() + p95,
+                     position_errors.end());
+    out.position_error_p95 = position_errors[p95];
+  }
+
+  *params = result;
+  if (report) *report = out;
+  return true;
+}
+
+}  // namespace mjpc
@@ -0,0 +1,134 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_CAR_SYSID_H_
+#define MJPC_TASKS_SIMPLE_CAR_CAR_SYSID_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 记录的轨迹：每个采样点 ctrl(nu) + qpos(nq) + qvel(nv)，采样间隔 dt
+//   ctrl 为该采样点到下一个采样点之间施加的控制量
+struct CarTrajectory {
+  double dt = 0.0;
+  std::vector<double> samples;  // [num_samples][nu + nq + nv]
+
+  int num_samples(const mjModel* model) const {
+    return samples.size() / (model->nu + model->nq + model->nv);
+  }
+};
+
+// 平面车辆代理模型参数（SimpleCar 差速驱动）
+//   v' = forward_gain * gear_forward * u_forward - drag_linear * v
+//        - drag_quadratic * v |v|
+//   w' = (turn_gain * gear_turn * u_turn - w) / turn_lag
+//   x' = v cos(theta)，y' = v sin(theta)，theta' = w
+//   车轮角速度：v = wheel_radius * (左 + 右) / 2，w = wheel_radius * (右 - 左) / track_width
+struct PlanarCarParams {
+  double wheel_radius = 0.0;     // 有效车轮半径（米）
+  double track_width = 0.0;      // 有效轮距（米）
+  double drag_linear = 0.0;      // 1/s
+  double drag_quadratic = 0.0;   // 1/m
+  double forward_gain = 0.0;     // 每单位肌腱力的加速度（m/s^2）
+  double turn_gain = 0.0;        // 每单位肌腱力的稳态角速度（rad/s）
+  double turn_lag = 0.0;         // 角速度一阶滞后时间常数（秒）
+  double gear[2] = {0.0, 0.0};   // 拟合时的执行器传动比（forward, turn）
+
+  uint64_t model_fingerprint = 0;  // 拟合所用模型的动力学参数哈希
+  int num_samples = 0;
+  double timestep = 0.0;           // 拟合所用采样间隔
+};
+
+// 代理模型状态
+struct PlanarCarState {
+  double pos[2] = {0.0, 0.0};
+  double heading = 0.0;
+  double speed = 0.0;     // 沿车头方向（m/s）
+  double yaw_rate = 0.0;  // rad/s
+};
+
+// forward / turn 执行器的下标（按名称查找，找不到时为 0 / 1）
+void CarControlIndices(const mjModel* model, int index[2]);
+
+// 从 qpos / qvel 提取平面状态（自由关节在 qpos[0:7]、qvel[0:6]）
+PlanarCarState ExtractPlanarState(const double* qpos, const double* qvel);
+
+// 代理模型前进 dt（半隐式欧拉，线性项按指数衰减积分）
+void PlanarCarStep(const PlanarCarParams& params, const double ctrl[2],
+                   double dt, PlanarCarState* state);
+
+// 影响车辆动力学的模型参数哈希：时间步长与积分器、质量、惯量与质心位置、
+//   几何尺寸与位置、摩擦与接触 solref、关节刚度、阻尼、电枢惯量与干摩擦、
+//   执行器传动比与增益/偏置参数、肌腱系数；任何一项改变后需重新拟合
+uint64_t CarModelFingerprint(const mjModel* model);
+
+// 参数文件（文本，每行 "名称 数值"，# 开头为注释）
+bool WritePlanarCarParams(const std::string& path,
+                          const PlanarCarParams& params);
+bool ReadPlanarCarParams(const std::string& path, PlanarCarParams* params);
+
+// 参数文件与当前模型是否一致（指纹相同）
+inline bool PlanarCarParamsCurrent(const PlanarCarParams& params,
+                                   const mjModel* model) {
+  return params.model_fingerprint == CarModelFingerprint(model);
+}
+
+// 轨迹文件（文本）：首行 "dt nu nq nv"，每行一个采样点，空行分隔轨迹
+bool WriteCarTrajectories(const std::string& path, const mjModel* model,
+                          const std::vector<CarTrajectory>& trajectories);
+bool ReadCarTrajectories(const std::string& path, const mjModel* model,
+                         std::vector<CarTrajectory>* trajectories);
+
+// 无界面生成轨迹：随机初始状态，分段常值随机控制
+struct SysIdGenerateConfig {
+  int num_trajectories = 64;
+  double duration = 5.0;       // 每条轨迹时长（秒）
+  double sample_dt = 0.02;     // 采样间隔（取整到物理步长的整数倍）
+  double hold_min = 0.2;       // 控制量保持时间范围（秒）
+  double hold_max = 1.0;
+  double max_speed = 1.0;      // 初速度范围 [0, max_speed]
+  uint64_t seed = 0;
+  int num_threads = 1;
+};
+
+std::vector<CarTrajectory> GenerateCarTrajectories(
+    const mjModel* model, const SysIdGenerateConfig& config);
+
+// 拟合质量：每个方程的残差均方根与决定系数，以及验证集上的开环预测误差
+struct SysIdReport {
+  int num_samples = 0;
+  double rms[4] = {0.0};  // 车轮半径、轮距、前进、转向方程
+  double r2[4] = {0.0};
+  int num_validation = 0;
+  double horizon = 0.0;             // 开环预测时长（秒）
+  double position_error_mean = 0.0;  // horizon 末端位置误差（米）
+  double position_error_p95 = 0.0;
+  double heading_error_mean = 0.0;   // 弧度
+};
+
+// 批量最小二乘：各线程累加正规方程后求解；每 validation_stride 条轨迹留一条做验证
+//   （0 时不留），验证集上从真实状态出发按记录的控制量开环预测 horizon 秒
+bool FitPlanarCar(const mjModel* model,
+                  const std::vector<CarTrajectory>& trajectories,
+                  int num_threads, int validation_stride, double horizon,
+                  PlanarCarParams* params, SysIdReport* report);
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_CAR_SYSID_H_
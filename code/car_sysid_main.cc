@@ -0,0 +1,162 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SimpleCar 平面代理模型辨识
+//   car_sysid --out=car_params.txt                      无界面生成轨迹并拟合
+//   car_sysid --in=trajectories.txt --out=car_params.txt  拟合记录的轨迹
+//   car_sysid --record=trajectories.txt                 另存生成的轨迹
+//   car_sysid --check=car_params.txt                    参数文件与模型不一致时返回 2
+// 模型修改后重新运行即可（默认 64 条 5 秒轨迹，多线程生成与累加）
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_sysid.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(std::string, in, "", "recorded trajectories (empty: generate)");
+ABSL_FLAG(std::string, record, "", "write generated trajectories here");
+ABSL_FLAG(std::string, out, "car_params.txt", "parameter file");
+ABSL_FLAG(std::string, check, "",
+          "only check that this parameter file matches the model");
+ABSL_FLAG(int, trajectories, 64, "generated trajectories");
+ABSL_FLAG(double, duration, 5.0, "generated trajectory duration (s)");
+ABSL_FLAG(double, sample_dt, 0.02, "sample interval (s)");
+ABSL_FLAG(int, seed, 0, "random seed for generated trajectories");
+ABSL_FLAG(int, validation, 5, "hold out every n-th trajectory (0: none)");
+ABSL_FLAG(double, horizon, 1.0, "open-loop validation horizon (s)");
+ABSL_FLAG(int, threads, 0, "worker threads (0: hardware concurrency)");
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+
+  std::string check = absl::GetFlag(FLAGS_check);
+  if (!check.empty()) {
+    mjpc::PlanarCarParams params;
+    int status = 0;
+    if (!mjpc::ReadPlanarCarParams(check, &params)) {
+      std::fprintf(stderr, "could not read '%s'\n", check.c_str());
+      status = 1;
+    } else if (!mjpc::PlanarCarParamsCurrent(params, model)) {
+      std::printf("%s is stale: fitted for model %016llx, current %016llx\n",
+                  check.c_str(),
+                  static_cast<unsigned long long>(params.model_fingerprint),
+                  static_cast<unsigned long long>(
+                      mjpc::CarModelFingerprint(model)));
+      status = 2;
+    } else {
+      std::printf("%s is current\n", check.c_str());
+    }
+    mj_deleteModel(model);
+    return status;
+  }
+
+  int threads = absl::GetFlag(FLAGS_threads);
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<mjpc::CarTrajectory> trajectories;
+  std::string in = absl::GetFlag(FLAGS_in);
+  if (!in.empty()) {
+    if (!mjpc::ReadCarTrajectories(in, model, &trajectories)) {
+      std::fprintf(stderr, "could not read trajectories from '%s'\n",
+                   in.c_str());
+      mj_deleteModel(model);
+      return 1;
+    }
+  } else {
+    mjpc::SysIdGenerateConfig config;
+    config.num_trajectories = absl::GetFlag(FLAGS_trajectories);
+    config.duration = absl::GetFlag(FLAGS_duration);
+    config.sample_dt = absl::GetFlag(FLAGS_sample_dt);
+    config.seed = absl::GetFlag(FLAGS_seed);
+    config.num_threads = threads;
+    trajectories = mjpc::GenerateCarTrajectories(model, config);
+    std::string record = absl::GetFlag(FLAGS_record);
+    if (!record.empty() &&
+        !mjpc::WriteCarTrajectories(record, model, trajectories)) {
+      std::fprintf(stderr, "could not write '%s'\n", record.c_str());
+    }
+  }
+  auto loaded = std::chrono::steady_clock::now();
+
+  mjpc::PlanarCarParams params;
+  mjpc::SysIdReport report;
+  if (!mjpc::FitPlanarCar(model, trajectories, threads,
+                          absl::GetFlag(FLAGS_validation),
+                          absl::GetFlag(FLAGS_horizon), &params, &report)) {
+    std::fprintf(stderr, "fit failed (not enough excitation?)\n");
+    mj_deleteModel(model);
+    return 1;
+  }
+  auto fitted = std::chrono::steady_clock::now();
+
+  std::string out = absl::GetFlag(FLAGS_out);
+  if (!mjpc::WritePlanarCarParams(out, params)) {
+    std::fprintf(stderr, "could not write '%s'\n", out.c_str());
+    mj_deleteModel(model);
+    return 1;
+  }
+
+  std::printf("%zu trajectories, %d samples, %s %.2f s, fit %.3f s, %d threads\n",
+              trajectories.size(), report.num_samples,
+              in.empty() ? "generate" : "read",
+              std::chrono::duration<double>(loaded - start).count(),
+              std::chrono::duration<double>(fitted - loaded).count(), threads);
+  std::printf("  wheel_radius   %10.5f m\n", params.wheel_radius);
+  std::printf("  track_width    %10.5f m\n", params.track_width);
+  std::printf("  drag_linear    %10.5f 1/s\n", params.drag_linear);
+  std::printf("  drag_quadratic %10.5f 1/m\n", params.drag_quadratic);
+  std::printf("  forward_gain   %10.5f m/s^2 (gear %g)\n", params.forward_gain,
+              params.gear[0]);
+  std::printf("  turn_gain      %10.5f rad/s (gear %g)\n", params.turn_gain,
+              params.gear[1]);
+  std::printf("  turn_lag       %10.5f s\n", params.turn_lag);
+  const char* equations[4] = {"wheel", "track", "forward", "turn"};
+  for (int i = 0; i < 4; i++) {
+    std::printf("  fit %-8s rms %.3e  r2 %.4f\n", equations[i], report.rms[i],
+                report.r2[i]);
+  }
+  if (report.num_validation > 0) {
+    std::printf("  validation: %d windows of %.2f s, position error mean %.4f m "
+                "p95 %.4f m, heading error mean %.4f rad\n",
+                report.num_validation, report.horizon,
+                report.position_error_mean, report.position_error_p95,
+                report.heading_error_mean);
+  }
+  std::printf("wrote %s\n", out.c_str());
+
+  mj_deleteModel(model);
+  return 0;
+}
@@ -0,0 +1,137 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/cost_landscape.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_rollout.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+#include "mjpc/threadpool.h"
+
+namespace mjpc {
+
+namespace {
+
+constexpr char kLandscapeMagic[8] = {'M', 'J', 'C', 'O', 'S', 'T', 'L', 'S'};
+
+// 每次从共享计数器领取的网格点数
+constexpr int64_t kCellsPerBlock = 256;
+
+}  // namespace
+
+bool ExportCostLandscape(const mjModel* model, const SimpleCar& task,
+                         const CostLandscapeConfig& config,
+                         const std::string& path) {
+  const LandscapeAxis* axes[4] = {&config.goal_x, &config.goal_y,
+                                  &config.heading, &config.speed};
+  int64_t num_cells = 1;
+  for (const LandscapeAxis* axis : axes) {
+    if (axis->count < 1) return false;
+    num_cells *= axis->count;
+  }
+  int steps = std::max(1, static_cast<int>(
+                              std::round(config.duration / model->opt.timestep)));
+
+  // 输出文件：先定长再映射，各线程直接写入自己的网格点
+  size_t bytes = sizeof(CostLandscapeHeader) + num_cells * sizeof(float);
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return false;
+  if (ftruncate(fd, bytes) != 0) {
+    close(fd);
+    return false;
+  }
+  void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return false;
+
+  CostLandscapeHeader* header = static_cast<CostLandscapeHeader*>(map);
+  std::memset(header, 0, sizeof(*header));
+  std::memcpy(header->magic, kLandscapeMagic, sizeof(kLandscapeMagic));
+  header->version = 1;
+  header->steps = steps;
+  for (int i = 0; i < 4; i++) {
+    header->dims[i] = axes[i]->count;
+    header->axis[i][0] = axes[i]->min;
+    header->axis[i][1] = axes[i]->max;
+  }
+  header->duration = config.duration;
+  header->timestep = model->opt.timestep;
+  header->ctrl[0] = config.ctrl[0];
+  header->ctrl[1] = config.ctrl[1];
+  float* costs = reinterpret_cast<float*>(header + 1);
+
+  int num_threads = std::max(1, config.num_threads);
+  std::atomic<int64_t> next_block{0};
+
+  ThreadPool pool(num_threads);
+  int count_before = pool.GetCount();
+  for (int i = 0; i < num_threads; i++) {
+    pool.Schedule([&]() {
+      // 线程私有的 mjData、轨迹缓冲区和残差对象
+      mjData* data = mj_makeData(model);
+      SimpleCar::ResidualFn residual(&task);
+      CarRollout rollout;
+      rollout.Allocate(model, task.num_residual, steps);
+      rollout.set_mode(config.rollout_mode);
+
+      double ctrl[2] = {config.ctrl[0], config.ctrl[1]};
+      while (true) {
+        int64_t begin = next_block.fetch_add(kCellsPerBlock);
+        if (begin >= num_cells) break;
+        int64_t end = std::min(begin + kCellsPerBlock, num_cells);
+
+        for (int64_t cell = begin; cell < end; cell++) {
+          // 线性下标 -> 各维下标（speed 变化最快）
+          int64_t rest = cell;
+          int is = rest % config.speed.count;
+          rest /= config.speed.count;
+          int ih = rest % config.heading.count;
+          rest /= config.heading.count;
+          int iy = rest % config.goal_y.count;
+          int ix = rest / config.goal_y.count;
+
+          CarInitialState state;
+          state.heading = config.heading.Value(ih);
+          state.speed = config.speed.Value(is);
+          state.goal[0] = config.goal_x.Value(ix);
+          state.goal[1] = config.goal_y.Value(iy);
+
+          CarRollout::SetState(model, data, state);
+          costs[cell] = rollout.Rollout(model, data, residual, ctrl, steps);
+        }
+      }
+
+      mj_deleteData(data);
+    });
+  }
+  pool.WaitCount(count_before + num_threads);
+  pool.ResetCount();
+
+  msync(map, bytes, MS_SYNC);
+  munmap(map, bytes);
+  return true;
+}
+
+}  // namespace mjpc
@@ -0,0 +1,75 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_COST_LANDSCAPE_H_
+#define MJPC_TASKS_SIMPLE_CAR_COST_LANDSCAPE_H_
+
+#include <cstdint>
+#include <string>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_rollout.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+namespace mjpc {
+
+// 网格的一个维度：[min, max] 上均匀取 count 个点
+struct LandscapeAxis {
+  double min = 0.0;
+  double max = 0.0;
+  int count = 1;
+
+  double Value(int i) const {
+    return count > 1 ? min + (max - min) * i / (count - 1) : min;
+  }
+};
+
+// 代价地形配置：目标相对位置 (x, y) × 车头朝向 × 初速度
+struct CostLandscapeConfig {
+  LandscapeAxis goal_x = {-3.0, 3.0, 61};
+  LandscapeAxis goal_y = {-3.0, 3.0, 61};
+  LandscapeAxis heading = {-3.14159265358979, 3.14159265358979, 16};
+  LandscapeAxis speed = {0.0, 1.0, 16};
+  double duration = 0.5;        // 每个网格点的 rollout 时长（秒）
+  double ctrl[2] = {0.0, 0.0};  // 固定控制量（forward, turn）
+  int num_threads = 1;
+  // 只需要总代价，默认逐步融合评估，不保存整条轨迹
+  CarRollout::Mode rollout_mode = CarRollout::kFused;
+};
+
+// 输出文件头（256 字节），其后是 float32 代价数组
+//   下标顺序 [goal_x][goal_y][heading][speed]，speed 变化最快
+struct CostLandscapeHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t steps;        // 每个 rollout 的物理步数
+  uint32_t dims[4];      // goal_x, goal_y, heading, speed
+  double axis[4][2];     // 各维度 [min, max]
+  double duration;
+  double timestep;
+  double ctrl[2];
+  uint8_t reserved[256 - 128];
+};
+static_assert(sizeof(CostLandscapeHeader) == 256,
+              "CostLandscapeHeader must stay 256 bytes");
+
+// 在所有网格点上评估 SimpleCar 完整代价并写入 path（内存映射输出），
+//   task 需已 Reset(model)。成功返回 true
+bool ExportCostLandscape(const mjModel* model, const SimpleCar& task,
+                         const CostLandscapeConfig& config,
+                         const std::string& path);
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_COST_LANDSCAPE_H_
@@ -0,0 +1,173 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/dashboard_panel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+namespace {
+
+// 面板相机距 z=0 平面的距离
+constexpr float kCameraDistance = 10.0f;
+
+void SetPanelCamera(mjvScene* scene) {
+  for (mjvGLCamera& camera : scene->camera) DashboardCamera(&camera);
+}
+
+}  // namespace
+
+void DashboardCamera(mjvGLCamera* camera) {
+  const DashboardRegion& region = kDashboardRegion;
+  camera->pos[0] = region.center[0];
+  camera->pos[1] = region.center[1];
+  camera->pos[2] = kCameraDistance;
+  camera->forward[0] = 0.0f;
+  camera->forward[1] = 0.0f;
+  camera->forward[2] = -1.0f;
+  camera->up[0] = 0.0f;
+  camera->up[1] = 1.0f;
+  camera->up[2] = 0.0f;
+  camera->frustum_near = 1.0f;
+  camera->frustum_far = 2.0f * kCameraDistance;
+  camera->frustum_center = 0.0f;
+  camera->frustum_width = region.half[0] / kCameraDistance;
+  camera->frustum_top = region.half[1] / kCameraDistance;
+  camera->frustum_bottom = -camera->frustum_top;
+  camera->orthographic = 0;
+}
+
+DashboardPanel::~DashboardPanel() { Free(); }
+
+bool DashboardPanel::Initialize(const mjModel* model,
+                                const mjrContext* context, int width,
+                                double max_rate, int maxgeom) {
+  Free();
+  const DashboardRegion& region = kDashboardRegion;
+  width_ = std::min(width, context->offWidth);
+  height_ = static_cast<int>(width_ * region.half[1] / region.half[0]);
+  if (height_ > context->offHeight) {
+    height_ = context->offHeight;
+    width_ = static_cast<int>(height_ * region.half[0] / region.half[1]);
+  }
+  if (width_ <= 0 || height_ <= 0) return false;
+  rgb_.assign(3 * width_ * height_, 0);
+
+  mjv_defaultScene(&scene_);
+  mjv_makeScene(model, &scene_, maxgeom);
+  // 只有仪表盘 geom：不需要阴影、反射、天空盒和雾
+  scene_.flags[mjRND_SHADOW] = 0;
+  scene_.flags[mjRND_REFLECTION] = 0;
+  scene_.flags[mjRND_SKYBOX] = 0;
+  scene_.flags[mjRND_FOG] = 0;
+  scene_.nlight = 0;
+  for (int i = 0; i < scene_.maxgeom; i++) {
+    mjv_initGeom(scene_.geoms + i, mjGEOM_NONE, nullptr, nullptr, nullptr,
+                 nullptr);
+  }
+
+  min_interval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(max_rate > 0.0 ? 1.0 / max_rate : 0.0));
+  has_version_ = false;
+  last_ngeom_ = 0;
+  ResetStats();
+  initialized_ = true;
+  return true;
+}
+
+void DashboardPanel::Free() {
+  if (!initialized_) return;
+  mjv_freeScene(&scene_);
+  rgb_.clear();
+  initialized_ = false;
+}
+
+bool DashboardPanel::Update(uint64_t version, const DrawFn& draw,
+                            mjrContext* context) {
+  if (!initialized_) return false;
+  stats_.frames++;
+  if (has_version_ && version == version_) {
+    stats_.unchanged++;
+    return false;
+  }
+  auto now = std::chrono::steady_clock::now();
+  if (has_version_ && now - last_render_ < min_interval_) {
+    stats_.rate_limited++;
+    return false;
+  }
+
+  Render(draw, context);
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - now).count();
+  last_render_ = now;
+  version_ = version;
+  has_version_ = true;
+
+  stats_.renders++;
+  render_ms_sum_ += ms;
+  stats_.render_ms_max = std::max(stats_.render_ms_max, ms);
+  return true;
+}
+
+void DashboardPanel::Render(const DrawFn& draw, mjrContext* context) {
+  // 上次用过的 geom 恢复默认值（绘制函数只写部分字段，例如标签文字）
+  for (int i = 0; i < last_ngeom_; i++) {
+    mjv_initGeom(scene_.geoms + i, mjGEOM_NONE, nullptr, nullptr, nullptr,
+                 nullptr);
+  }
+  scene_.ngeom = 0;
+  draw(&scene_);
+  last_ngeom_ = scene_.ngeom;
+
+  // 没有光源：自发光取 1，颜色与 rgba 一致
+  for (int i = 0; i < scene_.ngeom; i++) scene_.geoms[i].emission = 1.0f;
+  SetPanelCamera(&scene_);
+
+  int buffer = context->currentBuffer;
+  mjrRect rect = {0, 0, width_, height_};
+  mjr_setBuffer(mjFB_OFFSCREEN, context);
+  mjr_render(rect, &scene_, context);
+  mjr_readPixels(rgb_.data(), nullptr, rect, context);
+  mjr_setBuffer(buffer, context);
+}
+
+void DashboardPanel::Composite(mjrRect viewport,
+                               const mjrContext* context) const {
+  if (!initialized_ || !has_version_) return;
+  mjrRect rect;
+  rect.width = width_;
+  rect.height = height_;
+  rect.left = viewport.left + std::max(0, (viewport.width - width_) / 2);
+  rect.bottom = viewport.bottom + std::max(0, viewport.height - height_);
+  mjr_drawPixels(rgb_.data(), nullptr, rect, context);
+}
+
+DashboardPanelStats DashboardPanel::stats() const {
+  DashboardPanelStats stats = stats_;
+  stats.render_ms_mean =
+      stats_.renders > 0 ? render_ms_sum_ / stats_.renders : 0.0;
+  return stats;
+}
+
+void DashboardPanel::ResetStats() {
+  stats_ = DashboardPanelStats();
+  render_ms_sum_ = 0.0;
+}
+
+}  // namespace mjpc
@@ -0,0 +1,102 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_DASHBOARD_PANEL_H_
+#define MJPC_TASKS_SIMPLE_CAR_DASHBOARD_PANEL_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 仪表盘在 z=0 平面上占据的区域（与 ModifyScene 中的布局一致）
+struct DashboardRegion {
+  float center[2];
+  float half[2];
+};
+inline constexpr DashboardRegion kDashboardRegion = {{0.0f, 0.9f},
+                                                     {4.5f, 2.0f}};
+
+// 正对仪表盘区域的相机：z=0 平面上的视野恰好是 kDashboardRegion（宽高比与区域一致）
+void DashboardCamera(mjvGLCamera* camera);
+
+struct DashboardPanelStats {
+  uint64_t frames = 0;        // Update 调用次数
+  uint64_t renders = 0;       // 实际重绘次数
+  uint64_t unchanged = 0;     // 内容未变化而跳过
+  uint64_t rate_limited = 0;  // 内容已变化但受频率上限推迟
+  double render_ms_mean = 0.0;
+  double render_ms_max = 0.0;
+};
+
+// 仪表盘面板缓存：内容变化时把仪表盘单独渲染到 offscreen 缓冲区并读回像素，
+//   每帧只把缓存的像素贴到主画面上（一次 mjr_drawPixels），
+//   主画面帧率与仪表盘的 geom 数量无关
+// 只使用 mjr_* 接口，软件 GL（llvmpipe / OSMesa）下同样可用
+// 所有函数都需要在持有 GL 上下文的渲染线程中调用
+class DashboardPanel {
+ public:
+  using DrawFn = std::function<void(mjvScene* scene)>;
+
+  DashboardPanel() = default;
+  ~DashboardPanel();
+  DashboardPanel(const DashboardPanel&) = delete;
+  DashboardPanel& operator=(const DashboardPanel&) = delete;
+
+  // width 为面板像素宽度，按 offscreen 缓冲区大小裁剪，高度按区域宽高比确定
+  bool Initialize(const mjModel* model, const mjrContext* context, int width,
+                  double max_rate = 30.0, int maxgeom = 1000);
+  void Free();
+  bool IsInitialized() const { return initialized_; }
+
+  // 每帧调用：version 变化且距上次重绘超过 1/max_rate 秒时调用 draw 重绘，
+  //   返回是否重绘；结束后恢复调用前的帧缓冲区
+  bool Update(uint64_t version, const DrawFn& draw, mjrContext* context);
+
+  // 主画面渲染之后调用：把缓存的面板贴到 viewport 顶部中间
+  void Composite(mjrRect viewport, const mjrContext* context) const;
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  const std::vector<unsigned char>& pixels() const { return rgb_; }
+
+  DashboardPanelStats stats() const;
+  void ResetStats();
+
+ private:
+  void Render(const DrawFn& draw, mjrContext* context);
+
+  bool initialized_ = false;
+  mjvScene scene_;
+  int width_ = 0;
+  int height_ = 0;
+  std::vector<unsigned char> rgb_;
+
+  std::chrono::steady_clock::duration min_interval_{};
+  std::chrono::steady_clock::time_point last_render_;
+  bool has_version_ = false;
+  uint64_t version_ = 0;
+  int last_ngeom_ = 0;
+
+  DashboardPanelStats stats_;
+  double render_ms_sum_ = 0.0;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_DASHBOARD_PANEL_H_
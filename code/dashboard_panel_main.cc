@@ -0,0 +1,200 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 仪表盘面板缓存对比（隐藏窗口 + offscreen 渲染，可在软件 GL 下运行）
+//   dashboard_panel --frames=600 --out=frame
+//   无显示器的 CI：xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 dashboard_panel
+// 依次运行每帧直接绘制仪表盘 geom 与面板缓存两种方式，报告帧耗时、
+//   每帧 geom 数和面板重绘次数；--out 非空时把两种方式的最后一帧写成 PPM
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <GLFW/glfw3.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/dashboard_panel.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(int, frames, 600, "frames per mode");
+ABSL_FLAG(double, fps, 60.0, "simulated frame rate");
+ABSL_FLAG(int, width, 1280, "frame width (clamped to offscreen size)");
+ABSL_FLAG(int, height, 720, "frame height (clamped to offscreen size)");
+ABSL_FLAG(int, panel_width, 720, "dashboard panel width in pixels");
+ABSL_FLAG(double, panel_rate, 30.0, "maximum panel redraw rate (Hz)");
+ABSL_FLAG(std::string, out, "", "write <out>_direct.ppm / <out>_cached.ppm");
+
+namespace {
+
+struct ModeResult {
+  double ms_per_frame = 0.0;
+  double geoms_per_frame = 0.0;
+};
+
+bool WritePpm(const std::string& path, const std::vector<unsigned char>& rgb,
+              int width, int height) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) return false;
+  std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+  // OpenGL 行序自下而上
+  for (int row = height - 1; row >= 0; row--) {
+    std::fwrite(rgb.data() + 3 * width * row, 1, 3 * width, file);
+  }
+  std::fclose(file);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+  mjData* data = mj_makeData(model);
+
+  if (!glfwInit()) {
+    std::fprintf(stderr, "could not initialize GLFW\n");
+    return 1;
+  }
+  glfwWindowHint(GLFW_VISIBLE, 0);
+  GLFWwindow* window =
+      glfwCreateWindow(800, 600, "dashboard_panel", nullptr, nullptr);
+  if (!window) {
+    std::fprintf(stderr, "could not create GL context\n");
+    glfwTerminate();
+    return 1;
+  }
+  glfwMakeContextCurrent(window);
+
+  mjrContext context;
+  mjr_defaultContext(&context);
+  mjr_makeContext(model, &context, mjFONTSCALE_150);
+
+  mjvScene scene;
+  mjvCamera camera;
+  mjvOption option;
+  mjvPerturb perturb;
+  mjv_defaultScene(&scene);
+  mjv_makeScene(model, &scene, 2000);
+  mjv_defaultCamera(&camera);
+  mjv_defaultOption(&option);
+  mjv_defaultPerturb(&perturb);
+  camera.lookat[1] = 1.0;
+  camera.distance = 12.0;
+  camera.elevation = -60.0;
+
+  mjrRect viewport = {0, 0,
+                      std::min(absl::GetFlag(FLAGS_width), context.offWidth),
+                      std::min(absl::GetFlag(FLAGS_height), context.offHeight)};
+  std::vector<unsigned char> rgb(3 * viewport.width * viewport.height);
+
+  mjpc::DashboardPanel panel;
+  if (!panel.Initialize(model, &context, absl::GetFlag(FLAGS_panel_width),
+                        absl::GetFlag(FLAGS_panel_rate))) {
+    std::fprintf(stderr, "could not allocate dashboard panel\n");
+    return 1;
+  }
+  auto draw = [&task](mjvScene* s) { task.DrawDashboard(s); };
+
+  int frames = std::max(1, absl::GetFlag(FLAGS_frames));
+  int steps = std::max(1, static_cast<int>(std::round(
+                              1.0 / (absl::GetFlag(FLAGS_fps) *
+                                     model->opt.timestep))));
+  std::string out = absl::GetFlag(FLAGS_out);
+
+  ModeResult results[2];
+  const char* names[2] = {"direct", "cached"};
+  for (int mode = 0; mode < 2; mode++) {
+    bool cached = mode == 1;
+    mj_resetData(model, data);
+    task.Reset(model);
+    task.set_dashboard_overlay(cached);
+    panel.ResetStats();
+    mjr_setBuffer(mjFB_OFFSCREEN, &context);
+
+    double seconds = 0.0;
+    long long geoms = 0;
+    for (int frame = 0; frame < frames; frame++) {
+      // 固定的加速/转向曲线，让车速、转速等读数持续变化
+      double t = data->time;
+      data->ctrl[0] = std::sin(0.5 * t);
+      data->ctrl[1] = 0.5 * std::sin(0.2 * t);
+      for (int i = 0; i < steps; i++) mj_step(model, data);
+      task.Transition(model, data);
+      // 表盘贴图在 Transition 中烘焙，有新版本时上传
+      task.UploadGaugeFaces(model, &context);
+
+      auto start = std::chrono::steady_clock::now();
+      mjv_updateScene(model, data, &option, &perturb, &camera, mjCAT_ALL,
+                      &scene);
+      task.ModifyScene(model, data, &scene);
+      if (cached) panel.Update(task.DashboardVersion(), draw, &context);
+      mjr_render(viewport, &scene, &context);
+      if (cached) panel.Composite(viewport, &context);
+      mjr_finish();
+      seconds += std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start).count();
+      geoms += scene.ngeom;
+    }
+    results[mode].ms_per_frame = 1e3 * seconds / frames;
+    results[mode].geoms_per_frame = static_cast<double>(geoms) / frames;
+
+    if (!out.empty()) {
+      mjr_readPixels(rgb.data(), nullptr, viewport, &context);
+      std::string path = out + "_" + names[mode] + ".ppm";
+      if (!WritePpm(path, rgb, viewport.width, viewport.height)) {
+        std::fprintf(stderr, "could not write '%s'\n", path.c_str());
+      }
+    }
+  }
+
+  std::printf("%d frames at %dx%d, panel %dx%d\n", frames, viewport.width,
+              viewport.height, panel.width(), panel.height());
+  std::printf("  %-8s %12s %12s\n", "mode", "ms/frame", "geoms/frame");
+  for (int mode = 0; mode < 2; mode++) {
+    std::printf("  %-8s %12.3f %12.1f\n", names[mode],
+                results[mode].ms_per_frame, results[mode].geoms_per_frame);
+  }
+  mjpc::DashboardPanelStats stats = panel.stats();
+  std::printf("  panel: %llu redraws (%.3f ms mean, %.3f ms max), "
+              "%llu unchanged, %llu rate-limited\n",
+              static_cast<unsigned long long>(stats.renders),
+              stats.render_ms_mean, stats.render_ms_max,
+              static_cast<unsigned long long>(stats.unchanged),
+              static_cast<unsigned long long>(stats.rate_limited));
+
+  panel.Free();
+  mjv_freeScene(&scene);
+  mjr_freeContext(&context);
+  glfwDestroyWindow(window);
+  glfwTerminate();
+  mj_deleteData(data);
+  mj_deleteModel(model);
+  return 0;
+}
@@ -0,0 +1,516 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/dashboard_stream.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mjpc/tasks/simple_car/telemetry.h"
+
+namespace mjpc {
+
+namespace {
+
+constexpr int kMaxClients = 16;
+constexpr size_t kMaxRequest = 8192;
+constexpr double kKeyFrameInterval = 2.0;  // 关键帧间隔（s）
+
+// ---------- SHA-1 / Base64（仅用于 WebSocket 握手） ----------
+uint32_t RotateLeft(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+void Sha1(std::string_view message, uint8_t digest[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                   0xC3D2E1F0};
+  std::string data(message);
+  uint64_t bits = static_cast<uint64_t>(message.size()) * 8;
+  data.push_back(static_cast<char>(0x80));
+  while (data.size() % 64 != 56) data.push_back('\0');
+  for (int i = 7; i >= 0; i--) data.push_back(static_cast<char>(bits >> (8 * i)));
+
+  for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* p =
+          reinterpret_cast<const uint8_t*>(data.data() + chunk + 4 * i);
+      w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+             (uint32_t(p[2]) << 8) | p[3];
+    }
+    for (int i = 16; i < 80; i++) {
+      w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t t = RotateLeft(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = RotateLeft(b, 30);
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 4; j++) digest[4 * i + j] = h[i] >> (24 - 8 * j);
+  }
+}
+
+std::string Base64(const uint8_t* data, size_t size) {
+  static const char kTable[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < size; i += 3) {
+    uint32_t n = uint32_t(data[i]) << 16;
+    if (i + 1 < size) n |= uint32_t(data[i + 1]) << 8;
+    if (i + 2 < size) n |= data[i + 2];
+    out.push_back(kTable[(n >> 18) & 63]);
+    out.push_back(kTable[(n >> 12) & 63]);
+    out.push_back(i + 1 < size ? kTable[(n >> 6) & 63] : '=');
+    out.push_back(i + 2 < size ? kTable[n & 63] : '=');
+  }
+  return out;
+}
+
+// 请求头字段值（不区分大小写），不存在时返回空
+std::string HeaderValue(std::string_view request, std::string_view name) {
+  size_t pos = 0;
+  while ((pos = request.find("\r\n", pos)) != std::string_view::npos) {
+    pos += 2;
+    std::string_view line = request.substr(pos, request.find("\r\n", pos) - pos);
+    if (line.size() > name.size() && line[name.size()] == ':' &&
+        std::equal(name.begin(), name.end(), line.begin(), [](char a, char b) {
+          return std::tolower(static_cast<unsigned char>(a)) ==
+                 std::tolower(static_cast<unsigned char>(b));
+        })) {
+      std::string_view value = line.substr(name.size() + 1);
+      while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+      while (!value.empty() && value.back() == ' ') value.remove_suffix(1);
+      return std::string(value);
+    }
+  }
+  return std::string();
+}
+
+// 内置页面：解码二进制帧并显示读数
+constexpr char kPage[] = R"(<!doctype html>
+<html><head><meta charset="utf-8"><title>SimpleCar dashboard</title>
+<style>body{font:16px monospace;background:#111;color:#eee}td{padding:2px 12px}</style>
+</head><body><table id="t"></table><script>
+const F=[["time",1e3],["speed_kmh",100],["rpm",1],["fuel",100],
+         ["temperature",100],["x",1e3],["y",1e3],["heading",1e4],["alerts",1]];
+const v=new Array(F.length).fill(0),t=document.getElementById("t");
+const ws=new WebSocket("ws://"+location.host+"/stream");
+ws.binaryType="arraybuffer";
+ws.onmessage=e=>{
+  const d=new DataView(e.data),key=d.getUint8(0)==0,mask=d.getUint16(5,true);
+  let p=7;
+  for(let i=0;i<F.length;i++){
+    if(!(mask>>i&1))continue;
+    if(key){v[i]=d.getInt32(p,true);p+=4;continue;}
+    let r=0,s=0,b;
+    do{b=d.getUint8(p++);r|=(b&127)<<s;s+=7;}while(b&128);
+    v[i]=(v[i]+((r>>>1)^-(r&1)))|0;
+  }
+  t.innerHTML=F.map((f,i)=>"<tr><td>"+f[0]+"</td><td>"+
+    (v[i]/f[1]).toFixed(2)+"</td></tr>").join("");
+};
+</script></body></html>
+)";
+
+void AppendHttp(std::vector<uint8_t>* out, const std::string& text) {
+  out->insert(out->end(), text.begin(), text.end());
+}
+
+// WebSocket 帧头（服务端帧不加掩码）
+void AppendFrameHeader(std::vector<uint8_t>* out, uint8_t opcode,
+                       size_t size) {
+  out->push_back(0x80 | opcode);
+  if (size < 126) {
+    out->push_back(size);
+  } else if (size < 65536) {
+    out->push_back(126);
+    out->push_back(size >> 8);
+    out->push_back(size & 0xFF);
+  } else {
+    out->push_back(127);
+    for (int i = 7; i >= 0; i--) out->push_back((uint64_t(size) >> (8 * i)) & 0xFF);
+  }
+}
+
+void PutU16(std::vector<uint8_t>* out, uint16_t value) {
+  out->push_back(value & 0xFF);
+  out->push_back(value >> 8);
+}
+
+void PutU32(std::vector<uint8_t>* out, uint32_t value) {
+  for (int i = 0; i < 4; i++) out->push_back((value >> (8 * i)) & 0xFF);
+}
+
+bool SetNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+}  // namespace
+
+void DashboardFixedPoint(const DashboardSnapshot& snapshot,
+                         int32_t values[kDashboardNumFields]) {
+  const double raw[kDashboardNumFields] = {
+      snapshot.time,        snapshot.speed_kmh, snapshot.rpm,
+      snapshot.fuel,        snapshot.temperature, snapshot.x,
+      snapshot.y,           snapshot.heading,
+      static_cast<double>(snapshot.alerts),
+  };
+  for (int i = 0; i < kDashboardNumFields; i++) {
+    double scaled = std::round(raw[i] * kDashboardFields[i].scale);
+    if (!std::isfinite(scaled)) scaled = 0.0;
+    values[i] = std::clamp(scaled, static_cast<double>(INT32_MIN),
+                           static_cast<double>(INT32_MAX));
+  }
+}
+
+void EncodeDashboardFrame(uint32_t sequence,
+                          const int32_t values[kDashboardNumFields],
+                          const int32_t* previous, std::vector<uint8_t>* frame) {
+  frame->clear();
+  frame->push_back(previous ? 1 : 0);
+  PutU32(frame, sequence);
+
+  uint16_t mask = 0;
+  for (int i = 0; i < kDashboardNumFields; i++) {
+    if (!previous || values[i] != previous[i]) mask |= 1 << i;
+  }
+  PutU16(frame, mask);
+
+  for (int i = 0; i < kDashboardNumFields; i++) {
+    if (!(mask & (1 << i))) continue;
+    if (!previous) {
+      PutU32(frame, static_cast<uint32_t>(values[i]));
+      continue;
+    }
+    // 差值按 32 位回绕，解码端同样回绕相加
+    int32_t delta = static_cast<int32_t>(static_cast<uint32_t>(values[i]) -
+                                         static_cast<uint32_t>(previous[i]));
+    uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^
+                      static_cast<uint32_t>(delta >> 31);
+    do {
+      uint8_t byte = zigzag & 0x7F;
+      zigzag >>= 7;
+      frame->push_back(zigzag ? byte | 0x80 : byte);
+    } while (zigzag);
+  }
+}
+
+struct DashboardStream::Client {
+  int fd = -1;
+  bool open = false;     // 已完成 WebSocket 握手
+  bool closing = false;  // 发完当前输出后关闭
+  std::string request;   // 握手请求 / 未解析的入站帧
+  std::vector<uint8_t> out;
+  size_t out_offset = 0;
+
+  // 差分基准：上一次实际发出的定点值
+  bool has_previous = false;
+  int32_t previous[kDashboardNumFields] = {0};
+  double last_key_time = 0.0;
+
+  bool pending() const { return out_offset < out.size(); }
+};
+
+DashboardStream::~DashboardStream() { Stop(); }
+
+bool DashboardStream::Start(const DashboardTelemetry* telemetry, int port,
+                            double rate, const std::string& address) {
+  if (IsRunning()) return true;
+  telemetry_ = telemetry;
+  period_ = 1.0 / std::max(rate, 1.0);
+
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) return false;
+  int reuse = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+      bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(listen_fd_, kMaxClients) != 0 || !SetNonBlocking(listen_fd_)) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+
+  wake_fd_ = eventfd(0, EFD_NONBLOCK);
+  stop_.store(false);
+  thread_ = std::thread(&DashboardStream::Loop, this);
+  return true;
+}
+
+void DashboardStream::Stop() {
+  if (!IsRunning()) return;
+  stop_.store(true);
+  uint64_t one = 1;
+  [[maybe_unused]] ssize_t written = write(wake_fd_, &one, sizeof(one));
+  thread_.join();
+  close(wake_fd_);
+  close(listen_fd_);
+  wake_fd_ = listen_fd_ = -1;
+}
+
+void DashboardStream::Loop() {
+  using Clock = std::chrono::steady_clock;
+  std::vector<Client> clients;
+  std::vector<pollfd> fds;
+  auto next_push = Clock::now();
+
+  while (!stop_.load()) {
+    fds.clear();
+    fds.push_back({wake_fd_, POLLIN, 0});
+    fds.push_back({listen_fd_, POLLIN, 0});
+    for (const Client& client : clients) {
+      short events = POLLIN | (client.pending() ? POLLOUT : 0);
+      fds.push_back({client.fd, events, 0});
+    }
+
+    int timeout = std::max<int64_t>(
+        0, std::chrono::duration_cast<std::chrono::milliseconds>(
+               next_push - Clock::now()).count());
+    if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) break;
+    if (fds[0].revents & POLLIN) break;
+
+    // 客户端读写；失败或关闭的连接标记后统一移除
+    for (size_t i = 0; i < clients.size(); i++) {
+      short revents = fds[i + 2].revents;
+      bool keep = !(revents & (POLLERR | POLLHUP | POLLNVAL));
+      if (keep && (revents & POLLIN)) keep = ReadClient(&clients[i]);
+      if (keep && (revents & POLLOUT)) keep = FlushClient(&clients[i]);
+      if (!keep) {
+        close(clients[i].fd);
+        clients[i].fd = -1;
+      }
+    }
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [](const Client& c) { return c.fd < 0; }),
+                  clients.end());
+
+    if (fds[1].revents & POLLIN) Accept(&clients);
+
+    if (Clock::now() >= next_push) {
+      Push(&clients);
+      next_push += std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(period_));
+      // 落后太多时不追赶
+      if (next_push < Clock::now()) next_push = Clock::now();
+    }
+    clients_.store(clients.size(), std::memory_order_relaxed);
+  }
+
+  for (Client& client : clients) close(client.fd);
+  clients_.store(0, std::memory_order_relaxed);
+}
+
+void DashboardStream::Accept(std::vector<Client>* clients) {
+  while (true) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) return;
+    if (clients->size() >= kMaxClients || !SetNonBlocking(fd)) {
+      close(fd);
+      continue;
+    }
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    Client client;
+    client.fd = fd;
+    clients->push_back(std::move(client));
+  }
+}
+
+bool DashboardStream::ReadClient(Client* client) {
+  char buffer[4096];
+  while (true) {
+    ssize_t n = recv(client->fd, buffer, sizeof(buffer), 0);
+    if (n == 0) return false;
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+      return false;
+    }
+    client->request.append(buffer, n);
+    if (client->request.size() > kMaxRequest) return false;
+  }
+
+  if (!client->open) {
+    size_t end = client->request.find("\r\n\r\n");
+    if (end == std::string::npos) return true;
+    std::string_view request(client->request.data(), end + 2);
+
+    std::string key = HeaderValue(request, "Sec-WebSocket-Key");
+    if (request.rfind("GET /stream ", 0) == 0 && !key.empty()) {
+      uint8_t digest[20];
+      Sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+      AppendHttp(&client->out,
+                 "HTTP/1.1 101 Switching Protocols\r\n"
+                 "Upgrade: websocket\r\n"
+                 "Connection: Upgrade\r\n"
+                 "Sec-WebSocket-Accept: " + Base64(digest, 20) + "\r\n\r\n");
+      client->open = true;
+    } else if (request.rfind("GET / ", 0) == 0) {
+      AppendHttp(&client->out,
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/html; charset=utf-8\r\n"
+                 "Content-Length: " + std::to_string(sizeof(kPage) - 1) +
+                 "\r\nConnection: close\r\n\r\n" + kPage);
+      client->closing = true;
+    } else {
+      AppendHttp(&client->out,
+                 "HTTP/1.1 404 Not Found\r\n"
+                 "Content-Length: 0\r\nConnection: close\r\n\r\n");
+      client->closing = true;
+    }
+    client->request.erase(0, end + 4);
+    return FlushClient(client);
+  }
+
+  // 入站帧：只处理 close 和 ping，其它消息忽略
+  std::string& in = client->request;
+  while (in.size() >= 2) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(in.data());
+    uint8_t opcode = p[0] & 0x0F;
+    bool masked = p[1] & 0x80;
+    uint64_t size = p[1] & 0x7F;
+    size_t header = 2;
+    if (size == 126) {
+      if (in.size() < 4) break;
+      size = (uint64_t(p[2]) << 8) | p[3];
+      header = 4;
+    } else if (size == 127) {
+      if (in.size() < 10) break;
+      size = 0;
+      for (int i = 0; i < 8; i++) size = (size << 8) | p[2 + i];
+      header = 10;
+    }
+    if (size > kMaxRequest) return false;
+    size_t total = header + (masked ? 4 : 0) + size;
+    if (in.size() < total) break;
+
+    std::string payload = in.substr(total - size, size);
+    if (masked) {
+      const uint8_t* key = p + header;
+      for (size_t i = 0; i < payload.size(); i++) payload[i] ^= key[i % 4];
+    }
+
+    if (opcode == 0x8) {
+      AppendFrameHeader(&client->out, 0x8, 0);
+      client->closing = true;
+    } else if (opcode == 0x9 && size <= 125) {
+      AppendFrameHeader(&client->out, 0xA, payload.size());
+      client->out.insert(client->out.end(), payload.begin(), payload.end());
+    }
+    in.erase(0, total);
+  }
+  return FlushClient(client);
+}
+
+bool DashboardStream::FlushClient(Client* client) {
+  while (client->pending()) {
+    ssize_t n = send(client->fd, client->out.data() + client->out_offset,
+                     client->out.size() - client->out_offset,
+                     MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    client->out_offset += n;
+  }
+  client->out.clear();
+  client->out_offset = 0;
+  return !client->closing;
+}
+
+void DashboardStream::Push(std::vector<Client>* clients) {
+  if (!telemetry_ || telemetry_->sequence() == 0) return;
+
+  DashboardSnapshot snapshot;
+  uint64_t sequence = telemetry_->Read(&snapshot);
+  int32_t values[kDashboardNumFields];
+  DashboardFixedPoint(snapshot, values);
+
+  std::vector<uint8_t> frame;
+  for (Client& client : *clients) {
+    if (!client.open || client.closing || client.fd < 0) continue;
+
+    // 上一帧还没发完：跳过本次，下次发送时差分基准仍是实际发出的值
+    if (client.pending()) {
+      frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+
+    bool key = !client.has_previous ||
+               snapshot.time < client.last_key_time ||
+               snapshot.time - client.last_key_time >= kKeyFrameInterval;
+    EncodeDashboardFrame(sequence, values,
+                         key ? nullptr : client.previous, &frame);
+    if (key) client.last_key_time = snapshot.time;
+
+    AppendFrameHeader(&client.out, 0x2, frame.size());
+    client.out.insert(client.out.end(), frame.begin(), frame.end());
+    std::copy(values, values + kDashboardNumFields, client.previous);
+    client.has_previous = true;
+    frames_sent_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!FlushClient(&client)) {
+      close(client.fd);
+      client.fd = -1;
+    }
+  }
+  clients->erase(std::remove_if(clients->begin(), clients->end(),
+                                [](const Client& c) { return c.fd < 0; }),
+                 clients->end());
+}
+
+}  // namespace mjpc
@@ -0,0 +1,103 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_DASHBOARD_STREAM_H_
+#define MJPC_TASKS_SIMPLE_CAR_DASHBOARD_STREAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mjpc/tasks/simple_car/telemetry.h"
+
+namespace mjpc {
+
+// 仪表盘二进制帧（WebSocket binary message 的负载，小端）：
+//   u8  类型（0 关键帧，1 差分帧）
+//   u32 快照序号
+//   u16 字段掩码（第 i 位对应 kDashboardFields[i]）
+//   每个置位字段：关键帧为 i32 定点值，差分帧为 zigzag varint 定点差值
+// 差分相对于该客户端上一次实际发出的值，被跳过的帧不会丢失信息
+struct DashboardField {
+  const char* name;
+  double scale;  // 定点值 = round(值 * scale)
+};
+
+inline constexpr int kDashboardNumFields = 9;
+inline constexpr DashboardField kDashboardFields[kDashboardNumFields] = {
+    {"time", 1000.0},       {"speed_kmh", 100.0}, {"rpm", 1.0},
+    {"fuel", 100.0},        {"temperature", 100.0}, {"x", 1000.0},
+    {"y", 1000.0},          {"heading", 10000.0}, {"alerts", 1.0},
+};
+
+// 快照转换为定点值
+void DashboardFixedPoint(const DashboardSnapshot& snapshot,
+                         int32_t values[kDashboardNumFields]);
+
+// 编码一帧；previous 为 nullptr 时编码关键帧
+void EncodeDashboardFrame(uint32_t sequence,
+                          const int32_t values[kDashboardNumFields],
+                          const int32_t* previous, std::vector<uint8_t>* frame);
+
+// 本地 WebSocket 服务：事件循环线程按固定频率读取最新快照并推送
+//   每个客户端最多一帧在途：上一帧未发完时跳过本次推送（只发最新的），
+//   仿真线程只写顺序锁，不会被慢客户端阻塞
+//   GET / 返回一个内置的仪表盘页面，GET /stream 升级为 WebSocket
+class DashboardStream {
+ public:
+  DashboardStream() = default;
+  ~DashboardStream();
+  DashboardStream(const DashboardStream&) = delete;
+  DashboardStream& operator=(const DashboardStream&) = delete;
+
+  // 启动服务；address 默认只监听本机
+  bool Start(const DashboardTelemetry* telemetry, int port, double rate,
+             const std::string& address = "127.0.0.1");
+  void Stop();
+  bool IsRunning() const { return thread_.joinable(); }
+
+  int clients() const { return clients_.load(std::memory_order_relaxed); }
+  uint64_t frames_sent() const {
+    return frames_sent_.load(std::memory_order_relaxed);
+  }
+  uint64_t frames_dropped() const {
+    return frames_dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Client;
+
+  void Loop();
+  void Accept(std::vector<Client>* clients);
+  bool ReadClient(Client* client);
+  bool FlushClient(Client* client);
+  void Push(std::vector<Client>* clients);
+
+  const DashboardTelemetry* telemetry_ = nullptr;
+  double period_ = 0.05;
+  int listen_fd_ = -1;
+  int wake_fd_ = -1;  // eventfd：通知事件循环退出
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+
+  std::atomic<int> clients_{0};
+  std::atomic<uint64_t> frames_sent_{0};
+  std::atomic<uint64_t> frames_dropped_{0};
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_DASHBOARD_STREAM_H_
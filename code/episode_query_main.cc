@@ -0,0 +1,114 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 回合结果查询工具
+//   episode_query --store=episodes.bin --reindex
+//   episode_query --store=episodes.bin --param_hash=... --field=ttg_mean
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include "mjpc/tasks/simple_car/episode_store.h"
+
+ABSL_FLAG(std::string, store, "", "episode store path");
+ABSL_FLAG(bool, reindex, false, "rebuild the sidecar index before querying");
+ABSL_FLAG(int64_t, seed, -1, "filter on seed (-1: any)");
+ABSL_FLAG(std::string, param_hash, "", "filter on parameter hash (hex)");
+ABSL_FLAG(double, min_rtf, -1.0, "filter on rtf >= value (<0: any)");
+ABSL_FLAG(std::string, field, "ttg_mean",
+          "aggregated field: ttg_mean, ttg_min, ttg_max, ttg_p95, goals, rtf");
+ABSL_FLAG(int, threads, 0, "scan threads (0: hardware concurrency)");
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::string path = absl::GetFlag(FLAGS_store);
+  if (path.empty()) {
+    std::fprintf(stderr, "--store is required\n");
+    return 1;
+  }
+
+  mjpc::EpisodeStoreReader store;
+  if (!store.Open(path)) {
+    std::fprintf(stderr, "failed to open store '%s'\n", path.c_str());
+    return 1;
+  }
+
+  std::string index_path = mjpc::EpisodeIndex::IndexPath(path);
+  if (absl::GetFlag(FLAGS_reindex)) {
+    auto start = std::chrono::steady_clock::now();
+    if (!mjpc::EpisodeIndex::Build(store, index_path)) {
+      std::fprintf(stderr, "failed to write index '%s'\n", index_path.c_str());
+      return 1;
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start).count();
+    std::printf("indexed %zu records in %.3f s\n", store.size(), seconds);
+  }
+
+  mjpc::EpisodeIndex index;
+  bool has_index = index.Load(index_path);
+
+  mjpc::EpisodeFilter filter;
+  if (absl::GetFlag(FLAGS_seed) >= 0) {
+    filter.has_seed = true;
+    filter.seed = absl::GetFlag(FLAGS_seed);
+  }
+  if (!absl::GetFlag(FLAGS_param_hash).empty()) {
+    std::string hash = absl::GetFlag(FLAGS_param_hash);
+    char* end = nullptr;
+    errno = 0;
+    filter.has_param_hash = true;
+    filter.param_hash = std::strtoull(hash.c_str(), &end, 16);
+    if (errno != 0 || end == hash.c_str() || *end != '\0') {
+      std::fprintf(stderr, "--param_hash: '%s' is not a hex hash\n",
+                   hash.c_str());
+      return 1;
+    }
+  }
+  filter.min_rtf = absl::GetFlag(FLAGS_min_rtf);
+
+  mjpc::EpisodeField field;
+  if (!mjpc::ParseEpisodeField(absl::GetFlag(FLAGS_field), &field)) {
+    std::fprintf(stderr, "unknown field '%s'\n",
+                 absl::GetFlag(FLAGS_field).c_str());
+    return 1;
+  }
+
+  int threads = absl::GetFlag(FLAGS_threads);
+  if (threads <= 0) threads = std::thread::hardware_concurrency();
+
+  auto start = std::chrono::steady_clock::now();
+  mjpc::EpisodeAggregate result = mjpc::QueryEpisodes(
+      store, has_index ? &index : nullptr, filter, field, threads);
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+
+  std::printf("records: %zu (indexed: %zu)  matched: %zu  scan: %.3f s\n",
+              store.size(), has_index ? index.covered() : 0, result.count,
+              seconds);
+  if (result.count > 0) {
+    std::printf("%s: mean %.4f  min %.4f  max %.4f  p50 %.4f  p95 %.4f\n",
+                absl::GetFlag(FLAGS_field).c_str(), result.mean, result.min,
+                result.max, result.p50, result.p95);
+  }
+  return 0;
+}
@@ -0,0 +1,416 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/episode_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mjpc/threadpool.h"
+
+namespace mjpc {
+
+namespace {
+
+// 数据文件头（64 字节）
+struct StoreHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint8_t reserved[48];
+};
+static_assert(sizeof(StoreHeader) == 64, "StoreHeader must stay 64 bytes");
+
+// 索引文件头
+struct IndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t covered;  // 建索引时的记录数
+};
+
+constexpr char kStoreMagic[8] = {'M', 'J', 'E', 'P', 'S', 'T', 'O', 'R'};
+constexpr char kIndexMagic[8] = {'M', 'J', 'E', 'P', 'I', 'D', 'X', '1'};
+constexpr uint32_t kStoreVersion = 1;
+
+bool WriteAll(int fd, const void* buffer, size_t size) {
+  const char* p = static_cast<const char*>(buffer);
+  while (size > 0) {
+    ssize_t n = write(fd, p, size);
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool ReadAll(int fd, void* buffer, size_t size) {
+  char* p = static_cast<char*>(buffer);
+  while (size > 0) {
+    ssize_t n = read(fd, p, size);
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+}  // namespace
+
+double EpisodePercentile(std::vector<double>* values, double q) {
+  if (values->empty()) return 0.0;
+  double position = q * (values->size() - 1);
+  size_t k = static_cast<size_t>(position);
+  std::nth_element(values->begin(), values->begin() + k, values->end());
+  double lower = (*values)[k];
+  if (k + 1 >= values->size()) return lower;
+  // nth_element 之后 k 之后的元素都不小于 lower，其中最小值即下一个顺序统计量
+  double upper = *std::min_element(values->begin() + k + 1, values->end());
+  return lower + (position - k) * (upper - lower);
+}
+
+uint64_t HashEpisodeParameters(const double* parameters, int n) {
+  uint64_t hash = 1469598103934665603ull;
+  for (int i = 0; i < n; i++) {
+    uint64_t bits;
+    std::memcpy(&bits, parameters + i, sizeof(bits));
+    for (int b = 0; b < 8; b++) {
+      hash ^= (bits >> (8 * b)) & 0xff;
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+bool ParseEpisodeField(const std::string& name, EpisodeField* field) {
+  static const struct {
+    const char* name;
+    EpisodeField field;
+  } kFields[] = {
+      {"ttg_mean", EpisodeField::kTimeToGoalMean},
+      {"ttg_min", EpisodeField::kTimeToGoalMin},
+      {"ttg_max", EpisodeField::kTimeToGoalMax},
+      {"ttg_p95", EpisodeField::kTimeToGoalP95},
+      {"goals", EpisodeField::kNumGoals},
+      {"rtf", EpisodeField::kRtf},
+  };
+  for (const auto& f : kFields) {
+    if (name == f.name) {
+      *field = f.field;
+      return true;
+    }
+  }
+  return false;
+}
+
+double EpisodeFieldValue(const EpisodeRecord& record, EpisodeField field) {
+  switch (field) {
+    case EpisodeField::kTimeToGoalMean: return record.time_to_goal_mean;
+    case EpisodeField::kTimeToGoalMin: return record.time_to_goal_min;
+    case EpisodeField::kTimeToGoalMax: return record.time_to_goal_max;
+    case EpisodeField::kTimeToGoalP95: return record.time_to_goal_p95;
+    case EpisodeField::kNumGoals: return record.num_goals;
+    case EpisodeField::kRtf: return record.rtf;
+  }
+  return 0.0;
+}
+
+// ============ EpisodeStoreWriter ============
+EpisodeStoreWriter::~EpisodeStoreWriter() { Close(); }
+
+bool EpisodeStoreWriter::Open(const std::string& path) {
+  Close();
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  if (st.st_size == 0) {
+    // 新文件：写文件头
+    StoreHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kStoreMagic, sizeof(kStoreMagic));
+    header.version = kStoreVersion;
+    header.record_size = sizeof(EpisodeRecord);
+    if (!WriteAll(fd, &header, sizeof(header))) {
+      close(fd);
+      return false;
+    }
+  } else {
+    // 已有文件：校验文件头和长度
+    StoreHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        std::memcmp(header.magic, kStoreMagic, sizeof(kStoreMagic)) != 0 ||
+        header.version != kStoreVersion ||
+        header.record_size != sizeof(EpisodeRecord) ||
+        (st.st_size - sizeof(header)) % sizeof(EpisodeRecord) != 0) {
+      std::fprintf(stderr, "EpisodeStore: bad or truncated store '%s'\n",
+                   path.c_str());
+      close(fd);
+      return false;
+    }
+  }
+
+  fd_ = fd;
+  return true;
+}
+
+bool EpisodeStoreWriter::Append(const EpisodeRecord& record) {
+  if (fd_ < 0) return false;
+  // O_APPEND 保证单次 write 原子追加到文件末尾
+  return write(fd_, &record, sizeof(record)) ==
+         static_cast<ssize_t>(sizeof(record));
+}
+
+void EpisodeStoreWriter::Close() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+// ============ EpisodeStoreReader ============
+EpisodeStoreReader::~EpisodeStoreReader() { Close(); }
+
+bool EpisodeStoreReader::Open(const std::string& path) {
+  Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  StoreHeader header;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(header)) ||
+      !ReadAll(fd, &header, sizeof(header)) ||
+      std::memcmp(header.magic, kStoreMagic, sizeof(kStoreMagic)) != 0 ||
+      header.record_size != sizeof(EpisodeRecord)) {
+    close(fd);
+    return false;
+  }
+
+  map_size_ = st.st_size;
+  map_ = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    map_size_ = 0;
+    return false;
+  }
+  madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+  records_ = reinterpret_cast<const EpisodeRecord*>(
+      static_cast<const char*>(map_) + sizeof(StoreHeader));
+  // 忽略正在写入的不完整尾记录
+  num_records_ = (map_size_ - sizeof(StoreHeader)) / sizeof(EpisodeRecord);
+  return true;
+}
+
+void EpisodeStoreReader::Close() {
+  if (map_) munmap(map_, map_size_);
+  map_ = nullptr;
+  map_size_ = 0;
+  records_ = nullptr;
+  num_records_ = 0;
+}
+
+// ============ EpisodeIndex ============
+std::string EpisodeIndex::IndexPath(const std::string& store_path) {
+  return store_path + ".idx";
+}
+
+bool EpisodeIndex::Build(const EpisodeStoreReader& store,
+                         const std::string& index_path) {
+  size_t n = store.size();
+  std::vector<Entry> by_seed(n);
+  std::vector<Entry> by_hash(n);
+  for (size_t i = 0; i < n; i++) {
+    by_seed[i] = {store.record(i).seed, i};
+    by_hash[i] = {store.record(i).param_hash, i};
+  }
+  auto less = [](const Entry& a, const Entry& b) {
+    return a.key < b.key || (a.key == b.key && a.record < b.record);
+  };
+  std::sort(by_seed.begin(), by_seed.end(), less);
+  std::sort(by_hash.begin(), by_hash.end(), less);
+
+  // 先写临时文件再 rename，读者不会看到半个索引
+  std::string tmp_path = index_path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return false;
+
+  IndexHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+  header.version = kStoreVersion;
+  header.covered = n;
+  bool ok = WriteAll(fd, &header, sizeof(header)) &&
+            WriteAll(fd, by_seed.data(), n * sizeof(Entry)) &&
+            WriteAll(fd, by_hash.data(), n * sizeof(Entry));
+  close(fd);
+  if (!ok || rename(tmp_path.c_str(), index_path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool EpisodeIndex::Load(const std::string& index_path) {
+  int fd = open(index_path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  IndexHeader header;
+  struct stat info;
+  bool ok = fstat(fd, &info) == 0 && ReadAll(fd, &header, sizeof(header)) &&
+            std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+            header.version == kStoreVersion;
+  // covered 必须与文件长度一致，损坏或截断的索引不使用
+  ok = ok && static_cast<uint64_t>(info.st_size) >= sizeof(header) &&
+       (static_cast<uint64_t>(info.st_size) - sizeof(header)) %
+               (2 * sizeof(Entry)) == 0 &&
+       header.covered == (static_cast<uint64_t>(info.st_size) -
+                          sizeof(header)) / (2 * sizeof(Entry));
+  if (ok) {
+    covered_ = header.covered;
+    by_seed_.resize(covered_);
+    by_param_hash_.resize(covered_);
+    ok = ReadAll(fd, by_seed_.data(), covered_ * sizeof(Entry)) &&
+         ReadAll(fd, by_param_hash_.data(), covered_ * sizeof(Entry));
+  }
+  close(fd);
+  for (size_t i = 0; ok && i < covered_; i++) {
+    ok = by_seed_[i].record < covered_ && by_param_hash_[i].record < covered_;
+  }
+
+  if (!ok) {
+    covered_ = 0;
+    by_seed_.clear();
+    by_param_hash_.clear();
+  }
+  return ok;
+}
+
+void EpisodeIndex::Lookup(const std::vector<Entry>& table, uint64_t key,
+                          std::vector<uint64_t>* out) {
+  auto it = std::lower_bound(
+      table.begin(), table.end(), key,
+      [](const Entry& e, uint64_t k) { return e.key < k; });
+  for (; it != table.end() && it->key == key; ++it) {
+    out->push_back(it->record);
+  }
+}
+
+void EpisodeIndex::LookupSeed(uint64_t seed, std::vector<uint64_t>* out) const {
+  Lookup(by_seed_, seed, out);
+}
+
+void EpisodeIndex::LookupParamHash(uint64_t hash,
+                                   std::vector<uint64_t>* out) const {
+  Lookup(by_param_hash_, hash, out);
+}
+
+// ============ 查询 ============
+bool EpisodeFilter::Match(const EpisodeRecord& record) const {
+  if (has_seed && record.seed != seed) return false;
+  if (has_param_hash && record.param_hash != param_hash) return false;
+  if (min_rtf >= 0.0 && record.rtf < min_rtf) return false;
+  return true;
+}
+
+EpisodeAggregate QueryEpisodes(const EpisodeStoreReader& store,
+                               const EpisodeIndex* index,
+                               const EpisodeFilter& filter,
+                               EpisodeField field, int num_threads) {
+  size_t n = store.size();
+
+  // 索引覆盖范围内的候选记录
+  size_t covered = 0;
+  std::vector<uint64_t> candidates;
+  bool use_index = index && index->covered() <= n &&
+                   (filter.has_seed || filter.has_param_hash);
+  if (use_index) {
+    covered = index->covered();
+    if (filter.has_seed) {
+      index->LookupSeed(filter.seed, &candidates);
+    } else {
+      index->LookupParamHash(filter.param_hash, &candidates);
+    }
+  }
+
+  // 任务列表：候选记录 + 未被索引覆盖的尾部
+  num_threads = std::max(1, num_threads);
+  size_t tail = n - covered;
+  std::vector<std::vector<double>> values(num_threads);
+
+  ThreadPool pool(num_threads);
+  int count_before = pool.GetCount();
+  for (int t = 0; t < num_threads; t++) {
+    pool.Schedule([&, t]() {
+      std::vector<double>& out = values[t];
+
+      size_t begin = candidates.size() * t / num_threads;
+      size_t end = candidates.size() * (t + 1) / num_threads;
+      for (size_t i = begin; i < end; i++) {
+        const EpisodeRecord& record = store.record(candidates[i]);
+        if (filter.Match(record)) {
+          out.push_back(EpisodeFieldValue(record, field));
+        }
+      }
+
+      begin = covered + tail * t / num_threads;
+      end = covered + tail * (t + 1) / num_threads;
+      for (size_t i = begin; i < end; i++) {
+        const EpisodeRecord& record = store.record(i);
+        if (filter.Match(record)) {
+          out.push_back(EpisodeFieldValue(record, field));
+        }
+      }
+    });
+  }
+  pool.WaitCount(count_before + num_threads);
+  pool.ResetCount();
+
+  // 合并各线程结果
+  std::vector<double> all;
+  for (const auto& v : values) all.insert(all.end(), v.begin(), v.end());
+
+  EpisodeAggregate aggregate;
+  aggregate.count = all.size();
+  if (all.empty()) return aggregate;
+
+  double sum = 0.0;
+  aggregate.min = all[0];
+  aggregate.max = all[0];
+  for (double v : all) {
+    sum += v;
+    aggregate.min = std::min(aggregate.min, v);
+    aggregate.max = std::max(aggregate.max, v);
+  }
+  aggregate.mean = sum / all.size();
+  aggregate.p50 = EpisodePercentile(&all, 0.5);
+  aggregate.p95 = EpisodePercentile(&all, 0.95);
+  return aggregate;
+}
+
+}  // namespace mjpc
@@ -0,0 +1,174 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_EPISODE_STORE_H_
+#define MJPC_TASKS_SIMPLE_CAR_EPISODE_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mjpc {
+
+// 每条记录最多保存的参数个数
+inline constexpr int kEpisodeMaxParameters = 8;
+
+// 回合摘要：定长记录（256 字节），直接按二进制追加写入
+struct EpisodeRecord {
+  uint64_t seed = 0;              // 回合随机种子
+  uint64_t param_hash = 0;        // 参数哈希（见 HashEpisodeParameters）
+  int64_t wall_time_ns = 0;       // 写入时刻（Unix 纳秒）
+  int32_t num_parameters = 0;
+  int32_t num_goals = 0;          // 到达目标次数
+  double parameters[kEpisodeMaxParameters] = {0};
+
+  // 到达目标耗时统计（仿真秒）
+  double time_to_goal_mean = 0.0;
+  double time_to_goal_min = 0.0;
+  double time_to_goal_max = 0.0;
+  double time_to_goal_p95 = 0.0;
+
+  // 仿真时长与实时率
+  double sim_time = 0.0;
+  double rtf = 0.0;
+
+  uint8_t reserved[256 - 144] = {0};
+};
+static_assert(sizeof(EpisodeRecord) == 256, "EpisodeRecord must stay 256 bytes");
+static_assert(std::is_trivially_copyable<EpisodeRecord>::value,
+              "EpisodeRecord is written as raw bytes");
+
+// 线性插值分位数（values 会被重排，为空时返回 0）
+double EpisodePercentile(std::vector<double>* values, double q);
+
+// 参数哈希（FNV-1a，按位比较 double）
+uint64_t HashEpisodeParameters(const double* parameters, int n);
+
+// 可聚合的记录字段
+enum class EpisodeField : int {
+  kTimeToGoalMean = 0,
+  kTimeToGoalMin,
+  kTimeToGoalMax,
+  kTimeToGoalP95,
+  kNumGoals,
+  kRtf,
+};
+bool ParseEpisodeField(const std::string& name, EpisodeField* field);
+double EpisodeFieldValue(const EpisodeRecord& record, EpisodeField field);
+
+// ============ 追加写入 ============
+// 数据文件：64 字节文件头 + 若干 EpisodeRecord，只追加不修改
+class EpisodeStoreWriter {
+ public:
+  EpisodeStoreWriter() = default;
+  ~EpisodeStoreWriter();
+  EpisodeStoreWriter(const EpisodeStoreWriter&) = delete;
+  EpisodeStoreWriter& operator=(const EpisodeStoreWriter&) = delete;
+
+  // 打开（不存在则创建）数据文件，文件头不匹配时返回 false
+  bool Open(const std::string& path);
+  bool Append(const EpisodeRecord& record);
+  void Close();
+  bool IsOpen() const { return fd_ >= 0; }
+
+ private:
+  int fd_ = -1;
+};
+
+// ============ 只读映射 ============
+class EpisodeStoreReader {
+ public:
+  EpisodeStoreReader() = default;
+  ~EpisodeStoreReader();
+  EpisodeStoreReader(const EpisodeStoreReader&) = delete;
+  EpisodeStoreReader& operator=(const EpisodeStoreReader&) = delete;
+
+  bool Open(const std::string& path);
+  void Close();
+
+  size_t size() const { return num_records_; }
+  const EpisodeRecord& record(size_t i) const { return records_[i]; }
+  const EpisodeRecord* records() const { return records_; }
+
+ private:
+  void* map_ = nullptr;
+  size_t map_size_ = 0;
+  const EpisodeRecord* records_ = nullptr;
+  size_t num_records_ = 0;
+};
+
+// ============ 旁路索引 ============
+// <store>.idx：按 seed 和 param_hash 分别排序的 (key, 记录号) 表；
+// 只覆盖建索引时已有的记录，之后追加的尾部记录查询时顺序扫描
+class EpisodeIndex {
+ public:
+  struct Entry {
+    uint64_t key;
+    uint64_t record;
+  };
+
+  static std::string IndexPath(const std::string& store_path);
+
+  // 由已映射的数据构建并写盘
+  static bool Build(const EpisodeStoreReader& store,
+                    const std::string& index_path);
+
+  bool Load(const std::string& index_path);
+
+  size_t covered() const { return covered_; }
+
+  // 追加等于 key 的记录号（升序）
+  void LookupSeed(uint64_t seed, std::vector<uint64_t>* out) const;
+  void LookupParamHash(uint64_t hash, std::vector<uint64_t>* out) const;
+
+ private:
+  static void Lookup(const std::vector<Entry>& table, uint64_t key,
+                     std::vector<uint64_t>* out);
+
+  size_t covered_ = 0;
+  std::vector<Entry> by_seed_;
+  std::vector<Entry> by_param_hash_;
+};
+
+// ============ 查询 ============
+struct EpisodeFilter {
+  bool has_seed = false;
+  uint64_t seed = 0;
+  bool has_param_hash = false;
+  uint64_t param_hash = 0;
+  double min_rtf = -1.0;  // <0 表示不过滤
+
+  bool Match(const EpisodeRecord& record) const;
+};
+
+struct EpisodeAggregate {
+  size_t count = 0;
+  double mean = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  double p50 = 0.0;
+  double p95 = 0.0;
+};
+
+// 并行扫描：有索引时只访问候选记录，其余部分按线程分块扫描
+EpisodeAggregate QueryEpisodes(const EpisodeStoreReader& store,
+                               const EpisodeIndex* index,
+                               const EpisodeFilter& filter,
+                               EpisodeField field, int num_threads);
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_EPISODE_STORE_H_
@@ -0,0 +1,138 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/episode_store.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace mjpc {
+namespace {
+
+class EpisodeStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "episode_store_test.bin";
+    unlink(path_.c_str());
+    unlink(EpisodeIndex::IndexPath(path_).c_str());
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+    unlink(EpisodeIndex::IndexPath(path_).c_str());
+  }
+
+  // 写入 n 条记录：seed = i % 10，time_to_goal_mean = i
+  void Write(int n) {
+    EpisodeStoreWriter writer;
+    ASSERT_TRUE(writer.Open(path_));
+    for (int i = 0; i < n; i++) {
+      EpisodeRecord record;
+      record.seed = i % 10;
+      double parameters[1] = {static_cast<double>(i % 3)};
+      record.num_parameters = 1;
+      record.parameters[0] = parameters[0];
+      record.param_hash = HashEpisodeParameters(parameters, 1);
+      record.time_to_goal_mean = i;
+      record.rtf = 1.0;
+      ASSERT_TRUE(writer.Append(record));
+    }
+    writer.Close();
+  }
+
+  std::string path_;
+};
+
+TEST_F(EpisodeStoreTest, IndexRoundTrip) {
+  Write(100);
+  EpisodeStoreReader store;
+  ASSERT_TRUE(store.Open(path_));
+  ASSERT_EQ(store.size(), 100);
+
+  std::string index_path = EpisodeIndex::IndexPath(path_);
+  ASSERT_TRUE(EpisodeIndex::Build(store, index_path));
+  EpisodeIndex index;
+  ASSERT_TRUE(index.Load(index_path));
+  EXPECT_EQ(index.covered(), 100);
+
+  std::vector<uint64_t> records;
+  index.LookupSeed(7, &records);
+  ASSERT_EQ(records.size(), 10);
+  for (int i = 0; i < 10; i++) EXPECT_EQ(records[i], 7 + 10 * i);
+
+  records.clear();
+  double parameters[1] = {2.0};
+  index.LookupParamHash(HashEpisodeParameters(parameters, 1), &records);
+  ASSERT_EQ(records.size(), 33);
+  for (uint64_t record : records) EXPECT_EQ(record % 3, 2);
+
+  records.clear();
+  index.LookupSeed(12345, &records);
+  EXPECT_TRUE(records.empty());
+}
+
+TEST_F(EpisodeStoreTest, RejectsTruncatedIndex) {
+  Write(20);
+  EpisodeStoreReader store;
+  ASSERT_TRUE(store.Open(path_));
+  std::string index_path = EpisodeIndex::IndexPath(path_);
+  ASSERT_TRUE(EpisodeIndex::Build(store, index_path));
+
+  // 去掉最后一个表项：文件长度与 covered 不再一致
+  FILE* file = std::fopen(index_path.c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fseek(file, 0, SEEK_END);
+  long size = std::ftell(file);
+  std::fclose(file);
+  ASSERT_EQ(truncate(index_path.c_str(), size - sizeof(EpisodeIndex::Entry)),
+            0);
+
+  EpisodeIndex index;
+  EXPECT_FALSE(index.Load(index_path));
+}
+
+TEST_F(EpisodeStoreTest, PercentilesInterpolate) {
+  // time_to_goal_mean = 0..99：p50 = 49.5，p95 = 94.05
+  Write(100);
+  EpisodeStoreReader store;
+  ASSERT_TRUE(store.Open(path_));
+  EpisodeFilter filter;
+  EpisodeAggregate aggregate = QueryEpisodes(
+      store, nullptr, filter, EpisodeField::kTimeToGoalMean, 4);
+  EXPECT_EQ(aggregate.count, 100);
+  EXPECT_DOUBLE_EQ(aggregate.min, 0.0);
+  EXPECT_DOUBLE_EQ(aggregate.max, 99.0);
+  EXPECT_DOUBLE_EQ(aggregate.mean, 49.5);
+  EXPECT_DOUBLE_EQ(aggregate.p50, 49.5);
+  EXPECT_NEAR(aggregate.p95, 94.05, 1e-9);
+}
+
+TEST(EpisodePercentileTest, MatchesRecordedP95) {
+  // FlushEpisode 与查询使用同一插值：(n - 1) × 0.95 = 2.85
+  std::vector<double> times = {4.0, 1.0, 3.0, 2.0};
+  EXPECT_NEAR(EpisodePercentile(&times, 0.95), 3.85, 1e-12);
+  std::vector<double> one = {7.0};
+  EXPECT_DOUBLE_EQ(EpisodePercentile(&one, 0.95), 7.0);
+  std::vector<double> empty;
+  EXPECT_DOUBLE_EQ(EpisodePercentile(&empty, 0.95), 0.0);
+}
+
+}  // namespace
+}  // namespace mjpc
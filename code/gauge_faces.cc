@@ -0,0 +1,298 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/gauge_faces.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 颜色与 DrawSpeedometer2D / DrawTachometer2D 原来逐帧绘制的 geom 一致
+const GaugeFaceSpec kGaugeFaceSpecs[kNumGaugeFaces] = {
+    {"gauge_speedometer",
+     {{0.4f, 0.7f, 1.0f, 0.6f}, {0.7f, 0.7f, 0.75f, 0.7f},
+      {0.3f, 0.3f, 0.4f, 0.8f}},
+     12, {0.1f, 0.1f, 0.2f, 0.8f},
+     4, {0.0f, 0.5f, 1.0f, 0.9f},
+     6, 10, {0.1f, 0.1f, 0.9f, 1.0f},
+     "KM/H", {0.0f, 0.3f, 0.8f, 1.0f},
+     {0.0f, 0.0f, 0.0f, 0.0f}},
+    {"gauge_tachometer",
+     {{1.0f, 0.6f, 0.3f, 0.6f}, {0.75f, 0.75f, 0.7f, 0.7f},
+      {0.4f, 0.3f, 0.2f, 0.8f}},
+     12, {0.1f, 0.1f, 0.2f, 0.8f},
+     0, {0.0f, 0.0f, 0.0f, 0.0f},
+     5, 2, {0.1f, 0.1f, 0.1f, 0.9f},
+     "RPM", {0.0f, 0.3f, 0.8f, 1.0f},
+     {1.0f, 0.3f, 0.3f, 0.6f}},
+};
+
+namespace {
+
+constexpr float kExtent = 1.05f;  // 图像覆盖 [-kExtent, kExtent]^2
+constexpr float kTwoPi = 6.28318530717958647692f;
+
+// 5x7 点阵字体（只含表盘用到的字符）
+struct Glyph {
+  char c;
+  const char* rows[7];
+};
+
+constexpr Glyph kFont[] = {
+    {'0', {".###.", "#...#", "#..##", "#.#.#", "##..#", "#...#", ".###."}},
+    {'1', {"..#..", ".##..", "..#..", "..#..", "..#..", "..#..", ".###."}},
+    {'2', {".###.", "#...#", "....#", "...#.", "..#..", ".#...", "#####"}},
+    {'3', {"####.", "....#", "....#", ".###.", "....#", "....#", "####."}},
+    {'4', {"...#.", "..##.", ".#.#.", "#..#.", "#####", "...#.", "...#."}},
+    {'5', {"#####", "#....", "####.", "....#", "....#", "#...#", ".###."}},
+    {'6', {"..##.", ".#...", "#....", "####.", "#...#", "#...#", ".###."}},
+    {'7', {"#####", "....#", "...#.", "..#..", ".#...", ".#...", ".#..."}},
+    {'8', {".###.", "#...#", "#...#", ".###.", "#...#", "#...#", ".###."}},
+    {'9', {".###.", "#...#", "#...#", ".####", "....#", "...#.", ".##.."}},
+    {'K', {"#...#", "#..#.", "#.#..", "##...", "#.#..", "#..#.", "#...#"}},
+    {'M', {"#...#", "##.##", "#.#.#", "#.#.#", "#...#", "#...#", "#...#"}},
+    {'H', {"#...#", "#...#", "#...#", "#####", "#...#", "#...#", "#...#"}},
+    {'R', {"####.", "#...#", "#...#", "####.", "#.#..", "#..#.", "#...#"}},
+    {'P', {"####.", "#...#", "#...#", "####.", "#....", "#....", "#...."}},
+    {'/', {"....#", "....#", "...#.", "..#..", ".#...", "#....", "#...."}},
+};
+
+const Glyph* FindGlyph(char c) {
+  for (const Glyph& glyph : kFont) {
+    if (glyph.c == c) return &glyph;
+  }
+  return nullptr;
+}
+
+// 有符号距离场图元：d < 0 在内部
+struct Layer {
+  enum Kind { kDisc, kSegment, kSector, kBox } kind;
+  float p[6];
+  float rgba[4];
+};
+
+float Length(float x, float y) { return std::sqrt(x * x + y * y); }
+
+float Distance(const Layer& layer, float x, float y) {
+  const float* p = layer.p;
+  switch (layer.kind) {
+    case Layer::kDisc:  // 圆心、半径
+      return Length(x - p[0], y - p[1]) - p[2];
+    case Layer::kSegment: {  // 两端点、半宽
+      float dx = p[2] - p[0], dy = p[3] - p[1];
+      float t = ((x - p[0]) * dx + (y - p[1]) * dy) / (dx * dx + dy * dy);
+      t = std::clamp(t, 0.0f, 1.0f);
+      return Length(x - p[0] - t * dx, y - p[1] - t * dy) - p[4];
+    }
+    case Layer::kSector: {  // 内外半径、起始角、角度跨度（以原点为圆心）
+      float r = Length(x, y);
+      float radial = std::max(p[0] - r, r - p[1]);
+      float relative = std::fmod(std::atan2(y, x) - p[2], kTwoPi);
+      if (relative < 0.0f) relative += kTwoPi;
+      float angular = relative <= p[3]
+                          ? -std::min(relative, p[3] - relative) * r
+                          : std::min(relative - p[3], kTwoPi - relative) * r;
+      return std::max(radial, angular);
+    }
+    case Layer::kBox: {  // 中心、半宽、半高
+      float qx = std::abs(x - p[0]) - p[2];
+      float qy = std::abs(y - p[1]) - p[3];
+      return Length(std::max(qx, 0.0f), std::max(qy, 0.0f)) +
+             std::min(std::max(qx, qy), 0.0f);
+    }
+  }
+  return 1.0f;
+}
+
+void AddText(std::vector<Layer>* layers, const char* text, float x, float y,
+             float height, const float rgba[4]) {
+  float cell = height / 7.0f;
+  int count = std::strlen(text);
+  float width = (6 * count - 1) * cell;
+  float left = x - 0.5f * width;
+  float top = y + 0.5f * height;
+  for (int i = 0; i < count; i++) {
+    const Glyph* glyph = FindGlyph(text[i]);
+    if (!glyph) continue;
+    for (int row = 0; row < 7; row++) {
+      for (int col = 0; col < 5; col++) {
+        if (glyph->rows[row][col] != '#') continue;
+        Layer layer = {Layer::kBox,
+                       {left + (6 * i + col + 0.5f) * cell,
+                        top - (row + 0.5f) * cell, 0.5f * cell, 0.5f * cell},
+                       {}};
+        std::copy_n(rgba, 4, layer.rgba);
+        layers->push_back(layer);
+      }
+    }
+  }
+}
+
+std::vector<Layer> FaceLayers(const GaugeFaceSpec& spec, double warning) {
+  std::vector<Layer> layers;
+  auto add = [&layers](Layer::Kind kind, std::initializer_list<float> p,
+                       const float rgba[4]) {
+    Layer layer = {kind, {}, {}};
+    std::copy(p.begin(), p.end(), layer.p);
+    std::copy_n(rgba, 4, layer.rgba);
+    layers.push_back(layer);
+  };
+
+  const float radius[3] = {1.05f, 1.0f, 0.95f};
+  for (int i = 0; i < 3; i++) {
+    add(Layer::kDisc, {0.0f, 0.0f, radius[i]}, spec.bezel[i]);
+  }
+
+  // 红区：指针角度 = 比例 * 2π - π/2
+  if (warning < 1.0 && spec.warning_rgba[3] > 0.0f) {
+    float start = static_cast<float>(warning) * kTwoPi - 0.25f * kTwoPi;
+    float span = static_cast<float>(1.0 - std::max(0.0, warning)) * kTwoPi;
+    add(Layer::kSector, {0.72f, 0.92f, start, span}, spec.warning_rgba);
+  }
+
+  // 刻度（线宽按原来的世界宽度 / 表盘尺寸 0.8 换算）
+  for (int i = 0; i < spec.minor_ticks; i++) {
+    float angle = i * kTwoPi / spec.minor_ticks;
+    float c = std::cos(angle), s = std::sin(angle);
+    add(Layer::kSegment, {0.8f * c, 0.8f * s, 0.9f * c, 0.9f * s, 0.0125f},
+        spec.minor_rgba);
+  }
+  for (int i = 0; i < spec.major_ticks; i++) {
+    float angle = i * kTwoPi / spec.major_ticks;
+    float c = std::cos(angle), s = std::sin(angle);
+    add(Layer::kSegment, {0.75f * c, 0.75f * s, 0.9f * c, 0.9f * s, 0.019f},
+        spec.major_rgba);
+  }
+
+  // 数字与单位
+  for (int i = 0; i < spec.num_labels; i++) {
+    float angle = i * kTwoPi / spec.num_labels - 0.25f * kTwoPi;
+    char label[8];
+    std::snprintf(label, sizeof(label), "%d", i * spec.label_step);
+    AddText(&layers, label, 0.7f * std::cos(angle), 0.7f * std::sin(angle),
+            0.13f, spec.label_rgba);
+  }
+  AddText(&layers, spec.unit, 0.0f, -0.25f, 0.1f, spec.unit_rgba);
+  return layers;
+}
+
+}  // namespace
+
+void RasterizeGaugeFace(const GaugeFaceSpec& spec, double warning, int width,
+                        int height, int channels, uint8_t* image) {
+  std::vector<Layer> layers = FaceLayers(spec, warning);
+  float pixel = 2.0f * kExtent / std::min(width, height);
+
+  for (int row = 0; row < height; row++) {
+    float y = kExtent - (row + 0.5f) * 2.0f * kExtent / height;
+    for (int col = 0; col < width; col++) {
+      float x = (col + 0.5f) * 2.0f * kExtent / width - kExtent;
+
+      // 预乘 alpha 逐层叠加，覆盖率由距离场按一个像素宽度抗锯齿
+      float color[3] = {0.0f, 0.0f, 0.0f};
+      float alpha = 0.0f;
+      for (const Layer& layer : layers) {
+        float coverage =
+            std::clamp(0.5f - Distance(layer, x, y) / pixel, 0.0f, 1.0f);
+        if (coverage <= 0.0f) continue;
+        float a = layer.rgba[3] * coverage;
+        for (int k = 0; k < 3; k++) {
+          color[k] = layer.rgba[k] * a + color[k] * (1.0f - a);
+        }
+        alpha = a + alpha * (1.0f - a);
+      }
+
+      uint8_t* out = image + channels * (row * width + col);
+      for (int k = 0; k < 3; k++) {
+        float value = alpha > 0.0f ? color[k] / alpha : 0.0f;
+        out[k] = static_cast<uint8_t>(std::lround(255.0f * value));
+      }
+      if (channels == 4) {
+        out[3] = static_cast<uint8_t>(std::lround(255.0f * alpha));
+      }
+    }
+  }
+}
+
+bool GaugeFaceAssets::Initialize(const mjModel* model) {
+  version = 0;  // 新模型的贴图尚未烘焙
+  for (int i = 0; i < kNumGaugeFaces; i++) {
+    texture[i] = mj_name2id(model, mjOBJ_TEXTURE, kGaugeFaceSpecs[i].name);
+    material[i] = mj_name2id(model, mjOBJ_MATERIAL, kGaugeFaceSpecs[i].name);
+  }
+  mesh = mj_name2id(model, mjOBJ_MESH, "gauge_face");
+  for (int i = 0; i < kNumGaugeFaces; i++) {
+    if (texture[i] < 0 || material[i] < 0) mesh = -1;
+  }
+  return valid();
+}
+
+bool BakeGaugeFaces(mjModel* model, double tachometer_warning,
+                    GaugeFaceAssets* assets) {
+  if (!assets->valid()) return false;
+  for (int i = 0; i < kNumGaugeFaces; i++) {
+    int id = assets->texture[i];
+    int channels = model->tex_nchannel[id];
+    if (channels != 3 && channels != 4) return false;
+    double warning = i == kGaugeTachometer ? tachometer_warning : 1.0;
+    RasterizeGaugeFace(kGaugeFaceSpecs[i], warning, model->tex_width[id],
+                       model->tex_height[id], channels,
+                       model->tex_data + model->tex_adr[id]);
+  }
+  assets->version++;
+  return true;
+}
+
+void UploadGaugeFaces(const mjModel* model, const mjrContext* context,
+                      const GaugeFaceAssets& assets) {
+  if (!assets.valid()) return;
+  for (int i = 0; i < kNumGaugeFaces; i++) {
+    mjr_uploadTexture(model, context, assets.texture[i]);
+  }
+}
+
+void MakeGaugeFaceGeom(const mjModel* model, const GaugeFaceAssets& assets,
+                       int face, mjvGeom* geom) {
+  mjv_initGeom(geom, mjGEOM_MESH, nullptr, nullptr, nullptr, nullptr);
+
+  // 编译时网格被平移/旋转到惯性坐标系，这里按 mesh_pos / mesh_quat 还原
+  int mesh = assets.mesh;
+  mjtNum mat[9];
+  mju_quat2Mat(mat, model->mesh_quat + 4 * mesh);
+  const mjtNum* offset = model->mesh_pos + 3 * mesh;
+  for (int i = 0; i < 3; i++) geom->pos[i] = offset[i];
+  for (int i = 0; i < 9; i++) geom->mat[i] = mat[i];
+  geom->size[0] = geom->size[1] = geom->size[2] = 1.0f;
+
+  geom->dataid = 2 * mesh;  // 原始网格（2 * id + 1 为凸包）
+  geom->texcoord = 1;
+  int material = assets.material[face];
+  geom->matid = material;
+  std::copy_n(model->mat_rgba + 4 * material, 4, geom->rgba);
+  geom->emission = model->mat_emission[material];
+  geom->specular = model->mat_specular[material];
+  geom->shininess = model->mat_shininess[material];
+  geom->category = mjCAT_DECOR;
+}
+
+}  // namespace mjpc
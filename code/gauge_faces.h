@@ -0,0 +1,81 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_GAUGE_FACES_H_
+#define MJPC_TASKS_SIMPLE_CAR_GAUGE_FACES_H_
+
+#include <cstdint>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 圆形表盘
+enum GaugeFace : int {
+  kGaugeSpeedometer = 0,
+  kGaugeTachometer,
+  kNumGaugeFaces,
+};
+
+// 表盘内容（长度以表盘尺寸为单位，角度为弧度、逆时针、0 指向 +x）
+struct GaugeFaceSpec {
+  const char* name;       // 贴图与材质名称
+  float bezel[3][4];      // 外圈 1.05、底色 1.0、内圈 0.95 的颜色（按此顺序叠加）
+  int minor_ticks;        // 0.8-0.9 的细刻度，从 0 角开始均分
+  float minor_rgba[4];
+  int major_ticks;        // 0.75-0.9 的粗刻度
+  float major_rgba[4];
+  int num_labels;         // 半径 0.7 处的数字，从底部（-90°）开始均分
+  int label_step;
+  float label_rgba[4];
+  const char* unit;       // 中心下方的单位
+  float unit_rgba[4];
+  float warning_rgba[4];  // 红区（量程比例 warning..1 对应的扇环），alpha 为 0 时不画
+};
+
+extern const GaugeFaceSpec kGaugeFaceSpecs[kNumGaugeFaces];
+
+// 把表盘画到 RGB / RGBA 图像中（第 0 行为上方），图像覆盖 [-1.05, 1.05]^2；
+//   warning 为红区起点的量程比例（>= 1 时不画）
+void RasterizeGaugeFace(const GaugeFaceSpec& spec, double warning, int width,
+                        int height, int channels, uint8_t* image);
+
+// 模型中的表盘资源（gauge_assets.xml）：每个表盘一张贴图和材质，共用一个圆片网格
+struct GaugeFaceAssets {
+  int texture[kNumGaugeFaces] = {-1, -1};
+  int material[kNumGaugeFaces] = {-1, -1};
+  int mesh = -1;
+  int version = 0;  // 每次烘焙后递增，查看器据此重新上传贴图
+
+  // 按名称查找，全部找到时返回 true
+  bool Initialize(const mjModel* model);
+  bool valid() const { return mesh >= 0; }
+};
+
+// 生成表盘图像写入模型贴图数据；tachometer_warning 为转速表红区起点的量程比例
+bool BakeGaugeFaces(mjModel* model, double tachometer_warning,
+                    GaugeFaceAssets* assets);
+
+// 把烘焙后的贴图上传到渲染上下文（GL 上下文创建之后烘焙时需要）
+void UploadGaugeFaces(const mjModel* model, const mjrContext* context,
+                      const GaugeFaceAssets& assets);
+
+// 生成以原点为中心的表盘圆片 geom，绘制时复制并平移到表盘位置
+//   （网格按表盘尺寸 0.8 生成，见 gauge_assets.xml 中的 scale）
+void MakeGaugeFaceGeom(const mjModel* model, const GaugeFaceAssets& assets,
+                       int face, mjvGeom* geom);
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_GAUGE_FACES_H_
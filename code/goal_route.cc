@@ -0,0 +1,254 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/goal_route.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace mjpc {
+
+namespace {
+
+// 局部改进的最大轮数
+constexpr int kMaxImprovePasses = 50;
+
+// 认为有改进的最小代价下降
+constexpr double kImproveTolerance = 1e-9;
+
+// 两个方向之间的转角（弧度，0..pi），任一方向为零向量时为 0
+double TurnAngle(double ax, double ay, double bx, double by) {
+  if ((ax == 0.0 && ay == 0.0) || (bx == 0.0 && by == 0.0)) return 0.0;
+  return std::abs(std::atan2(ax * by - ay * bx, ax * bx + ay * by));
+}
+
+}  // namespace
+
+// 路径上的位置 k：0 为起点，k>=1 为第 k 个目标。
+// point(k, xy) 取位置 k 的坐标；以下函数计算位置 k 处的边/转角代价。
+template <typename PointFn>
+double EdgeCostAt(const PointFn& point, int k) {
+  double a[2], b[2];
+  point(k - 1, a);
+  point(k, b);
+  return std::hypot(b[0] - a[0], b[1] - a[1]);
+}
+
+template <typename PointFn>
+double TurnCostAt(const PointFn& point, int k, int n, double heading) {
+  if (k < 0 || k >= n) return 0.0;
+  double p[2], q[2];
+  point(k, p);
+  point(k + 1, q);
+  double in[2];
+  if (k == 0) {
+    in[0] = std::cos(heading);
+    in[1] = std::sin(heading);
+  } else {
+    double o[2];
+    point(k - 1, o);
+    in[0] = p[0] - o[0];
+    in[1] = p[1] - o[1];
+  }
+  return TurnAngle(in[0], in[1], q[0] - p[0], q[1] - p[1]);
+}
+
+void GoalRoute::SetStart(const double pos[2], double heading) {
+  start_[0] = pos[0];
+  start_[1] = pos[1];
+  heading_ = heading;
+}
+
+void GoalRoute::Clear() {
+  xy_.clear();
+  order_.clear();
+}
+
+void GoalRoute::Goal(int i, double goal[2]) const {
+  goal[0] = xy_[2 * order_[i]];
+  goal[1] = xy_[2 * order_[i] + 1];
+}
+
+double GoalRoute::PathCost(const std::vector<int>& order) const {
+  int n = order.size();
+  auto point = [&](int k, double* out) {
+    if (k == 0) {
+      out[0] = start_[0];
+      out[1] = start_[1];
+    } else {
+      out[0] = xy_[2 * order[k - 1]];
+      out[1] = xy_[2 * order[k - 1] + 1];
+    }
+  };
+  double cost = 0.0;
+  for (int k = 1; k <= n; k++) cost += EdgeCostAt(point, k);
+  for (int k = 0; k < n; k++) {
+    cost += turn_weight_ * TurnCostAt(point, k, n, heading_);
+  }
+  return cost;
+}
+
+double GoalRoute::Cost() const { return PathCost(order_); }
+
+void GoalRoute::SetGoals(const double* xy, int num_goals) {
+  xy_.assign(xy, xy + 2 * num_goals);
+  order_.clear();
+
+  // 最近邻构造（按带转角的边代价选下一个）
+  std::vector<bool> used(num_goals, false);
+  double pos[2] = {start_[0], start_[1]};
+  double dir[2] = {std::cos(heading_), std::sin(heading_)};
+  for (int step = 0; step < num_goals; step++) {
+    int best = -1;
+    double best_cost = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < num_goals; i++) {
+      if (used[i]) continue;
+      double dx = xy_[2 * i] - pos[0];
+      double dy = xy_[2 * i + 1] - pos[1];
+      double cost = std::hypot(dx, dy) +
+                    turn_weight_ * TurnAngle(dir[0], dir[1], dx, dy);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best = i;
+      }
+    }
+    used[best] = true;
+    order_.push_back(best);
+    dir[0] = xy_[2 * best] - pos[0];
+    dir[1] = xy_[2 * best + 1] - pos[1];
+    pos[0] = xy_[2 * best];
+    pos[1] = xy_[2 * best + 1];
+  }
+
+  Improve();
+}
+
+void GoalRoute::AddGoal(double x, double y) {
+  int id = xy_.size() / 2;
+  xy_.push_back(x);
+  xy_.push_back(y);
+
+  // 最便宜插入
+  int n = order_.size();
+  int best_position = n;
+  double best_cost = std::numeric_limits<double>::infinity();
+  for (int p = 0; p <= n; p++) {
+    scratch_ = order_;
+    scratch_.insert(scratch_.begin() + p, id);
+    double cost = PathCost(scratch_);
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_position = p;
+    }
+  }
+  order_.insert(order_.begin() + best_position, id);
+
+  Improve();
+}
+
+bool GoalRoute::PopNext(double goal[2]) {
+  if (order_.empty()) return false;
+  Goal(0, goal);
+
+  // 新起点：被取出的目标，朝向为到达它时的方向
+  heading_ = std::atan2(goal[1] - start_[1], goal[0] - start_[0]);
+  start_[0] = goal[0];
+  start_[1] = goal[1];
+
+  order_.erase(order_.begin());
+  if (order_.empty()) xy_.clear();
+  return true;
+}
+
+void GoalRoute::Improve() {
+  for (int pass = 0; pass < kMaxImprovePasses; pass++) {
+    bool improved = TwoOptPass();
+    improved = OrOptPass() || improved;
+    if (!improved) break;
+  }
+}
+
+// 2-opt：反转位置 i..j。内部边长和转角大小不变，
+//   只需比较边 i、j+1 以及位置 i-1、i、j、j+1 处的转角
+bool GoalRoute::TwoOptPass() {
+  int n = order_.size();
+  bool improved = false;
+
+  for (int i = 1; i < n; i++) {
+    for (int j = i + 1; j <= n; j++) {
+      auto before = [&](int k, double* out) {
+        int g = k == 0 ? -1 : order_[k - 1];
+        out[0] = g < 0 ? start_[0] : xy_[2 * g];
+        out[1] = g < 0 ? start_[1] : xy_[2 * g + 1];
+      };
+      auto after = [&](int k, double* out) {
+        if (k >= i && k <= j) k = i + j - k;
+        before(k, out);
+      };
+      auto local = [&](const auto& point) {
+        double cost = EdgeCostAt(point, i);
+        if (j < n) cost += EdgeCostAt(point, j + 1);
+        int turns[4] = {i - 1, i, j, j + 1};
+        for (int t = 0; t < 4; t++) {
+          // 去重：i、j 相邻时 i 与 j-1 等位置会重复
+          bool duplicate = false;
+          for (int s = 0; s < t; s++) duplicate |= turns[s] == turns[t];
+          if (!duplicate) {
+            cost += turn_weight_ * TurnCostAt(point, turns[t], n, heading_);
+          }
+        }
+        return cost;
+      };
+
+      if (local(after) < local(before) - kImproveTolerance) {
+        for (int a = i - 1, b = j - 1; a < b; a++, b--) {
+          std::swap(order_[a], order_[b]);
+        }
+        improved = true;
+      }
+    }
+  }
+  return improved;
+}
+
+// Or-opt：把长度 1..3 的连续片段移到其他位置
+bool GoalRoute::OrOptPass() {
+  int n = order_.size();
+  bool improved = false;
+  double current = PathCost(order_);
+
+  for (int length = 1; length <= 3 && length < n; length++) {
+    for (int i = 0; i + length <= n; i++) {
+      for (int p = 0; p <= n - length; p++) {
+        if (p == i) continue;
+        scratch_ = order_;
+        std::vector<int> segment(scratch_.begin() + i,
+                                 scratch_.begin() + i + length);
+        scratch_.erase(scratch_.begin() + i, scratch_.begin() + i + length);
+        scratch_.insert(scratch_.begin() + p, segment.begin(), segment.end());
+
+        double cost = PathCost(scratch_);
+        if (cost < current - kImproveTolerance) {
+          order_.swap(scratch_);
+          current = cost;
+          improved = true;
+        }
+      }
+    }
+  }
+  return improved;
+}
+
+}  // namespace mjpc
@@ -0,0 +1,78 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_GOAL_ROUTE_H_
+#define MJPC_TASKS_SIMPLE_CAR_GOAL_ROUTE_H_
+
+#include <vector>
+
+namespace mjpc {
+
+// 多目标访问顺序（开放路径 TSP）
+//   代价 = 路径长度 + turn_weight * 各转折点的转角（弧度），
+//   起点为车辆当前位置和朝向。构造用最近邻，改进用 2-opt 和 Or-opt。
+class GoalRoute {
+ public:
+  GoalRoute() = default;
+
+  // 转角代价权重（米/弧度）
+  void SetTurnWeight(double weight) { turn_weight_ = weight; }
+  double turn_weight() const { return turn_weight_; }
+
+  // 起点：车辆位置和朝向
+  void SetStart(const double pos[2], double heading);
+
+  // 全量重建：最近邻 + 局部改进
+  void SetGoals(const double* xy, int num_goals);
+
+  // 增量加入一个目标：最便宜插入 + 局部改进
+  void AddGoal(double x, double y);
+
+  // 起点改变后在当前顺序上重新做局部改进
+  void Refine() { Improve(); }
+
+  // 取出下一个目标（顺序中的第一个）；队列为空时返回 false
+  //   被取出的目标成为新的起点，剩余顺序保持有效
+  bool PopNext(double goal[2]);
+
+  void Clear();
+  bool empty() const { return order_.empty(); }
+  int size() const { return order_.size(); }
+
+  // 按访问顺序的目标坐标
+  void Goal(int i, double goal[2]) const;
+
+  // 当前顺序的总代价
+  double Cost() const;
+
+ private:
+  // 反复执行 2-opt 和 Or-opt 直到没有改进（或达到轮数上限）
+  void Improve();
+  bool TwoOptPass();
+  bool OrOptPass();
+
+  double PathCost(const std::vector<int>& order) const;
+
+  double start_[2] = {0.0, 0.0};
+  double heading_ = 0.0;
+  double turn_weight_ = 0.3;
+
+  std::vector<double> xy_;   // 目标坐标（按加入顺序）
+  std::vector<int> order_;   // 访问顺序（xy_ 下标）
+  std::vector<int> scratch_;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_GOAL_ROUTE_H_
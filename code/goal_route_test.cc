@@ -0,0 +1,164 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/goal_route.h"
+
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace mjpc {
+namespace {
+
+TEST(GoalRouteTest, VisitsCollinearGoalsInOrder) {
+  GoalRoute route;
+  double start[2] = {0.0, 0.0};
+  route.SetStart(start, 0.0);
+  double xy[] = {3.0, 0.0, 1.0, 0.0, 4.0, 0.0, 2.0, 0.0};
+  route.SetGoals(xy, 4);
+
+  ASSERT_EQ(route.size(), 4);
+  EXPECT_DOUBLE_EQ(route.Cost(), 4.0);
+  for (int i = 0; i < 4; i++) {
+    double goal[2];
+    route.Goal(i, goal);
+    EXPECT_DOUBLE_EQ(goal[0], i + 1.0);
+    EXPECT_DOUBLE_EQ(goal[1], 0.0);
+  }
+}
+
+// 最近邻先去 1 → 3 → -1.5（7.5 m），局部改进后为 -1.5 → 1 → 3（6 m）
+TEST(GoalRouteTest, ImprovesNearestNeighborOrder) {
+  GoalRoute route;
+  route.SetTurnWeight(0.0);
+  double start[2] = {0.0, 0.0};
+  route.SetStart(start, 0.0);
+  double xy[] = {1.0, 0.0, -1.5, 0.0, 3.0, 0.0};
+  route.SetGoals(xy, 3);
+
+  EXPECT_NEAR(route.Cost(), 6.0, 1e-12);
+  double expected[3] = {-1.5, 1.0, 3.0};
+  for (int i = 0; i < 3; i++) {
+    double goal[2];
+    route.Goal(i, goal);
+    EXPECT_DOUBLE_EQ(goal[0], expected[i]);
+  }
+}
+
+// 按访问顺序的路径长度（turn_weight = 0 时即 Cost）
+double PathLength(const double start[2], const std::vector<double>& goals) {
+  double length = 0.0, x = start[0], y = start[1];
+  for (size_t i = 0; i < goals.size(); i += 2) {
+    length += std::hypot(goals[i] - x, goals[i + 1] - y);
+    x = goals[i];
+    y = goals[i + 1];
+  }
+  return length;
+}
+
+// 随机目标：结果对任何片段反转（2-opt）和单个目标移动（Or-opt）都是局部最优
+TEST(GoalRouteTest, LocallyOptimalAfterImprove) {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> unit(-3.0, 3.0);
+  double start[2] = {0.0, 0.0};
+  for (int trial = 0; trial < 20; trial++) {
+    int n = 8;
+    std::vector<double> xy(2 * n);
+    for (double& v : xy) v = unit(rng);
+    GoalRoute route;
+    route.SetTurnWeight(0.0);
+    route.SetStart(start, 0.0);
+    route.SetGoals(xy.data(), n);
+
+    std::vector<double> order(2 * n);
+    for (int i = 0; i < n; i++) route.Goal(i, order.data() + 2 * i);
+    double length = PathLength(start, order);
+    EXPECT_NEAR(route.Cost(), length, 1e-9);
+
+    for (int i = 0; i < n; i++) {
+      for (int j = i + 1; j < n; j++) {
+        std::vector<double> reversed = order;
+        for (int a = i, b = j; a < b; a++, b--) {
+          std::swap(reversed[2 * a], reversed[2 * b]);
+          std::swap(reversed[2 * a + 1], reversed[2 * b + 1]);
+        }
+        EXPECT_GE(PathLength(start, reversed), length - 1e-9)
+            << "trial " << trial << " reverse " << i << ".." << j;
+      }
+      for (int p = 0; p < n; p++) {
+        if (p == i) continue;
+        std::vector<double> moved = order;
+        moved.erase(moved.begin() + 2 * i, moved.begin() + 2 * i + 2);
+        moved.insert(moved.begin() + 2 * p, order.begin() + 2 * i,
+                     order.begin() + 2 * i + 2);
+        EXPECT_GE(PathLength(start, moved), length - 1e-9)
+            << "trial " << trial << " move " << i << " to " << p;
+      }
+    }
+  }
+}
+
+TEST(GoalRouteTest, PopNextAdvancesStart) {
+  GoalRoute route;
+  double start[2] = {0.0, 0.0};
+  route.SetStart(start, 0.0);
+  double xy[] = {2.0, 0.0, 1.0, 0.0};
+  route.SetGoals(xy, 2);
+
+  double goal[2];
+  ASSERT_TRUE(route.PopNext(goal));
+  EXPECT_DOUBLE_EQ(goal[0], 1.0);
+  EXPECT_EQ(route.size(), 1);
+  // 剩余路径从被取出的目标出发
+  EXPECT_DOUBLE_EQ(route.Cost(), 1.0);
+
+  // 增量加入的目标插到最便宜的位置
+  route.AddGoal(1.5, 0.0);
+  route.Goal(0, goal);
+  EXPECT_DOUBLE_EQ(goal[0], 1.5);
+
+  ASSERT_TRUE(route.PopNext(goal));
+  ASSERT_TRUE(route.PopNext(goal));
+  EXPECT_DOUBLE_EQ(goal[0], 2.0);
+  EXPECT_TRUE(route.empty());
+  EXPECT_FALSE(route.PopNext(goal));
+}
+
+// 起点朝 +x：A 在身后 1 m，B 在前方 1.2 m
+//   无转角代价时先去较近的 A；转角代价大时先去正前方的 B
+TEST(GoalRouteTest, TurnWeightAppliesToInitialOrder) {
+  double start[2] = {0.0, 0.0};
+  double xy[] = {-1.0, 0.0, 1.2, 0.0};
+  double goal[2];
+
+  GoalRoute route;
+  route.SetTurnWeight(0.0);
+  route.SetStart(start, 0.0);
+  route.SetGoals(xy, 2);
+  route.Goal(0, goal);
+  EXPECT_DOUBLE_EQ(goal[0], -1.0);
+
+  route.Clear();
+  route.SetTurnWeight(1.0);
+  route.SetStart(start, 0.0);
+  route.SetGoals(xy, 2);
+  route.Goal(0, goal);
+  EXPECT_DOUBLE_EQ(goal[0], 1.2);
+}
+
+}  // namespace
+}  // namespace mjpc
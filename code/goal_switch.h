@@ -0,0 +1,106 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_GOAL_SWITCH_H_
+#define MJPC_TASKS_SIMPLE_CAR_GOAL_SWITCH_H_
+
+#include <algorithm>
+#include <cmath>
+
+namespace mjpc {
+
+// 目标切换规则：TransitionLocked、残差和 rollout 共用同一判定
+inline constexpr double kGoalTolerance = 0.2;
+
+// 车辆是否到达目标
+inline bool GoalReached(const double car[2], const double goal[2]) {
+  return std::hypot(car[0] - goal[0], car[1] - goal[1]) < kGoalTolerance;
+}
+
+// 扫掠检测：车辆在一步内从 p0 移动到 p1 时是否经过目标容差圆
+//   大步长或高速时点检测会漏掉穿过圆盘的情况。
+//   命中时 fraction 返回首次进入圆盘的插值比例 [0, 1]（p0 已在圆内时为 0）
+inline bool SweptGoalReached(const double p0[2], const double p1[2],
+                             const double goal[2], double* fraction) {
+  double f[2] = {p0[0] - goal[0], p0[1] - goal[1]};
+  double c = f[0] * f[0] + f[1] * f[1] - kGoalTolerance * kGoalTolerance;
+  if (c < 0.0) {
+    *fraction = 0.0;
+    return true;
+  }
+
+  // |f + s d|^2 = tol^2 的较小根
+  double d[2] = {p1[0] - p0[0], p1[1] - p0[1]};
+  double a = d[0] * d[0] + d[1] * d[1];
+  double b = f[0] * d[0] + f[1] * d[1];
+  if (a <= 0.0 || b >= 0.0) return false;  // 静止或远离目标
+  double disc = b * b - a * c;
+  if (disc < 0.0) return false;
+  double s = (-b - std::sqrt(disc)) / a;
+  if (s > 1.0) return false;
+  *fraction = s;
+  return true;
+}
+
+// 残差使用的切换锁存，作为 rollout 状态存放在 mjData::userdata 中
+//   （规划器的状态复制包含 userdata，每条 rollout 从真实状态的锁存出发）
+//   [0]：0 尚未评估，1 未到达，2 已到达；[1..2]：上次评估时的车辆位置
+inline constexpr int kGoalLatchSize = 3;
+
+// 按上次位置到当前位置的扫掠更新锁存，返回是否已切换到下一个目标
+//   一旦切换就保持，离开容差圆后也不会退回"先去 goal"的代价
+inline bool UpdateGoalLatch(const double car[2], const double goal[2],
+                            double latch[kGoalLatchSize]) {
+  if (latch[0] != 2.0) {
+    double fraction;
+    bool reached = latch[0] == 1.0
+                       ? SweptGoalReached(latch + 1, car, goal, &fraction)
+                       : GoalReached(car, goal);
+    latch[0] = reached ? 2.0 : 1.0;
+  }
+  latch[1] = car[0];
+  latch[2] = car[1];
+  return latch[0] == 2.0;
+}
+
+// 目标改变后清除锁存
+inline void ClearGoalLatch(double latch[kGoalLatchSize]) {
+  latch[0] = latch[1] = latch[2] = 0.0;
+}
+
+// 已知下一个目标时的剩余路程残差（二维）
+//   未切换：|car - goal| + |next - goal|，方向指向 goal
+//   已切换（见 UpdateGoalLatch）：|car - next|，方向指向 next
+//   切换时范数不增（三角不等式），之后随靠近 next 单调下降，
+//   rollout 会穿过目标而不是停在目标上
+inline void RemainingRouteResidual(const double car[2], const double goal[2],
+                                   const double next[2], bool switched,
+                                   double residual[2]) {
+  if (switched) {
+    residual[0] = car[0] - next[0];
+    residual[1] = car[1] - next[1];
+    return;
+  }
+
+  double to_goal[2] = {car[0] - goal[0], car[1] - goal[1]};
+  double d_goal = std::max(std::hypot(to_goal[0], to_goal[1]), 1e-12);
+  double leg = std::hypot(next[0] - goal[0], next[1] - goal[1]);
+  double scale = (d_goal + leg) / d_goal;
+  residual[0] = scale * to_goal[0];
+  residual[1] = scale * to_goal[1];
+}
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_GOAL_SWITCH_H_
@@ -0,0 +1,104 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/goal_switch.h"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+namespace mjpc {
+namespace {
+
+// 沿 from -> to 直线行驶，每步更新锁存并返回剩余路程残差的范数
+class RouteWalk {
+ public:
+  RouteWalk(const double goal[2], const double next[2])
+      : goal_{goal[0], goal[1]}, next_{next[0], next[1]} {}
+
+  double Cost(const double car[2]) {
+    bool switched = UpdateGoalLatch(car, goal_, latch_);
+    double residual[2];
+    RemainingRouteResidual(car, goal_, next_, switched, residual);
+    return std::hypot(residual[0], residual[1]);
+  }
+
+  bool switched() const { return latch_[0] == 2.0; }
+
+ private:
+  double goal_[2];
+  double next_[2];
+  double latch_[kGoalLatchSize] = {0.0, 0.0, 0.0};
+};
+
+TEST(GoalSwitchTest, CostNeverIncreasesFromGoalToNext) {
+  double goal[2] = {1.0, 0.0};
+  double next[2] = {1.0, 2.0};
+  RouteWalk walk(goal, next);
+
+  // 起点 → goal → next，每步 1 cm
+  double start[2] = {-1.0, 0.0};
+  double previous = walk.Cost(start);
+  const double* legs[2][2] = {{start, goal}, {goal, next}};
+  for (const auto& leg : legs) {
+    for (int i = 1; i <= 200; i++) {
+      double s = i / 200.0;
+      double car[2] = {leg[0][0] + s * (leg[1][0] - leg[0][0]),
+                       leg[0][1] + s * (leg[1][1] - leg[0][1])};
+      double cost = walk.Cost(car);
+      EXPECT_LE(cost, previous + 1e-12) << "at (" << car[0] << ", " << car[1]
+                                        << ")";
+      previous = cost;
+    }
+  }
+  EXPECT_TRUE(walk.switched());
+  EXPECT_NEAR(previous, 0.0, 1e-12);
+}
+
+TEST(GoalSwitchTest, SwitchStaysLatchedOutsideDisk) {
+  double goal[2] = {0.0, 0.0};
+  double next[2] = {2.0, 0.0};
+  RouteWalk walk(goal, next);
+  double inside[2] = {0.1, 0.0};
+  walk.Cost(inside);
+  ASSERT_TRUE(walk.switched());
+
+  // 离开容差圆后仍按 |car - next| 计，而不是 d_goal + leg
+  double outside[2] = {0.5, 0.0};
+  EXPECT_NEAR(walk.Cost(outside), 1.5, 1e-12);
+}
+
+TEST(GoalSwitchTest, SweptStepLatches) {
+  // 一步从圆前 0.5 m 跨到圆后 0.5 m，两个采样点都不在圆内
+  double goal[2] = {0.0, 0.0};
+  double next[2] = {3.0, 0.0};
+  RouteWalk walk(goal, next);
+  double before[2] = {-0.5, 0.0};
+  double after[2] = {0.5, 0.0};
+  EXPECT_NEAR(walk.Cost(before), 3.5, 1e-12);
+  EXPECT_FALSE(walk.switched());
+  EXPECT_NEAR(walk.Cost(after), 2.5, 1e-12);
+  EXPECT_TRUE(walk.switched());
+}
+
+TEST(GoalSwitchTest, ClearedLatchRestartsFromGoal) {
+  double goal[2] = {0.0, 0.0};
+  double latch[kGoalLatchSize] = {2.0, 0.0, 0.0};
+  ClearGoalLatch(latch);
+  double far[2] = {-2.0, 0.0};
+  EXPECT_FALSE(UpdateGoalLatch(far, goal, latch));
+}
+
+}  // namespace
+}  // namespace mjpc
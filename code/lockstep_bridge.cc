@@ -0,0 +1,315 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/lockstep_bridge.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+namespace {
+
+int64_t NowNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+uint32_t* FutexWord(std::atomic<uint32_t>* word) {
+  return reinterpret_cast<uint32_t*>(word);
+}
+
+// 跨进程 futex：等待 *word 不再等于 expected，最多 timeout_ns
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected,
+               int64_t timeout_ns) {
+  timespec timeout;
+  timeout.tv_sec = timeout_ns / 1000000000LL;
+  timeout.tv_nsec = timeout_ns % 1000000000LL;
+  syscall(SYS_futex, FutexWord(word), FUTEX_WAIT, expected, &timeout, nullptr,
+          0);
+}
+
+void FutexWake(std::atomic<uint32_t>* word) {
+  syscall(SYS_futex, FutexWord(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr,
+          0);
+}
+
+// 等待 *word == target（server）或 != target（client）：先自旋再 futex
+template <typename Ready>
+bool WaitFor(std::atomic<uint32_t>* word, Ready ready, double timeout_us,
+             double spin_us) {
+  // 单核时自旋只会占用对方进程的时间片
+  static const bool multi_core = std::thread::hardware_concurrency() > 1;
+  if (!multi_core) spin_us = 0.0;
+
+  int64_t start = NowNs();
+  int64_t spin_end = start + static_cast<int64_t>(spin_us * 1e3);
+  int64_t deadline = start + static_cast<int64_t>(timeout_us * 1e3);
+
+  while (true) {
+    uint32_t value = word->load(std::memory_order_acquire);
+    if (ready(value)) return true;
+    int64_t now = NowNs();
+    if (now >= deadline) return false;
+    if (now < spin_end) {
+      CpuRelax();
+    } else {
+      FutexWait(word, value, deadline - now);
+    }
+  }
+}
+
+LockstepShared* Map(int fd) {
+  void* memory = mmap(nullptr, sizeof(LockstepShared), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  return memory == MAP_FAILED ? nullptr
+                              : static_cast<LockstepShared*>(memory);
+}
+
+// ---------- 主仿真控制量覆盖 ----------
+//   登记（任务线程）与回调（仿真线程）之间只通过原子变量传递；
+//   exchange_mutex 保护进行中的交换和 server 统计，不与任务锁嵌套
+std::atomic<const mjData*> lockstep_data{nullptr};
+std::atomic<LockstepServer*> lockstep_server{nullptr};
+std::atomic<bool> lockstep_pending{false};
+std::atomic<double> lockstep_timeout_us{0.0};
+std::atomic<double> lockstep_spin_us{0.0};
+std::atomic<double> lockstep_ctrl[2] = {0.0, 0.0};
+std::atomic<bool> lockstep_active{false};
+std::mutex exchange_mutex;
+mjfGeneric previous_control = nullptr;
+bool control_installed = false;
+
+void LockstepControl(const mjModel* model, mjData* data) {
+  if (previous_control) previous_control(model, data);
+  // 规划器线程的 rollout 也会调用此回调，先按 mjData 过滤
+  if (data != lockstep_data.load(std::memory_order_acquire)) return;
+
+  // 此时 data 仍是 Transition 时的状态：在这里交换，等待期间不持有任务锁
+  if (lockstep_pending.exchange(false, std::memory_order_acq_rel)) {
+    std::lock_guard<std::mutex> lock(exchange_mutex);
+    LockstepServer* server = lockstep_server.load(std::memory_order_acquire);
+    if (server) {
+      double ctrl[2] = {0.0, 0.0};
+      bool ok = server->Exchange(
+          data, lockstep_timeout_us.load(std::memory_order_relaxed),
+          lockstep_spin_us.load(std::memory_order_relaxed), ctrl);
+      lockstep_ctrl[0].store(ctrl[0], std::memory_order_relaxed);
+      lockstep_ctrl[1].store(ctrl[1], std::memory_order_relaxed);
+      lockstep_active.store(ok, std::memory_order_release);
+    }
+  }
+
+  if (!lockstep_active.load(std::memory_order_acquire) || model->nu < 2) {
+    return;
+  }
+  data->ctrl[0] = lockstep_ctrl[0].load(std::memory_order_relaxed);
+  data->ctrl[1] = lockstep_ctrl[1].load(std::memory_order_relaxed);
+}
+
+}  // namespace
+
+LockstepServer::~LockstepServer() { Close(); }
+
+bool LockstepServer::Open(const std::string& name, const mjModel* model) {
+  Close();
+  if (model->nq > kLockstepMaxQ || model->nv > kLockstepMaxV) return false;
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd < 0) return false;
+  if (ftruncate(fd, sizeof(LockstepShared)) != 0) {
+    close(fd);
+    return false;
+  }
+  shared_ = Map(fd);
+  close(fd);
+  if (!shared_) return false;
+
+  std::memset(static_cast<void*>(shared_), 0, sizeof(LockstepShared));
+  new (shared_) LockstepShared();
+  shared_->version = kLockstepVersion;
+  shared_->nq = model->nq;
+  shared_->nv = model->nv;
+  shared_->state_seq.store(0, std::memory_order_relaxed);
+  shared_->ctrl_seq.store(0, std::memory_order_relaxed);
+  // magic 最后写入：控制器看到 magic 即可开始读取
+  std::atomic_thread_fence(std::memory_order_release);
+  shared_->magic = kLockstepMagic;
+
+  name_ = name;
+  sequence_ = 0;
+  ResetStats();
+  return true;
+}
+
+void LockstepServer::Close() {
+  if (!shared_) return;
+  ClearLockstepControl();
+  munmap(shared_, sizeof(LockstepShared));
+  shm_unlink(name_.c_str());
+  shared_ = nullptr;
+}
+
+bool LockstepServer::Exchange(const mjData* data, double timeout_us,
+                              double spin_us, double ctrl[2]) {
+  int64_t start = NowNs();
+
+  shared_->time = data->time;
+  std::copy_n(data->qpos, shared_->nq, shared_->qpos);
+  std::copy_n(data->qvel, shared_->nv, shared_->qvel);
+  shared_->goal[0] = data->mocap_pos[0];
+  shared_->goal[1] = data->mocap_pos[1];
+
+  uint32_t sequence = ++sequence_;
+  shared_->state_seq.store(sequence, std::memory_order_release);
+  FutexWake(&shared_->state_seq);
+
+  // 迟到的旧序号控制量不会被接受
+  bool ok = WaitFor(
+      &shared_->ctrl_seq, [sequence](uint32_t v) { return v == sequence; },
+      timeout_us, spin_us);
+
+  exchanges_++;
+  if (!ok) {
+    timeouts_++;
+    return false;
+  }
+  ctrl[0] = shared_->ctrl[0];
+  ctrl[1] = shared_->ctrl[1];
+
+  double elapsed_us = (NowNs() - start) * 1e-3;
+  sum_us_ += elapsed_us;
+  max_us_ = std::max(max_us_, elapsed_us);
+  return true;
+}
+
+LockstepStats LockstepServer::stats() const {
+  std::lock_guard<std::mutex> lock(exchange_mutex);
+  LockstepStats stats;
+  stats.exchanges = exchanges_;
+  stats.timeouts = timeouts_;
+  uint64_t completed = exchanges_ - timeouts_;
+  stats.mean_us = completed > 0 ? sum_us_ / completed : 0.0;
+  stats.max_us = max_us_;
+  return stats;
+}
+
+void LockstepServer::ResetStats() {
+  std::lock_guard<std::mutex> lock(exchange_mutex);
+  exchanges_ = 0;
+  timeouts_ = 0;
+  sum_us_ = 0.0;
+  max_us_ = 0.0;
+}
+
+LockstepClient::~LockstepClient() { Close(); }
+
+bool LockstepClient::Open(const std::string& name) {
+  Close();
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) return false;
+  shared_ = Map(fd);
+  close(fd);
+  if (!shared_) return false;
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (shared_->magic != kLockstepMagic ||
+      shared_->version != kLockstepVersion) {
+    Close();
+    return false;
+  }
+  // 以最近一次回复的序号为基准：打开前已发布但未回复的状态会被立即处理
+  sequence_ = shared_->ctrl_seq.load(std::memory_order_acquire);
+  return true;
+}
+
+void LockstepClient::Close() {
+  if (!shared_) return;
+  munmap(shared_, sizeof(LockstepShared));
+  shared_ = nullptr;
+}
+
+bool LockstepClient::WaitState(double timeout_us, double spin_us) {
+  uint32_t last = sequence_;
+  if (!WaitFor(
+          &shared_->state_seq, [last](uint32_t v) { return v != last; },
+          timeout_us, spin_us)) {
+    return false;
+  }
+  sequence_ = shared_->state_seq.load(std::memory_order_acquire);
+  return true;
+}
+
+void LockstepClient::SendControl(const double ctrl[2]) {
+  shared_->ctrl[0] = ctrl[0];
+  shared_->ctrl[1] = ctrl[1];
+  shared_->ctrl_seq.store(sequence_, std::memory_order_release);
+  FutexWake(&shared_->ctrl_seq);
+}
+
+void RequestLockstepExchange(LockstepServer* server, const mjData* data,
+                             double timeout_us, double spin_us) {
+  if (!control_installed) {
+    previous_control = mjcb_control;
+    mjcb_control = LockstepControl;
+    control_installed = true;
+  }
+  lockstep_timeout_us.store(timeout_us, std::memory_order_relaxed);
+  lockstep_spin_us.store(spin_us, std::memory_order_relaxed);
+  lockstep_server.store(server, std::memory_order_release);
+  lockstep_data.store(data, std::memory_order_release);
+  lockstep_pending.store(true, std::memory_order_release);
+}
+
+void ClearLockstepControl() {
+  lockstep_data.store(nullptr, std::memory_order_release);
+  lockstep_server.store(nullptr, std::memory_order_release);
+  lockstep_pending.store(false, std::memory_order_release);
+  lockstep_active.store(false, std::memory_order_release);
+  // 等待进行中的交换结束
+  std::lock_guard<std::mutex> lock(exchange_mutex);
+  if (control_installed) {
+    mjcb_control = previous_control;
+    previous_control = nullptr;
+    control_installed = false;
+  }
+}
+
+}  // namespace mjpc
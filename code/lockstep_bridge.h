@@ -0,0 +1,133 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_LOCKSTEP_BRIDGE_H_
+#define MJPC_TASKS_SIMPLE_CAR_LOCKSTEP_BRIDGE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+inline constexpr uint64_t kLockstepMagic = 0x504554534B434F4CULL;  // "LOCKSTEP"
+inline constexpr uint32_t kLockstepVersion = 1;
+inline constexpr int kLockstepMaxQ = 16;
+inline constexpr int kLockstepMaxV = 16;
+
+// 共享内存布局（POSIX shm，两个进程映射同一对象）
+//   仿真端写状态后递增 state_seq 并唤醒；控制器写 ctrl 后把 ctrl_seq 设为同一序号
+//   两个序号各占一个缓存行，作为 futex 字（跨进程，非 PRIVATE）
+struct alignas(64) LockstepShared {
+  uint64_t magic;
+  uint32_t version;
+  int32_t nq;
+  int32_t nv;
+
+  alignas(64) std::atomic<uint32_t> state_seq;
+  alignas(64) std::atomic<uint32_t> ctrl_seq;
+
+  // 仿真端写入
+  alignas(64) double time;
+  double qpos[kLockstepMaxQ];
+  double qvel[kLockstepMaxV];
+  double goal[2];
+
+  // 控制器写入：ctrl[0] 前进，ctrl[1] 转向
+  alignas(64) double ctrl[2];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+// 往返耗时与超时统计
+struct LockstepStats {
+  uint64_t exchanges = 0;
+  uint64_t timeouts = 0;
+  double mean_us = 0.0;  // 成功交换的平均往返耗时
+  double max_us = 0.0;
+};
+
+// 仿真端：每个控制周期发布状态并等待外部控制器的 ctrl
+class LockstepServer {
+ public:
+  LockstepServer() = default;
+  ~LockstepServer();
+  LockstepServer(const LockstepServer&) = delete;
+  LockstepServer& operator=(const LockstepServer&) = delete;
+
+  // 创建共享内存对象（例如 "/simple_car_lockstep"）
+  bool Open(const std::string& name, const mjModel* model);
+  void Close();
+  bool IsOpen() const { return shared_ != nullptr; }
+
+  // 发布状态并等待控制量：先自旋 spin_us，再在 futex 上等待，
+  //   总等待超过 timeout_us 时返回 false（调用方回退到内部规划器）
+  bool Exchange(const mjData* data, double timeout_us, double spin_us,
+                double ctrl[2]);
+
+  // 与 mjcb_control 中的交换互斥，可在其它线程调用
+  LockstepStats stats() const;
+  void ResetStats();
+
+ private:
+  std::string name_;
+  LockstepShared* shared_ = nullptr;
+  uint32_t sequence_ = 0;
+
+  uint64_t exchanges_ = 0;
+  uint64_t timeouts_ = 0;
+  double sum_us_ = 0.0;
+  double max_us_ = 0.0;
+};
+
+// 控制器端（外部进程）
+class LockstepClient {
+ public:
+  LockstepClient() = default;
+  ~LockstepClient();
+  LockstepClient(const LockstepClient&) = delete;
+  LockstepClient& operator=(const LockstepClient&) = delete;
+
+  bool Open(const std::string& name);
+  void Close();
+
+  // 等待新的状态，超时返回 false
+  bool WaitState(double timeout_us, double spin_us);
+
+  // 回写控制量并唤醒仿真端
+  void SendControl(const double ctrl[2]);
+
+  const LockstepShared& shared() const { return *shared_; }
+
+ private:
+  LockstepShared* shared_ = nullptr;
+  uint32_t sequence_ = 0;
+};
+
+// 主仿真的锁步交换与控制量覆盖，都在 mjcb_control 回调（mj_step 内）中进行：
+//   RequestLockstepExchange 只登记下一次交换，不阻塞（在持有任务锁的
+//   TransitionLocked 中调用）；回调在不持有任务锁时对注册的 mjData 执行
+//   Exchange，得到的控制量沿用到下一次交换，超时的周期保留规划器给出的控制量。
+//   只作用于注册的 mjData，规划器 rollout 使用的其它 mjData 不受影响
+void RequestLockstepExchange(LockstepServer* server, const mjData* data,
+                             double timeout_us, double spin_us);
+
+// 注销回调；等待进行中的交换结束后返回，之后可以关闭 server
+void ClearLockstepControl();
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_LOCKSTEP_BRIDGE_H_
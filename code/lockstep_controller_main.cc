@@ -0,0 +1,123 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 锁步外部控制器示例：从共享内存读取状态，按简单的追踪律回写控制量
+//   task.xml 中设置 <text name="lockstep_shm" data="/simple_car_lockstep"/>
+//   lockstep_controller --shm=/simple_car_lockstep
+// --benchmark 时在子进程中运行控制器，测量往返开销
+//   lockstep_controller --benchmark --iterations=100000
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/lockstep_bridge.h"
+
+ABSL_FLAG(std::string, shm, "/simple_car_lockstep", "shared memory name");
+ABSL_FLAG(double, spin_us, 50.0, "spin before sleeping on the futex (us)");
+ABSL_FLAG(bool, benchmark, false, "measure round-trip overhead and exit");
+ABSL_FLAG(int, iterations, 100000, "benchmark exchanges");
+
+namespace {
+
+// 追踪律：朝目标转向，距离越远速度越大
+void PursuitControl(const mjpc::LockstepShared& shared, double ctrl[2]) {
+  const double* q = shared.qpos + 3;
+  double heading = std::atan2(2.0 * (q[0] * q[3] + q[1] * q[2]),
+                              1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]));
+  double dx = shared.goal[0] - shared.qpos[0];
+  double dy = shared.goal[1] - shared.qpos[1];
+  double error = std::remainder(std::atan2(dy, dx) - heading, 2.0 * M_PI);
+  double distance = std::sqrt(dx * dx + dy * dy);
+  ctrl[0] = std::clamp(distance * std::cos(error), -1.0, 1.0);
+  ctrl[1] = std::clamp(2.0 * error, -1.0, 1.0);
+}
+
+int RunController(const std::string& name, double spin_us, int limit) {
+  mjpc::LockstepClient client;
+  if (!client.Open(name)) {
+    std::fprintf(stderr, "failed to open '%s'\n", name.c_str());
+    return 1;
+  }
+  for (int i = 0; limit <= 0 || i < limit; i++) {
+    if (!client.WaitState(1e6, spin_us)) {
+      if (limit > 0) return 1;
+      continue;  // 仿真暂停
+    }
+    double ctrl[2];
+    PursuitControl(client.shared(), ctrl);
+    client.SendControl(ctrl);
+  }
+  return 0;
+}
+
+// 仿真端在本进程，控制器在子进程
+int Benchmark(const std::string& name, double spin_us, int iterations) {
+  mjModel model = {};
+  model.nq = 9;
+  model.nv = 8;
+  mjpc::LockstepServer server;
+  if (!server.Open(name, &model)) {
+    std::fprintf(stderr, "failed to create '%s'\n", name.c_str());
+    return 1;
+  }
+
+  pid_t child = fork();
+  if (child == 0) _exit(RunController(name, spin_us, iterations));
+
+  double qpos[9] = {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  double qvel[8] = {0.0};
+  double mocap_pos[3] = {1.0, 1.0, 0.0};
+  mjData data = {};
+  data.qpos = qpos;
+  data.qvel = qvel;
+  data.mocap_pos = mocap_pos;
+
+  double ctrl[2];
+  // 第一次交换等待子进程启动
+  server.Exchange(&data, 1e6, spin_us, ctrl);
+  server.ResetStats();
+  for (int i = 1; i < iterations; i++) {
+    data.time += 0.02;
+    server.Exchange(&data, 1e5, spin_us, ctrl);
+  }
+  waitpid(child, nullptr, 0);
+
+  mjpc::LockstepStats stats = server.stats();
+  std::printf("exchanges %llu  timeouts %llu  round trip: mean %.2f us, "
+              "max %.2f us\n",
+              static_cast<unsigned long long>(stats.exchanges),
+              static_cast<unsigned long long>(stats.timeouts), stats.mean_us,
+              stats.max_us);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  std::string name = absl::GetFlag(FLAGS_shm);
+  double spin_us = absl::GetFlag(FLAGS_spin_us);
+  if (absl::GetFlag(FLAGS_benchmark)) {
+    return Benchmark(name, spin_us, absl::GetFlag(FLAGS_iterations));
+  }
+  return RunController(name, spin_us, 0);
+}
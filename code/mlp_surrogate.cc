@@ -0,0 +1,611 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/mlp_surrogate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_sysid.h"
+
+// GCC / Clang 在 x86 上按函数指定指令集编译，运行时选择，不依赖编译选项
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define MJPC_MLP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace mjpc {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'A', 'R', 'M', 'L', 'P', '0', '1'};
+constexpr int kMaxWidth = 1024;
+
+// tanh 的 (7, 6) 连分式逼近，|x| <= 4.97 内误差小于 2e-5，之外取端点值
+constexpr float kTanhClamp = 4.97f;
+
+inline float Tanh(float x) {
+  x = std::min(std::max(x, -kTanhClamp), kTanhClamp);
+  float x2 = x * x;
+  float p = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+  float q = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+  return p / q;
+}
+
+// 一层：out[o][s] = act(b[o] + sum_i w[o][i] * in[i][s])
+void LayerScalar(const float* w, const float* b, const float* in, int nin,
+                 int nout, int stride, bool activation, float* out) {
+  for (int o = 0; o < nout; o++) {
+    float* y = out + o * stride;
+    for (int s = 0; s < stride; s++) y[s] = b[o];
+    for (int i = 0; i < nin; i++) {
+      float wi = w[o * nin + i];
+      const float* x = in + i * stride;
+      for (int s = 0; s < stride; s++) y[s] += wi * x[s];
+    }
+    if (activation) {
+      for (int s = 0; s < stride; s++) y[s] = Tanh(y[s]);
+    }
+  }
+}
+
+#ifdef MJPC_MLP_X86
+
+__attribute__((target("avx2,fma"))) inline __m256 Tanh8(__m256 x) {
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-kTanhClamp)),
+                    _mm256_set1_ps(kTanhClamp));
+  __m256 x2 = _mm256_mul_ps(x, x);
+  __m256 p = _mm256_fmadd_ps(x2, _mm256_set1_ps(1.0f), _mm256_set1_ps(378.0f));
+  p = _mm256_fmadd_ps(x2, p, _mm256_set1_ps(17325.0f));
+  p = _mm256_fmadd_ps(x2, p, _mm256_set1_ps(135135.0f));
+  p = _mm256_mul_ps(x, p);
+  __m256 q = _mm256_fmadd_ps(x2, _mm256_set1_ps(28.0f), _mm256_set1_ps(3150.0f));
+  q = _mm256_fmadd_ps(x2, q, _mm256_set1_ps(62370.0f));
+  q = _mm256_fmadd_ps(x2, q, _mm256_set1_ps(135135.0f));
+  return _mm256_div_ps(p, q);
+}
+
+// 4 个输出 × 16 个样本的寄存器分块：每次载入的输入被 4 个输出复用
+__attribute__((target("avx2,fma"))) void LayerAvx2(
+    const float* w, const float* b, const float* in, int nin, int nout,
+    int stride, bool activation, float* out) {
+  int o = 0;
+  for (; o + 4 <= nout; o += 4) {
+    for (int s = 0; s < stride; s += 16) {
+      __m256 acc[4][2];
+      for (int k = 0; k < 4; k++) {
+        acc[k][0] = acc[k][1] = _mm256_set1_ps(b[o + k]);
+      }
+      for (int i = 0; i < nin; i++) {
+        __m256 x0 = _mm256_loadu_ps(in + i * stride + s);
+        __m256 x1 = _mm256_loadu_ps(in + i * stride + s + 8);
+        for (int k = 0; k < 4; k++) {
+          __m256 wk = _mm256_set1_ps(w[(o + k) * nin + i]);
+          acc[k][0] = _mm256_fmadd_ps(wk, x0, acc[k][0]);
+          acc[k][1] = _mm256_fmadd_ps(wk, x1, acc[k][1]);
+        }
+      }
+      for (int k = 0; k < 4; k++) {
+        if (activation) {
+          acc[k][0] = Tanh8(acc[k][0]);
+          acc[k][1] = Tanh8(acc[k][1]);
+        }
+        _mm256_storeu_ps(out + (o + k) * stride + s, acc[k][0]);
+        _mm256_storeu_ps(out + (o + k) * stride + s + 8, acc[k][1]);
+      }
+    }
+  }
+  for (; o < nout; o++) {
+    for (int s = 0; s < stride; s += 8) {
+      __m256 acc = _mm256_set1_ps(b[o]);
+      for (int i = 0; i < nin; i++) {
+        acc = _mm256_fmadd_ps(_mm256_set1_ps(w[o * nin + i]),
+                              _mm256_loadu_ps(in + i * stride + s), acc);
+      }
+      if (activation) acc = Tanh8(acc);
+      _mm256_storeu_ps(out + o * stride + s, acc);
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline __m512 Tanh16(__m512 x) {
+  x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(-kTanhClamp)),
+                    _mm512_set1_ps(kTanhClamp));
+  __m512 x2 = _mm512_mul_ps(x, x);
+  __m512 p = _mm512_add_ps(x2, _mm512_set1_ps(378.0f));
+  p = _mm512_fmadd_ps(x2, p, _mm512_set1_ps(17325.0f));
+  p = _mm512_fmadd_ps(x2, p, _mm512_set1_ps(135135.0f));
+  p = _mm512_mul_ps(x, p);
+  __m512 q = _mm512_fmadd_ps(x2, _mm512_set1_ps(28.0f), _mm512_set1_ps(3150.0f));
+  q = _mm512_fmadd_ps(x2, q, _mm512_set1_ps(62370.0f));
+  q = _mm512_fmadd_ps(x2, q, _mm512_set1_ps(135135.0f));
+  return _mm512_div_ps(p, q);
+}
+
+// 4 个输出 × 32 个样本
+__attribute__((target("avx512f"))) void LayerAvx512(
+    const float* w, const float* b, const float* in, int nin, int nout,
+    int stride, bool activation, float* out) {
+  int o = 0;
+  for (; o + 4 <= nout; o += 4) {
+    for (int s = 0; s < stride; s += 32) {
+      __m512 acc[4][2];
+      for (int k = 0; k < 4; k++) {
+        acc[k][0] = acc[k][1] = _mm512_set1_ps(b[o + k]);
+      }
+      for (int i = 0; i < nin; i++) {
+        __m512 x0 = _mm512_loadu_ps(in + i * stride + s);
+        __m512 x1 = _mm512_loadu_ps(in + i * stride + s + 16);
+        for (int k = 0; k < 4; k++) {
+          __m512 wk = _mm512_set1_ps(w[(o + k) * nin + i]);
+          acc[k][0] = _mm512_fmadd_ps(wk, x0, acc[k][0]);
+          acc[k][1] = _mm512_fmadd_ps(wk, x1, acc[k][1]);
+        }
+      }
+      for (int k = 0; k < 4; k++) {
+        if (activation) {
+          acc[k][0] = Tanh16(acc[k][0]);
+          acc[k][1] = Tanh16(acc[k][1]);
+        }
+        _mm512_storeu_ps(out + (o + k) * stride + s, acc[k][0]);
+        _mm512_storeu_ps(out + (o + k) * stride + s + 16, acc[k][1]);
+      }
+    }
+  }
+  for (; o < nout; o++) {
+    for (int s = 0; s < stride; s += 16) {
+      __m512 acc = _mm512_set1_ps(b[o]);
+      for (int i = 0; i < nin; i++) {
+        acc = _mm512_fmadd_ps(_mm512_set1_ps(w[o * nin + i]),
+                              _mm512_loadu_ps(in + i * stride + s), acc);
+      }
+      if (activation) acc = Tanh16(acc);
+      _mm512_storeu_ps(out + o * stride + s, acc);
+    }
+  }
+}
+
+#endif  // MJPC_MLP_X86
+
+int AlignBatch(int n) {
+  return (n + kMlpBatchAlign - 1) / kMlpBatchAlign * kMlpBatchAlign;
+}
+
+float WrapAngle(float angle) {
+  return std::remainder(angle, 2.0f * static_cast<float>(M_PI));
+}
+
+}  // namespace
+
+void PlanarCarBatch::Resize(int n) {
+  size = n;
+  stride = AlignBatch(std::max(n, 1));
+  for (std::vector<float>* v : {&x, &y, &heading, &speed, &yaw_rate}) {
+    v->assign(stride, 0.0f);
+  }
+}
+
+void PlanarCarBatch::Set(int i, const PlanarCarState& state) {
+  x[i] = state.pos[0];
+  y[i] = state.pos[1];
+  heading[i] = state.heading;
+  speed[i] = state.speed;
+  yaw_rate[i] = state.yaw_rate;
+}
+
+PlanarCarState PlanarCarBatch::Get(int i) const {
+  PlanarCarState state;
+  state.pos[0] = x[i];
+  state.pos[1] = y[i];
+  state.heading = heading[i];
+  state.speed = speed[i];
+  state.yaw_rate = yaw_rate[i];
+  return state;
+}
+
+MlpSurrogate::Isa MlpSurrogate::BestIsa() {
+#ifdef MJPC_MLP_X86
+  if (__builtin_cpu_supports("avx512f")) return kAvx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return kAvx2;
+  }
+#endif
+  return kScalar;
+}
+
+const char* MlpSurrogate::IsaName(Isa isa) {
+  switch (isa) {
+    case kAvx512:
+      return "avx512";
+    case kAvx2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
+
+void MlpSurrogate::set_isa(Isa isa) { isa_ = std::min(isa, BestIsa()); }
+
+void MlpSurrogate::Initialize(const std::vector<int>& hidden, uint64_t seed) {
+  num_layers_ = std::min(static_cast<int>(hidden.size()) + 1, kMaxLayers);
+  sizes_[0] = kInputs;
+  for (int l = 1; l < num_layers_; l++) {
+    sizes_[l] = std::clamp(hidden[l - 1], 1, kMaxWidth);
+  }
+  sizes_[num_layers_] = kOutputs;
+
+  std::mt19937_64 rng(seed);
+  for (int l = 0; l < num_layers_; l++) {
+    int nin = sizes_[l], nout = sizes_[l + 1];
+    float scale = std::sqrt(6.0f / (nin + nout));
+    std::uniform_real_distribution<float> uniform(-scale, scale);
+    weights_[l].resize(nin * nout);
+    for (float& w : weights_[l]) w = uniform(rng);
+    bias_[l].assign(nout, 0.0f);
+  }
+  Prepare();
+}
+
+void MlpSurrogate::Prepare() {
+  for (int l = 0; l < num_layers_; l++) {
+    folded_w_[l] = weights_[l];
+    folded_b_[l] = bias_[l];
+  }
+  if (num_layers_ == 0) return;
+
+  // 输入归一化并入第一层：W' = W / std，b' = b - W' mean
+  int nin = sizes_[0], nout = sizes_[1];
+  for (int o = 0; o < nout; o++) {
+    for (int i = 0; i < nin; i++) {
+      float& w = folded_w_[0][o * nin + i];
+      w /= input_std[i];
+      folded_b_[0][o] -= w * input_mean[i];
+    }
+  }
+
+  // 输出反归一化并入最后一层：W' = std W，b' = std b + mean
+  int last = num_layers_ - 1;
+  nin = sizes_[last];
+  for (int o = 0; o < kOutputs; o++) {
+    for (int i = 0; i < nin; i++) folded_w_[last][o * nin + i] *= output_std[o];
+    folded_b_[last][o] = folded_b_[last][o] * output_std[o] + output_mean[o];
+  }
+}
+
+bool MlpSurrogate::Save(const std::string& path) const {
+  if (!valid()) return false;
+  MlpFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.num_layers = num_layers_;
+  for (int l = 0; l <= num_layers_; l++) header.sizes[l] = sizes_[l];
+  header.dt = dt_;
+  header.model_fingerprint = model_fingerprint_;
+
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) return false;
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+  ok = ok && std::fwrite(input_mean, sizeof(float), kInputs, file) == kInputs;
+  ok = ok && std::fwrite(input_std, sizeof(float), kInputs, file) == kInputs;
+  ok = ok && std::fwrite(output_mean, sizeof(float), kOutputs, file) == kOutputs;
+  ok = ok && std::fwrite(output_std, sizeof(float), kOutputs, file) == kOutputs;
+  for (int l = 0; l < num_layers_ && ok; l++) {
+    ok = std::fwrite(weights_[l].data(), sizeof(float), weights_[l].size(),
+                     file) == weights_[l].size() &&
+         std::fwrite(bias_[l].data(), sizeof(float), bias_[l].size(), file) ==
+             bias_[l].size();
+  }
+  return std::fclose(file) == 0 && ok;
+}
+
+bool MlpSurrogate::Load(const std::string& path) {
+  FILE* file = std::fopen(path.c_str(), "rb");
+  if (!file) return false;
+  MlpFileHeader header;
+  bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+            std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+            header.num_layers >= 1 && header.num_layers <= kMaxLayers &&
+            header.sizes[0] == kInputs &&
+            header.sizes[header.num_layers] == kOutputs;
+  for (uint32_t l = 1; ok && l < header.num_layers; l++) {
+    ok = header.sizes[l] >= 1 && header.sizes[l] <= kMaxWidth;
+  }
+  MlpSurrogate loaded;
+  if (ok) {
+    loaded.num_layers_ = header.num_layers;
+    for (int l = 0; l <= loaded.num_layers_; l++) {
+      loaded.sizes_[l] = header.sizes[l];
+    }
+    loaded.dt_ = header.dt;
+    loaded.model_fingerprint_ = header.model_fingerprint;
+    ok = std::fread(loaded.input_mean, sizeof(float), kInputs, file) == kInputs &&
+         std::fread(loaded.input_std, sizeof(float), kInputs, file) == kInputs &&
+         std::fread(loaded.output_mean, sizeof(float), kOutputs, file) ==
+             kOutputs &&
+         std::fread(loaded.output_std, sizeof(float), kOutputs, file) ==
+             kOutputs;
+  }
+  for (int l = 0; ok && l < loaded.num_layers_; l++) {
+    int nin = loaded.sizes_[l], nout = loaded.sizes_[l + 1];
+    loaded.weights_[l].resize(nin * nout);
+    loaded.bias_[l].resize(nout);
+    ok = std::fread(loaded.weights_[l].data(), sizeof(float), nin * nout,
+                    file) == static_cast<size_t>(nin * nout) &&
+         std::fread(loaded.bias_[l].data(), sizeof(float), nout, file) ==
+             static_cast<size_t>(nout);
+  }
+  // 文件长度必须恰好一致
+  ok = ok && std::fgetc(file) == EOF;
+  std::fclose(file);
+  if (!ok) return false;
+
+  loaded.isa_ = isa_;
+  *this = std::move(loaded);
+  Prepare();
+  return true;
+}
+
+void MlpSurrogate::Forward(const float* inputs, int stride,
+                           float* outputs) const {
+  int width = 0;
+  for (int l = 1; l < num_layers_; l++) width = std::max(width, sizes_[l]);
+  for (std::vector<float>& buffer : buffer_) {
+    if (buffer.size() < static_cast<size_t>(width * stride)) {
+      buffer.resize(width * stride);
+    }
+  }
+
+  const float* in = inputs;
+  for (int l = 0; l < num_layers_; l++) {
+    bool last = l == num_layers_ - 1;
+    float* out = last ? outputs : buffer_[l % 2].data();
+    const float* w = folded_w_[l].data();
+    const float* b = folded_b_[l].data();
+    int nin = sizes_[l], nout = sizes_[l + 1];
+    switch (isa_) {
+#ifdef MJPC_MLP_X86
+      case kAvx512:
+        LayerAvx512(w, b, in, nin, nout, stride, !last, out);
+        break;
+      case kAvx2:
+        LayerAvx2(w, b, in, nin, nout, stride, !last, out);
+        break;
+#endif
+      default:
+        LayerScalar(w, b, in, nin, nout, stride, !last, out);
+        break;
+    }
+    in = out;
+  }
+}
+
+void MlpSurrogate::Step(const float* ctrl, PlanarCarBatch* states) const {
+  int stride = states->stride;
+  size_t size = (kInputs + kOutputs) * stride;
+  if (step_io_.size() < size) step_io_.resize(size);
+  float* in = step_io_.data();
+  float* out = in + kInputs * stride;
+
+  std::copy_n(states->speed.data(), stride, in);
+  std::copy_n(states->yaw_rate.data(), stride, in + stride);
+  std::copy_n(ctrl, 2 * stride, in + 2 * stride);
+  Forward(in, stride, out);
+
+  // 车身系位移按步初朝向旋转到世界系
+  const float* dv = out;
+  const float* dw = out + stride;
+  const float* dheading = out + 2 * stride;
+  const float* dx = out + 3 * stride;
+  const float* dy = out + 4 * stride;
+  for (int s = 0; s < states->size; s++) {
+    float c = std::cos(states->heading[s]);
+    float sn = std::sin(states->heading[s]);
+    states->x[s] += c * dx[s] - sn * dy[s];
+    states->y[s] += sn * dx[s] + c * dy[s];
+    states->heading[s] = WrapAngle(states->heading[s] + dheading[s]);
+    states->speed[s] += dv[s];
+    states->yaw_rate[s] += dw[s];
+  }
+}
+
+void MlpSurrogate::Rollout(const float* ctrl, int steps,
+                           PlanarCarBatch* states,
+                           std::vector<PlanarCarBatch>* trajectory) const {
+  if (trajectory) trajectory->resize(steps);
+  for (int t = 0; t < steps; t++) {
+    Step(ctrl + t * 2 * states->stride, states);
+    if (trajectory) (*trajectory)[t] = *states;
+  }
+}
+
+MlpDataset MakeMlpDataset(const mjModel* model,
+                          const std::vector<CarTrajectory>& trajectories) {
+  MlpDataset dataset;
+  int ctrl_index[2];
+  CarControlIndices(model, ctrl_index);
+  int stride = model->nu + model->nq + model->nv;
+  for (const CarTrajectory& traj : trajectories) {
+    dataset.dt = traj.dt;
+    int num = traj.samples.size() / stride;
+    for (int k = 0; k + 1 < num; k++) {
+      const double* a = traj.samples.data() + k * stride;
+      const double* b = a + stride;
+      PlanarCarState s0 = ExtractPlanarState(a + model->nu,
+                                             a + model->nu + model->nq);
+      PlanarCarState s1 = ExtractPlanarState(b + model->nu,
+                                             b + model->nu + model->nq);
+      double c = std::cos(s0.heading), sn = std::sin(s0.heading);
+      double dx = s1.pos[0] - s0.pos[0], dy = s1.pos[1] - s0.pos[1];
+      float input[MlpSurrogate::kInputs] = {
+          static_cast<float>(s0.speed), static_cast<float>(s0.yaw_rate),
+          static_cast<float>(a[ctrl_index[0]]),
+          static_cast<float>(a[ctrl_index[1]])};
+      float target[MlpSurrogate::kOutputs] = {
+          static_cast<float>(s1.speed - s0.speed),
+          static_cast<float>(s1.yaw_rate - s0.yaw_rate),
+          static_cast<float>(std::remainder(s1.heading - s0.heading,
+                                            2.0 * M_PI)),
+          static_cast<float>(c * dx + sn * dy),
+          static_cast<float>(-sn * dx + c * dy)};
+      dataset.inputs.insert(dataset.inputs.end(), input,
+                            input + MlpSurrogate::kInputs);
+      dataset.targets.insert(dataset.targets.end(), target,
+                             target + MlpSurrogate::kOutputs);
+    }
+  }
+  return dataset;
+}
+
+double TrainMlpSurrogate(const MlpDataset& dataset,
+                         const MlpTrainConfig& config, MlpSurrogate* mlp) {
+  constexpr int kIn = MlpSurrogate::kInputs;
+  constexpr int kOut = MlpSurrogate::kOutputs;
+  int n = dataset.size();
+  if (n == 0 || !mlp->valid()) return 0.0;
+
+  // 归一化
+  auto moments = [n](const std::vector<float>& data, int dim, float* mean,
+                     float* std) {
+    for (int j = 0; j < dim; j++) {
+      double sum = 0.0, sum2 = 0.0;
+      for (int i = 0; i < n; i++) {
+        double v = data[i * dim + j];
+        sum += v;
+        sum2 += v * v;
+      }
+      double m = sum / n;
+      mean[j] = m;
+      std[j] = std::max(std::sqrt(std::max(sum2 / n - m * m, 0.0)), 1e-6);
+    }
+  };
+  moments(dataset.inputs, kIn, mlp->input_mean, mlp->input_std);
+  moments(dataset.targets, kOut, mlp->output_mean, mlp->output_std);
+  mlp->set_dt(dataset.dt);
+
+  int layers = mlp->num_layers();
+  std::vector<std::vector<float>> grad_w(layers), grad_b(layers);
+  std::vector<std::vector<float>> m_w(layers), v_w(layers), m_b(layers),
+      v_b(layers);
+  std::vector<std::vector<float>> act(layers + 1), delta(layers + 1);
+  for (int l = 0; l < layers; l++) {
+    int size = mlp->size(l) * mlp->size(l + 1);
+    grad_w[l].resize(size);
+    m_w[l].assign(size, 0.0f);
+    v_w[l].assign(size, 0.0f);
+    grad_b[l].resize(mlp->size(l + 1));
+    m_b[l].assign(mlp->size(l + 1), 0.0f);
+    v_b[l].assign(mlp->size(l + 1), 0.0f);
+  }
+  for (int l = 0; l <= layers; l++) {
+    act[l].resize(mlp->size(l));
+    delta[l].resize(mlp->size(l));
+  }
+
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937_64 rng(config.seed);
+  int batch = std::max(1, config.batch);
+  const float beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+  int64_t adam_step = 0;
+  double epoch_loss = 0.0;
+
+  for (int epoch = 0; epoch < config.epochs; epoch++) {
+    std::shuffle(order.begin(), order.end(), rng);
+    double lr = config.learning_rate *
+                (0.05 + 0.95 * 0.5 * (1.0 + std::cos(M_PI * epoch /
+                                                      config.epochs)));
+    epoch_loss = 0.0;
+    for (int begin = 0; begin < n; begin += batch) {
+      int end = std::min(begin + batch, n);
+      for (int l = 0; l < layers; l++) {
+        std::fill(grad_w[l].begin(), grad_w[l].end(), 0.0f);
+        std::fill(grad_b[l].begin(), grad_b[l].end(), 0.0f);
+      }
+      float scale = 2.0f / ((end - begin) * kOut);
+
+      for (int k = begin; k < end; k++) {
+        int i = order[k];
+        // 前向（归一化空间，与推理相同的 tanh）
+        for (int j = 0; j < kIn; j++) {
+          act[0][j] = (dataset.inputs[i * kIn + j] - mlp->input_mean[j]) /
+                      mlp->input_std[j];
+        }
+        for (int l = 0; l < layers; l++) {
+          int nin = mlp->size(l), nout = mlp->size(l + 1);
+          const float* w = mlp->weights(l);
+          const float* b = mlp->bias(l);
+          for (int o = 0; o < nout; o++) {
+            float z = b[o];
+            for (int j = 0; j < nin; j++) z += w[o * nin + j] * act[l][j];
+            act[l + 1][o] = l + 1 < layers ? Tanh(z) : z;
+          }
+        }
+        // 反向
+        for (int o = 0; o < kOut; o++) {
+          float target = (dataset.targets[i * kOut + o] - mlp->output_mean[o]) /
+                         mlp->output_std[o];
+          float error = act[layers][o] - target;
+          epoch_loss += error * error;
+          delta[layers][o] = scale * error;
+        }
+        for (int l = layers - 1; l >= 0; l--) {
+          int nin = mlp->size(l), nout = mlp->size(l + 1);
+          const float* w = mlp->weights(l);
+          for (int o = 0; o < nout; o++) {
+            float d = delta[l + 1][o];
+            grad_b[l][o] += d;
+            for (int j = 0; j < nin; j++) grad_w[l][o * nin + j] += d * act[l][j];
+          }
+          if (l == 0) break;
+          for (int j = 0; j < nin; j++) {
+            float sum = 0.0f;
+            for (int o = 0; o < nout; o++) sum += w[o * nin + j] * delta[l + 1][o];
+            delta[l][j] = sum * (1.0f - act[l][j] * act[l][j]);
+          }
+        }
+      }
+
+      // Adam
+      adam_step++;
+      float c1 = 1.0f - std::pow(beta1, adam_step);
+      float c2 = 1.0f - std::pow(beta2, adam_step);
+      auto update = [&](float* param, const std::vector<float>& grad,
+                        std::vector<float>& m, std::vector<float>& v) {
+        for (size_t j = 0; j < grad.size(); j++) {
+          m[j] = beta1 * m[j] + (1.0f - beta1) * grad[j];
+          v[j] = beta2 * v[j] + (1.0f - beta2) * grad[j] * grad[j];
+          param[j] -= lr * (m[j] / c1) / (std::sqrt(v[j] / c2) + eps);
+        }
+      };
+      for (int l = 0; l < layers; l++) {
+        update(mlp->weights(l), grad_w[l], m_w[l], v_w[l]);
+        update(mlp->bias(l), grad_b[l], m_b[l], v_b[l]);
+      }
+    }
+    epoch_loss /= static_cast<double>(n) * kOut;
+  }
+
+  mlp->Prepare();
+  return epoch_loss;
+}
+
+}  // namespace mjpc
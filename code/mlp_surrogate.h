@@ -0,0 +1,152 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_MLP_SURROGATE_H_
+#define MJPC_TASKS_SIMPLE_CAR_MLP_SURROGATE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_sysid.h"
+
+namespace mjpc {
+
+// 权重文件头（128 字节），其后依次为 float32：
+//   输入均值/标准差、输出均值/标准差、每层 W[out][in] 和 b[out]
+struct MlpFileHeader {
+  char magic[8];             // "CARMLP01"
+  uint32_t num_layers;       // 权重层数
+  uint32_t sizes[9];         // 各层宽度，sizes[0] 为输入，sizes[num_layers] 为输出
+  double dt;                 // 每次预测前进的时间（秒）
+  uint64_t model_fingerprint;  // 训练数据所用模型（CarModelFingerprint）
+  uint8_t reserved[128 - 64];
+};
+static_assert(sizeof(MlpFileHeader) == 128, "MlpFileHeader must stay 128 bytes");
+
+// 批量平面状态（SoA，每个数组长度为 stride）
+struct PlanarCarBatch {
+  int size = 0;
+  int stride = 0;  // size 向上取整到 kMlpBatchAlign
+  std::vector<float> x, y, heading, speed, yaw_rate;
+
+  void Resize(int n);
+  void Set(int i, const PlanarCarState& state);
+  PlanarCarState Get(int i) const;
+};
+
+// 批量对齐（AVX-512 每次 16 个、两路展开）
+inline constexpr int kMlpBatchAlign = 32;
+
+// 车辆动力学 MLP 代理模型：输入 (车速, 偏航角速度, ctrl0, ctrl1)，
+//   输出 dt 内的 (车速增量, 角速度增量, 朝向增量, 车身系前向位移, 车身系侧向位移)
+//   位置和朝向不进入网络，平移与旋转不变
+// 隐藏层 tanh（有理逼近，各指令集结果一致到舍入误差），输出层线性；
+//   加载时把输入/输出归一化并入首尾两层
+// 前向按样本批量计算：激活按 [特征][样本] 存放，权重广播后对样本做 FMA，
+//   运行时按 CPU 选择 AVX-512 / AVX2 / 标量实现
+class MlpSurrogate {
+ public:
+  static constexpr int kInputs = 4;
+  static constexpr int kOutputs = 5;
+  static constexpr int kMaxLayers = 8;
+
+  enum Isa : int { kScalar = 0, kAvx2, kAvx512 };
+  static Isa BestIsa();
+  static const char* IsaName(Isa isa);
+
+  // 随机初始化（Xavier），hidden 为各隐藏层宽度
+  void Initialize(const std::vector<int>& hidden, uint64_t seed);
+
+  bool Load(const std::string& path);
+  bool Save(const std::string& path) const;
+  bool valid() const { return num_layers_ > 0; }
+
+  // 指令集（超出 CPU 支持时退回 BestIsa）
+  void set_isa(Isa isa);
+  Isa isa() const { return isa_; }
+
+  double dt() const { return dt_; }
+  void set_dt(double dt) { dt_ = dt; }
+  uint64_t model_fingerprint() const { return model_fingerprint_; }
+  void set_model_fingerprint(uint64_t fingerprint) {
+    model_fingerprint_ = fingerprint;
+  }
+
+  // 批量前向：inputs 为 [kInputs][stride]，outputs 为 [kOutputs][stride]，
+  //   stride 为 kMlpBatchAlign 的倍数
+  void Forward(const float* inputs, int stride, float* outputs) const;
+
+  // 所有样本前进一步；ctrl 为 [2][stride]
+  void Step(const float* ctrl, PlanarCarBatch* states) const;
+
+  // 固定步长 rollout：ctrl 为 [steps][2][stride]，
+  //   trajectory 非空时写入每一步之后的状态
+  void Rollout(const float* ctrl, int steps, PlanarCarBatch* states,
+               std::vector<PlanarCarBatch>* trajectory = nullptr) const;
+
+  // 训练接口：归一化参数与未折叠的权重
+  int num_layers() const { return num_layers_; }
+  int size(int layer) const { return sizes_[layer]; }
+  float* weights(int layer) { return weights_[layer].data(); }
+  float* bias(int layer) { return bias_[layer].data(); }
+  float input_mean[kInputs] = {0}, input_std[kInputs] = {1, 1, 1, 1};
+  float output_mean[kOutputs] = {0}, output_std[kOutputs] = {1, 1, 1, 1, 1};
+
+  // 权重或归一化修改后调用，重新折叠推理用的权重
+  void Prepare();
+
+ private:
+  int num_layers_ = 0;
+  int sizes_[kMaxLayers + 1] = {0};
+  std::vector<float> weights_[kMaxLayers];  // 训练用（归一化空间）
+  std::vector<float> bias_[kMaxLayers];
+  std::vector<float> folded_w_[kMaxLayers];  // 推理用（首尾层并入归一化）
+  std::vector<float> folded_b_[kMaxLayers];
+  double dt_ = 0.0;
+  uint64_t model_fingerprint_ = 0;
+  Isa isa_ = BestIsa();
+
+  // 前向与单步的中间结果（按需扩容；一个实例只在一个线程中使用）
+  mutable std::vector<float> buffer_[2];
+  mutable std::vector<float> step_io_;
+};
+
+// 训练数据：每个转移的网络输入与目标（目标为 MlpSurrogate 的输出定义）
+struct MlpDataset {
+  std::vector<float> inputs;   // [n][kInputs]
+  std::vector<float> targets;  // [n][kOutputs]
+  double dt = 0.0;
+  int size() const { return inputs.size() / MlpSurrogate::kInputs; }
+};
+
+// 从记录/生成的轨迹构造转移（相邻采样点，ctrl 取前一个采样点）
+MlpDataset MakeMlpDataset(const mjModel* model,
+                          const std::vector<CarTrajectory>& trajectories);
+
+struct MlpTrainConfig {
+  int epochs = 100;
+  int batch = 256;
+  double learning_rate = 2e-3;  // Adam，按余弦退火到 5%
+  uint64_t seed = 0;
+};
+
+// 按数据集设置归一化后用小批量 Adam 训练（均方误差，归一化空间），返回最终训练损失
+double TrainMlpSurrogate(const MlpDataset& dataset,
+                         const MlpTrainConfig& config, MlpSurrogate* mlp);
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_MLP_SURROGATE_H_
@@ -0,0 +1,331 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SimpleCar MLP 代理模型
+//   mlp_surrogate --mode=train --out=car_mlp.bin         生成轨迹并训练
+//   mlp_surrogate --mode=train --in=trajectories.txt     用记录的轨迹训练
+//   mlp_surrogate --mode=bench --weights=car_mlp.bin     各指令集单线程吞吐
+//   mlp_surrogate --mode=validate --weights=car_mlp.bin  与 MuJoCo 对比开环误差
+//     （--params=car_params.txt 时同时给出解析代理模型的误差）
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_sysid.h"
+#include "mjpc/tasks/simple_car/mlp_surrogate.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+ABSL_FLAG(std::string, mode, "train", "train, bench or validate");
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(std::string, in, "", "recorded trajectories (empty: generate)");
+ABSL_FLAG(std::string, out, "car_mlp.bin", "weights file written by train");
+ABSL_FLAG(std::string, weights, "car_mlp.bin", "weights file for bench/validate");
+ABSL_FLAG(std::string, params, "", "analytic surrogate to compare (validate)");
+ABSL_FLAG(std::string, hidden, "32,32", "hidden layer widths");
+ABSL_FLAG(int, epochs, 100, "training epochs");
+ABSL_FLAG(int, trajectories, 64, "generated trajectories");
+ABSL_FLAG(double, duration, 5.0, "generated trajectory duration (s)");
+ABSL_FLAG(double, sample_dt, 0.02, "sample interval (s)");
+ABSL_FLAG(int, seed, 0, "random seed");
+ABSL_FLAG(double, horizon, 1.0, "open-loop validation horizon (s)");
+ABSL_FLAG(int, batch, 4096, "bench batch size");
+ABSL_FLAG(int, steps, 50, "bench rollout steps");
+ABSL_FLAG(int, threads, 0, "worker threads (0: hardware concurrency)");
+
+namespace {
+
+std::vector<int> ParseWidths(const std::string& text) {
+  std::vector<int> widths;
+  size_t begin = 0;
+  while (begin < text.size()) {
+    size_t end = text.find(',', begin);
+    if (end == std::string::npos) end = text.size();
+    int width = std::atoi(text.substr(begin, end - begin).c_str());
+    if (width > 0) widths.push_back(width);
+    begin = end + 1;
+  }
+  return widths;
+}
+
+std::vector<mjpc::CarTrajectory> Generate(const mjModel* model, int seed,
+                                          int threads) {
+  mjpc::SysIdGenerateConfig config;
+  config.num_trajectories = absl::GetFlag(FLAGS_trajectories);
+  config.duration = absl::GetFlag(FLAGS_duration);
+  config.sample_dt = absl::GetFlag(FLAGS_sample_dt);
+  config.seed = seed;
+  config.num_threads = threads;
+  return mjpc::GenerateCarTrajectories(model, config);
+}
+
+int Train(const mjModel* model, int threads) {
+  std::vector<mjpc::CarTrajectory> trajectories;
+  std::string in = absl::GetFlag(FLAGS_in);
+  if (!in.empty()) {
+    if (!mjpc::ReadCarTrajectories(in, model, &trajectories)) {
+      std::fprintf(stderr, "could not read trajectories from '%s'\n",
+                   in.c_str());
+      return 1;
+    }
+  } else {
+    trajectories = Generate(model, absl::GetFlag(FLAGS_seed), threads);
+  }
+  mjpc::MlpDataset dataset = mjpc::MakeMlpDataset(model, trajectories);
+  if (dataset.size() == 0) {
+    std::fprintf(stderr, "no transitions\n");
+    return 1;
+  }
+
+  mjpc::MlpSurrogate mlp;
+  mlp.Initialize(ParseWidths(absl::GetFlag(FLAGS_hidden)),
+                 absl::GetFlag(FLAGS_seed));
+  mlp.set_model_fingerprint(mjpc::CarModelFingerprint(model));
+  mjpc::MlpTrainConfig config;
+  config.epochs = absl::GetFlag(FLAGS_epochs);
+  config.seed = absl::GetFlag(FLAGS_seed);
+
+  auto start = std::chrono::steady_clock::now();
+  double loss = mjpc::TrainMlpSurrogate(dataset, config, &mlp);
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+
+  std::string out = absl::GetFlag(FLAGS_out);
+  if (!mlp.Save(out)) {
+    std::fprintf(stderr, "could not write '%s'\n", out.c_str());
+    return 1;
+  }
+  std::printf("%d transitions (dt %.4f s), %d epochs in %.1f s, "
+              "normalized mse %.3e\nwrote %s\n",
+              dataset.size(), dataset.dt, config.epochs, seconds, loss,
+              out.c_str());
+  return 0;
+}
+
+int Bench(const mjpc::MlpSurrogate& weights) {
+  int batch = std::max(1, absl::GetFlag(FLAGS_batch));
+  int steps = std::max(1, absl::GetFlag(FLAGS_steps));
+
+  mjpc::PlanarCarBatch initial;
+  initial.Resize(batch);
+  std::mt19937_64 rng(absl::GetFlag(FLAGS_seed));
+  std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+  for (int i = 0; i < batch; i++) {
+    initial.speed[i] = uniform(rng);
+    initial.yaw_rate[i] = uniform(rng);
+  }
+  std::vector<float> ctrl(steps * 2 * initial.stride);
+  for (float& u : ctrl) u = uniform(rng);
+
+  std::printf("batch %d, %d steps, %d hidden layers, single thread\n", batch,
+              steps, weights.num_layers() - 1);
+  for (int isa = mjpc::MlpSurrogate::kScalar;
+       isa <= mjpc::MlpSurrogate::BestIsa(); isa++) {
+    mjpc::MlpSurrogate mlp = weights;
+    mlp.set_isa(static_cast<mjpc::MlpSurrogate::Isa>(isa));
+    mjpc::PlanarCarBatch states = initial;
+    mlp.Rollout(ctrl.data(), 1, &states);  // 预热并分配缓冲区
+
+    int repeats = 0;
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    do {
+      states = initial;
+      mlp.Rollout(ctrl.data(), steps, &states);
+      repeats++;
+      seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+    } while (seconds < 0.5);
+    double transitions = static_cast<double>(repeats) * steps * batch;
+    std::printf("  %-7s %8.2f M transitions/s  (x %.4f)\n",
+                mjpc::MlpSurrogate::IsaName(mlp.isa()),
+                transitions / seconds * 1e-6, states.x[0]);
+  }
+  return 0;
+}
+
+struct OpenLoopError {
+  double one_step = 0.0;  // 单步位置误差均值（米）
+  double position = 0.0;  // horizon 末端位置误差均值（米）
+  double heading = 0.0;   // horizon 末端朝向误差均值（弧度）
+};
+
+int Validate(const mjModel* model, const mjpc::MlpSurrogate& mlp,
+             int threads) {
+  if (mlp.model_fingerprint() != mjpc::CarModelFingerprint(model)) {
+    std::printf("warning: weights were trained for model %016llx, "
+                "current %016llx; retrain\n",
+                static_cast<unsigned long long>(mlp.model_fingerprint()),
+                static_cast<unsigned long long>(
+                    mjpc::CarModelFingerprint(model)));
+  }
+  mjpc::PlanarCarParams params;
+  std::string params_path = absl::GetFlag(FLAGS_params);
+  bool analytic = !params_path.empty() &&
+                  mjpc::ReadPlanarCarParams(params_path, &params);
+  if (!params_path.empty() && !analytic) {
+    std::fprintf(stderr, "could not read '%s'\n", params_path.c_str());
+  }
+
+  // 与训练不同的随机种子生成新轨迹
+  std::vector<mjpc::CarTrajectory> trajectories =
+      Generate(model, absl::GetFlag(FLAGS_seed) + 1000003, threads);
+  if (trajectories.empty()) return 1;
+  double dt = trajectories[0].dt;
+  if (std::abs(dt - mlp.dt()) > 1e-9) {
+    std::printf("warning: sample dt %.4f differs from trained dt %.4f\n", dt,
+                mlp.dt());
+  }
+  int horizon = std::max(1, static_cast<int>(
+                                std::round(absl::GetFlag(FLAGS_horizon) / dt)));
+
+  // 每条轨迹按 horizon 切成若干窗口，所有窗口作为一个批量 rollout
+  int ctrl_index[2];
+  mjpc::CarControlIndices(model, ctrl_index);
+  int stride = model->nu + model->nq + model->nv;
+  auto state_at = [&](const mjpc::CarTrajectory& traj, int k) {
+    const double* sample = traj.samples.data() + k * stride;
+    return mjpc::ExtractPlanarState(sample + model->nu,
+                                    sample + model->nu + model->nq);
+  };
+  struct Window {
+    const mjpc::CarTrajectory* traj;
+    int begin;
+  };
+  std::vector<Window> windows;
+  for (const mjpc::CarTrajectory& traj : trajectories) {
+    int num = traj.num_samples(model);
+    for (int k = 0; k + horizon < num; k += horizon) windows.push_back({&traj, k});
+  }
+  if (windows.empty()) {
+    std::fprintf(stderr, "trajectories shorter than the horizon\n");
+    return 1;
+  }
+
+  int n = windows.size();
+  mjpc::PlanarCarBatch states;
+  states.Resize(n);
+  std::vector<float> ctrl(horizon * 2 * states.stride, 0.0f);
+  for (int i = 0; i < n; i++) {
+    states.Set(i, state_at(*windows[i].traj, windows[i].begin));
+    for (int t = 0; t < horizon; t++) {
+      const double* sample =
+          windows[i].traj->samples.data() + (windows[i].begin + t) * stride;
+      ctrl[(t * 2 + 0) * states.stride + i] = sample[ctrl_index[0]];
+      ctrl[(t * 2 + 1) * states.stride + i] = sample[ctrl_index[1]];
+    }
+  }
+  std::vector<mjpc::PlanarCarBatch> trajectory;
+  mlp.Rollout(ctrl.data(), horizon, &states, &trajectory);
+
+  auto errors = [&](auto predict) {
+    OpenLoopError error;
+    for (int i = 0; i < n; i++) {
+      mjpc::PlanarCarState first = predict(i, 0);
+      mjpc::PlanarCarState last = predict(i, horizon - 1);
+      mjpc::PlanarCarState true_first =
+          state_at(*windows[i].traj, windows[i].begin + 1);
+      mjpc::PlanarCarState true_last =
+          state_at(*windows[i].traj, windows[i].begin + horizon);
+      error.one_step += std::hypot(first.pos[0] - true_first.pos[0],
+                                   first.pos[1] - true_first.pos[1]);
+      error.position += std::hypot(last.pos[0] - true_last.pos[0],
+                                   last.pos[1] - true_last.pos[1]);
+      error.heading += std::abs(
+          std::remainder(last.heading - true_last.heading, 2.0 * M_PI));
+    }
+    error.one_step /= n;
+    error.position /= n;
+    error.heading /= n;
+    return error;
+  };
+
+  OpenLoopError mlp_error =
+      errors([&](int i, int t) { return trajectory[t].Get(i); });
+  std::printf("%d windows of %.2f s (%d steps)\n", n, horizon * dt, horizon);
+  std::printf("  mlp       one-step %.5f m  horizon position %.4f m  "
+              "heading %.4f rad\n",
+              mlp_error.one_step, mlp_error.position, mlp_error.heading);
+
+  if (analytic) {
+    // 解析代理模型：单步用真实初值，整段开环
+    std::vector<mjpc::PlanarCarState> predicted(n * horizon);
+    for (int i = 0; i < n; i++) {
+      mjpc::PlanarCarState state = state_at(*windows[i].traj, windows[i].begin);
+      for (int t = 0; t < horizon; t++) {
+        const double* sample =
+            windows[i].traj->samples.data() + (windows[i].begin + t) * stride;
+        double u[2] = {sample[ctrl_index[0]], sample[ctrl_index[1]]};
+        mjpc::PlanarCarStep(params, u, dt, &state);
+        predicted[i * horizon + t] = state;
+      }
+    }
+    OpenLoopError analytic_error = errors(
+        [&](int i, int t) { return predicted[i * horizon + t]; });
+    std::printf("  analytic  one-step %.5f m  horizon position %.4f m  "
+                "heading %.4f rad\n",
+                analytic_error.one_step, analytic_error.position,
+                analytic_error.heading);
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+
+  int threads = absl::GetFlag(FLAGS_threads);
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::string mode = absl::GetFlag(FLAGS_mode);
+  int status = 1;
+  if (mode == "train") {
+    status = Train(model, threads);
+  } else if (mode == "bench" || mode == "validate") {
+    mjpc::MlpSurrogate mlp;
+    std::string weights = absl::GetFlag(FLAGS_weights);
+    if (!mlp.Load(weights)) {
+      std::fprintf(stderr, "could not load '%s'\n", weights.c_str());
+    } else {
+      status = mode == "bench" ? Bench(mlp) : Validate(model, mlp, threads);
+    }
+  } else {
+    std::fprintf(stderr, "unknown mode '%s'\n", mode.c_str());
+  }
+
+  mj_deleteModel(model);
+  return status;
+}
@@ -0,0 +1,107 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/mlp_surrogate.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace mjpc {
+namespace {
+
+// 批量大小取非对齐值，覆盖尾部填充
+constexpr int kBatch = 45;
+
+MlpSurrogate MakeSurrogate(MlpSurrogate::Isa isa) {
+  MlpSurrogate mlp;
+  mlp.Initialize({32, 32}, 7);
+  mlp.set_dt(0.02);
+  mlp.set_isa(isa);
+  return mlp;
+}
+
+TEST(MlpSurrogateTest, ForwardMatchesScalar) {
+  int stride = (kBatch + kMlpBatchAlign - 1) / kMlpBatchAlign * kMlpBatchAlign;
+  std::vector<float> inputs(MlpSurrogate::kInputs * stride, 0.0f);
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  for (int f = 0; f < MlpSurrogate::kInputs; f++) {
+    for (int i = 0; i < kBatch; i++) inputs[f * stride + i] = 2.0f * unit(rng);
+  }
+
+  MlpSurrogate scalar = MakeSurrogate(MlpSurrogate::kScalar);
+  std::vector<float> expected(MlpSurrogate::kOutputs * stride);
+  scalar.Forward(inputs.data(), stride, expected.data());
+
+  // 只比较当前 CPU 支持的指令集
+  for (int isa = MlpSurrogate::kAvx2; isa <= MlpSurrogate::BestIsa(); isa++) {
+    MlpSurrogate mlp = MakeSurrogate(static_cast<MlpSurrogate::Isa>(isa));
+    ASSERT_EQ(mlp.isa(), isa);
+    std::vector<float> outputs(MlpSurrogate::kOutputs * stride);
+    mlp.Forward(inputs.data(), stride, outputs.data());
+    for (int f = 0; f < MlpSurrogate::kOutputs; f++) {
+      for (int i = 0; i < kBatch; i++) {
+        float a = expected[f * stride + i], b = outputs[f * stride + i];
+        EXPECT_NEAR(a, b, 1e-5f * (1.0f + std::abs(a)))
+            << MlpSurrogate::IsaName(mlp.isa()) << " output " << f
+            << " sample " << i;
+      }
+    }
+  }
+}
+
+TEST(MlpSurrogateTest, RolloutMatchesScalar) {
+  constexpr int kSteps = 20;
+  PlanarCarBatch start;
+  start.Resize(kBatch);
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  for (int i = 0; i < kBatch; i++) {
+    PlanarCarState state;
+    state.heading = 3.0 * unit(rng);
+    state.speed = unit(rng);
+    state.yaw_rate = unit(rng);
+    start.Set(i, state);
+  }
+  std::vector<float> ctrl(kSteps * 2 * start.stride, 0.0f);
+  for (int t = 0; t < kSteps; t++) {
+    for (int i = 0; i < 2 * start.stride; i++) {
+      if (i % start.stride < kBatch) ctrl[t * 2 * start.stride + i] = unit(rng);
+    }
+  }
+
+  PlanarCarBatch expected = start;
+  MakeSurrogate(MlpSurrogate::kScalar).Rollout(ctrl.data(), kSteps, &expected);
+  for (int isa = MlpSurrogate::kAvx2; isa <= MlpSurrogate::BestIsa(); isa++) {
+    PlanarCarBatch states = start;
+    MakeSurrogate(static_cast<MlpSurrogate::Isa>(isa))
+        .Rollout(ctrl.data(), kSteps, &states);
+    for (int i = 0; i < kBatch; i++) {
+      // 误差随步数累积，容差按步数放宽
+      EXPECT_NEAR(expected.x[i], states.x[i], 1e-4f);
+      EXPECT_NEAR(expected.y[i], states.y[i], 1e-4f);
+      EXPECT_NEAR(std::remainder(expected.heading[i] - states.heading[i],
+                                 2.0f * static_cast<float>(M_PI)),
+                  0.0f, 1e-4f);
+      EXPECT_NEAR(expected.speed[i], states.speed[i], 1e-4f);
+      EXPECT_NEAR(expected.yaw_rate[i], states.yaw_rate[i], 1e-4f);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mjpc
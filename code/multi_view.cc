@@ -0,0 +1,142 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/multi_view.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+void MultiView::Initialize(int maxgeom) {
+  maxgeom = std::max(maxgeom, 1);
+  tags_.clear();
+  tags_.reserve(maxgeom);
+  sorted_.resize(maxgeom);
+  view_.resize(maxgeom);
+  ResetStats();
+}
+
+int MultiView::Bucket(int tag) {
+  switch (tag) {
+    case kViewStatic:
+      return 0;
+    case kViewDynamic:
+      return 1;
+    case kViewDashboard:
+      return 3;
+    default:
+      return 2;
+  }
+}
+
+void MultiView::Tag(const mjvScene* scene) {
+  tags_.resize(scene->ngeom);
+  for (int i = 0; i < scene->ngeom; i++) {
+    int category = scene->geoms[i].category;
+    tags_[i] = (category == mjCAT_STATIC || category == mjCAT_DYNAMIC)
+                   ? category
+                   : kViewDecor;
+  }
+}
+
+void MultiView::TagRange(int begin, int end, int tag) {
+  begin = std::max(begin, 0);
+  end = std::min(end, static_cast<int>(tags_.size()));
+  for (int i = begin; i < end; i++) tags_[i] = tag;
+}
+
+void MultiView::Render(const mjModel* model, const mjData* data,
+                       std::vector<ViewportSpec>* views, mjvScene* scene,
+                       const mjrContext* context) {
+  mjvGeom* geoms = scene->geoms;
+  int ngeom = scene->ngeom;
+  if (static_cast<int>(tags_.size()) != ngeom) Tag(scene);
+  if (static_cast<int>(sorted_.size()) < ngeom) {
+    sorted_.resize(ngeom);
+    view_.resize(ngeom);
+  }
+
+  // 按标签计数排序（稳定，同一桶内保持原顺序）
+  int count[kNumBuckets] = {0};
+  for (int i = 0; i < ngeom; i++) count[Bucket(tags_[i])]++;
+  bucket_begin_[0] = 0;
+  for (int b = 0; b < kNumBuckets; b++) {
+    bucket_begin_[b + 1] = bucket_begin_[b] + count[b];
+  }
+  int next[kNumBuckets];
+  std::copy(bucket_begin_, bucket_begin_ + kNumBuckets, next);
+  for (int i = 0; i < ngeom; i++) {
+    sorted_[next[Bucket(tags_[i])]++] = geoms[i];
+  }
+  stats_.frames++;
+  stats_.geoms_shared += ngeom;
+
+  const int bucket_tag[kNumBuckets] = {kViewStatic, kViewDynamic, kViewDecor,
+                                       kViewDashboard};
+  for (ViewportSpec& view : *views) {
+    if (view.rect.width <= 0 || view.rect.height <= 0) continue;
+
+    // 选中的非空桶在排序后是否连续（中间没有未选中的非空桶）
+    int first = -1, last = -1;
+    for (int b = 0; b < kNumBuckets; b++) {
+      if (count[b] == 0 || !(view.mask & bucket_tag[b])) continue;
+      if (first < 0) first = b;
+      last = b;
+    }
+    bool contiguous = true;
+    for (int b = first + 1; b < last; b++) {
+      if (count[b] > 0 && !(view.mask & bucket_tag[b])) contiguous = false;
+    }
+
+    if (first < 0) {
+      scene->geoms = sorted_.data();
+      scene->ngeom = 0;
+      stats_.zero_copy_views++;
+    } else if (contiguous) {
+      scene->geoms = sorted_.data() + bucket_begin_[first];
+      scene->ngeom = bucket_begin_[last + 1] - bucket_begin_[first];
+      stats_.zero_copy_views++;
+    } else {
+      int n = 0;
+      for (int b = first; b <= last; b++) {
+        if (!(view.mask & bucket_tag[b])) continue;
+        std::copy(sorted_.begin() + bucket_begin_[b],
+                  sorted_.begin() + bucket_begin_[b + 1], view_.begin() + n);
+        n += count[b];
+      }
+      scene->geoms = view_.data();
+      scene->ngeom = n;
+      stats_.geoms_copied += n;
+    }
+
+    // 只更新相机与灯光（头灯跟随相机），geom 不重建
+    mjv_makeLights(model, data, scene);
+    if (view.fixed_camera) {
+      scene->camera[0] = view.gl_camera;
+      scene->camera[1] = view.gl_camera;
+    } else {
+      mjv_updateCamera(model, data, &view.camera, scene);
+    }
+    mjr_render(view.rect, scene, context);
+    stats_.views++;
+  }
+
+  scene->geoms = geoms;
+  scene->ngeom = ngeom;
+}
+
+}  // namespace mjpc
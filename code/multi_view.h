@@ -0,0 +1,90 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_MULTI_VIEW_H_
+#define MJPC_TASKS_SIMPLE_CAR_MULTI_VIEW_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// geom 标签：每个 geom 恰好一个标签，视口按标签掩码选择
+//   前三个与 mjtCatBit 一致，仪表盘 geom 单独标记
+enum ViewTag : int {
+  kViewStatic = mjCAT_STATIC,
+  kViewDynamic = mjCAT_DYNAMIC,
+  kViewDecor = mjCAT_DECOR,
+  kViewDashboard = 8,
+  kViewAll = 15,
+};
+
+// 一个视口：像素矩形、相机和可见标签
+struct ViewportSpec {
+  mjrRect rect = {0, 0, 0, 0};
+  mjvCamera camera;              // fixed_camera 为 false 时由 mjv_updateCamera 使用
+  bool fixed_camera = false;     // true 时直接使用 gl_camera（例如仪表盘视图）
+  mjvGLCamera gl_camera;
+  int mask = kViewAll;
+};
+
+struct MultiViewStats {
+  uint64_t frames = 0;
+  uint64_t views = 0;
+  uint64_t zero_copy_views = 0;  // 选中的标签在排序后连续，直接指向共享列表
+  uint64_t geoms_shared = 0;     // 共享 geom 列表的累计大小
+  uint64_t geoms_copied = 0;     // 标签不连续时复制到视口列表的 geom 数
+};
+
+// 多视口渲染：每帧只做一次 mjv_updateScene + ModifyScene，
+//   geom 列表按标签排序一次，每个视口只更新相机（mjv_updateCamera）、
+//   灯光（mjv_makeLights）并选出自己的 geom 后调用 mjr_render
+// 桶顺序为 静态 | 动态 | 装饰 | 仪表盘，常用掩码（全部、去掉仪表盘、只有仪表盘）
+//   都是连续区间，不需要复制
+// 所有函数都需要在持有 GL 上下文的渲染线程中调用
+class MultiView {
+ public:
+  // maxgeom 与共享场景的 maxgeom 一致（预先分配，渲染时不再分配内存）
+  void Initialize(int maxgeom);
+
+  // 共享场景构建之后调用：按 category 设置标签
+  void Tag(const mjvScene* scene);
+
+  // 把 [begin, end) 中的 geom 改为 tag（例如 ModifyScene 记录的仪表盘区间）
+  void TagRange(int begin, int end, int tag);
+
+  // 依次渲染每个视口（跟踪相机的状态写回 views）；返回后场景的 geom 列表不变
+  void Render(const mjModel* model, const mjData* data,
+              std::vector<ViewportSpec>* views, mjvScene* scene,
+              const mjrContext* context);
+
+  const MultiViewStats& stats() const { return stats_; }
+  void ResetStats() { stats_ = MultiViewStats(); }
+
+ private:
+  static constexpr int kNumBuckets = 4;
+  static int Bucket(int tag);
+
+  std::vector<int> tags_;
+  std::vector<mjvGeom> sorted_;  // 按标签排序后的共享列表
+  std::vector<mjvGeom> view_;    // 标签不连续的视口
+  int bucket_begin_[kNumBuckets + 1] = {0};
+  MultiViewStats stats_;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_MULTI_VIEW_H_
@@ -0,0 +1,255 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 多视口渲染对比（隐藏窗口 + offscreen 渲染，可在软件 GL 下运行）
+//   multi_view --frames=600 --out=frame
+//   无显示器的 CI：xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 multi_view
+// 三个视口：跟随车辆的追尾视角（左）、俯视图（右下）、仪表盘（右上）
+// 对比每个视口各自 mjv_updateScene + ModifyScene（rebuild）与
+//   每帧共用一次场景更新（shared，MultiView），报告帧耗时与构建的 geom 数；
+//   两种方式按轮交替先后（偶数轮 rebuild 在前，奇数轮 shared 在前），各轮合并统计；
+//   --out 非空时把两种方式的最后一帧写成 PPM
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <GLFW/glfw3.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/dashboard_panel.h"
+#include "mjpc/tasks/simple_car/gauge_faces.h"
+#include "mjpc/tasks/simple_car/multi_view.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(int, frames, 600, "frames per mode and round");
+ABSL_FLAG(int, rounds, 2, "rounds, alternating which mode runs first");
+ABSL_FLAG(double, fps, 60.0, "simulated frame rate");
+ABSL_FLAG(int, width, 1280, "frame width (clamped to offscreen size)");
+ABSL_FLAG(int, height, 720, "frame height (clamped to offscreen size)");
+ABSL_FLAG(std::string, out, "", "write <out>_rebuild.ppm / <out>_shared.ppm");
+
+namespace {
+
+struct ModeResult {
+  double seconds = 0.0;
+  long long geoms_built = 0;  // mjv_updateScene + ModifyScene 生成的 geom
+  int frames = 0;
+};
+
+bool WritePpm(const std::string& path, const std::vector<unsigned char>& rgb,
+              int width, int height) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) return false;
+  std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+  // OpenGL 行序自下而上
+  for (int row = height - 1; row >= 0; row--) {
+    std::fwrite(rgb.data() + 3 * width * row, 1, 3 * width, file);
+  }
+  std::fclose(file);
+  return true;
+}
+
+// 左半边追尾视角，右半边上方仪表盘、下方俯视图
+std::vector<mjpc::ViewportSpec> MakeViews(const mjModel* model, mjrRect frame) {
+  std::vector<mjpc::ViewportSpec> views(3);
+  int half = frame.width / 2;
+  const mjpc::DashboardRegion& region = mjpc::kDashboardRegion;
+  int dash_height = std::min(
+      frame.height / 2,
+      static_cast<int>((frame.width - half) * region.half[1] / region.half[0]));
+
+  mjpc::ViewportSpec& chase = views[0];
+  chase.rect = {frame.left, frame.bottom, half, frame.height};
+  mjv_defaultCamera(&chase.camera);
+  int car = mj_name2id(model, mjOBJ_BODY, "car");
+  if (car >= 0) {
+    chase.camera.type = mjCAMERA_TRACKING;
+    chase.camera.trackbodyid = car;
+  }
+  chase.camera.distance = 3.0;
+  chase.camera.elevation = -20.0;
+  chase.mask = mjpc::kViewAll & ~mjpc::kViewDashboard;
+
+  mjpc::ViewportSpec& top = views[1];
+  top.rect = {frame.left + half, frame.bottom, frame.width - half,
+              frame.height - dash_height};
+  mjv_defaultCamera(&top.camera);
+  top.camera.distance = 14.0;
+  top.camera.elevation = -90.0;
+  top.camera.azimuth = 90.0;
+  top.mask = mjpc::kViewAll & ~mjpc::kViewDashboard;
+
+  mjpc::ViewportSpec& dash = views[2];
+  dash.rect = {frame.left + half, frame.bottom + frame.height - dash_height,
+               frame.width - half, dash_height};
+  dash.fixed_camera = true;
+  mjpc::DashboardCamera(&dash.gl_camera);
+  dash.mask = mjpc::kViewDashboard;
+  return views;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+  mjData* data = mj_makeData(model);
+
+  if (!glfwInit()) {
+    std::fprintf(stderr, "could not initialize GLFW\n");
+    return 1;
+  }
+  glfwWindowHint(GLFW_VISIBLE, 0);
+  GLFWwindow* window =
+      glfwCreateWindow(800, 600, "multi_view", nullptr, nullptr);
+  if (!window) {
+    std::fprintf(stderr, "could not create GL context\n");
+    glfwTerminate();
+    return 1;
+  }
+  glfwMakeContextCurrent(window);
+
+  mjrContext context;
+  mjr_defaultContext(&context);
+  mjr_makeContext(model, &context, mjFONTSCALE_150);
+
+  const int maxgeom = 2000;
+  mjvScene scene;
+  mjvOption option;
+  mjvPerturb perturb;
+  mjv_defaultScene(&scene);
+  mjv_makeScene(model, &scene, maxgeom);
+  mjv_defaultOption(&option);
+  mjv_defaultPerturb(&perturb);
+
+  mjrRect frame = {0, 0,
+                   std::min(absl::GetFlag(FLAGS_width), context.offWidth),
+                   std::min(absl::GetFlag(FLAGS_height), context.offHeight)};
+  std::vector<unsigned char> rgb(3 * frame.width * frame.height);
+
+  mjpc::MultiView multi_view;
+  multi_view.Initialize(maxgeom);
+
+  int frames = std::max(1, absl::GetFlag(FLAGS_frames));
+  int steps = std::max(1, static_cast<int>(std::round(
+                              1.0 / (absl::GetFlag(FLAGS_fps) *
+                                     model->opt.timestep))));
+  std::string out = absl::GetFlag(FLAGS_out);
+
+  ModeResult results[2];
+  const char* names[2] = {"rebuild", "shared"};
+  int rounds = std::max(1, absl::GetFlag(FLAGS_rounds));
+  multi_view.ResetStats();  // 只有 shared 方式累计，各轮合并
+  for (int run = 0; run < 2 * rounds; run++) {
+    int round = run / 2;
+    int mode = (run % 2) ^ (round % 2);
+    bool shared = mode == 1;
+    mj_resetData(model, data);
+    task.Reset(model);
+    // 共用一次 ModifyScene 时按单个相机剔除会丢掉其他视口需要的 geom
+    task.set_view_culling(!shared);
+    std::vector<mjpc::ViewportSpec> views = MakeViews(model, frame);
+    mjr_setBuffer(mjFB_OFFSCREEN, &context);
+
+    double seconds = 0.0;
+    long long built = 0;
+    for (int f = 0; f < frames; f++) {
+      // 固定的加速/转向曲线，让车辆持续运动
+      double t = data->time;
+      data->ctrl[0] = std::sin(0.5 * t);
+      data->ctrl[1] = 0.5 * std::sin(0.2 * t);
+      for (int i = 0; i < steps; i++) mj_step(model, data);
+      task.Transition(model, data);
+      task.UploadGaugeFaces(model, &context);
+
+      auto start = std::chrono::steady_clock::now();
+      mjr_rectangle(frame, 0.0f, 0.0f, 0.0f, 1.0f);
+      if (shared) {
+        mjv_updateScene(model, data, &option, &perturb, &views[0].camera,
+                        mjCAT_ALL, &scene);
+        task.ModifyScene(model, data, &scene);
+        built += scene.ngeom;
+        multi_view.Tag(&scene);
+        multi_view.TagRange(task.dashboard_geom_begin(),
+                            task.dashboard_geom_end(), mjpc::kViewDashboard);
+        multi_view.Render(model, data, &views, &scene, &context);
+      } else {
+        for (mjpc::ViewportSpec& view : views) {
+          mjv_updateScene(model, data, &option, &perturb, &view.camera,
+                          view.mask & mjCAT_ALL, &scene);
+          if (view.fixed_camera) {
+            scene.camera[0] = view.gl_camera;
+            scene.camera[1] = view.gl_camera;
+          }
+          task.ModifyScene(model, data, &scene);
+          built += scene.ngeom;
+          mjr_render(view.rect, &scene, &context);
+        }
+      }
+      mjr_finish();
+      seconds += std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start).count();
+    }
+    results[mode].seconds += seconds;
+    results[mode].geoms_built += built;
+    results[mode].frames += frames;
+
+    if (!out.empty()) {
+      mjr_readPixels(rgb.data(), nullptr, frame, &context);
+      std::string path = out + "_" + names[mode] + ".ppm";
+      if (!WritePpm(path, rgb, frame.width, frame.height)) {
+        std::fprintf(stderr, "could not write '%s'\n", path.c_str());
+      }
+    }
+  }
+
+  std::printf("%d frames x %d rounds at %dx%d, 3 viewports\n", frames, rounds,
+              frame.width, frame.height);
+  std::printf("  %-8s %12s %14s\n", "mode", "ms/frame", "geoms built");
+  for (int mode = 0; mode < 2; mode++) {
+    const ModeResult& result = results[mode];
+    std::printf("  %-8s %12.3f %14.1f\n", names[mode],
+                1e3 * result.seconds / result.frames,
+                static_cast<double>(result.geoms_built) / result.frames);
+  }
+  const mjpc::MultiViewStats& stats = multi_view.stats();
+  std::printf("  shared: %llu views, %llu zero-copy, %llu geoms copied\n",
+              static_cast<unsigned long long>(stats.views),
+              static_cast<unsigned long long>(stats.zero_copy_views),
+              static_cast<unsigned long long>(stats.geoms_copied));
+
+  mjv_freeScene(&scene);
+  mjr_freeContext(&context);
+  glfwDestroyWindow(window);
+  glfwTerminate();
+  mj_deleteData(data);
+  mj_deleteModel(model);
+  return 0;
+}
@@ -0,0 +1,166 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/obstacles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <absl/random/random.h>
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+namespace {
+
+// 空位障碍物放置的位置（远离场地）
+constexpr double kFarAway = 1.0e6;
+
+// 随机运动的场地边界（与地面 size 一致）
+constexpr double kArenaHalfSize = 2.8;
+
+// 随机运动换向间隔（秒）
+constexpr double kMinTurnInterval = 1.0;
+constexpr double kMaxTurnInterval = 4.0;
+
+}  // namespace
+
+// ============ ObstacleSet ============
+void ObstacleSet::Clear() {
+  count = 0;
+  time = 0.0;
+  for (int i = 0; i < kMaxObstacles; i++) {
+    x[i] = kFarAway;
+    y[i] = kFarAway;
+    vx[i] = 0.0;
+    vy[i] = 0.0;
+    radius[i] = 0.0;
+  }
+}
+
+double ObstacleSet::MinClearance(double px, double py, double t) const {
+  double dt = t - time;
+
+  // 各障碍物净空（无分支，可向量化）
+  double clearance[kMaxObstacles];
+  for (int i = 0; i < kMaxObstacles; i++) {
+    double dx = px - (x[i] + vx[i] * dt);
+    double dy = py - (y[i] + vy[i] * dt);
+    clearance[i] = std::sqrt(dx * dx + dy * dy) - radius[i];
+  }
+
+  double min_clearance = clearance[0];
+  for (int i = 1; i < kMaxObstacles; i++) {
+    min_clearance = std::min(min_clearance, clearance[i]);
+  }
+  return min_clearance;
+}
+
+// ============ ObstacleScript ============
+void ObstacleScript::Initialize(const mjModel* model, const mjData* data,
+                                int motion, double speed, uint64_t seed) {
+  count_ = 0;
+  motion_ = motion;
+  speed_ = speed;
+  last_time_ = data->time;
+  if (seed != 0) {
+    std::seed_seq seq{seed};
+    gen_ = absl::BitGen(seq);
+  }
+
+  for (int i = 0; i < kMaxObstacles; i++) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "obstacle_%d", i);
+    int body = mj_name2id(model, mjOBJ_BODY, name);
+    if (body < 0 || model->body_mocapid[body] < 0) break;
+
+    int k = count_++;
+    mocap_id_[k] = model->body_mocapid[body];
+    radius_[k] = model->body_geomnum[body] > 0
+                     ? model->geom_size[3 * model->body_geomadr[body]]
+                     : 0.1;
+    pos_[k][0] = data->mocap_pos[3 * mocap_id_[k] + 0];
+    pos_[k][1] = data->mocap_pos[3 * mocap_id_[k] + 1];
+
+    // 圆周运动：以初始位置确定半径和相位，相邻障碍物反向旋转
+    orbit_radius_[k] = std::max(0.1, std::hypot(pos_[k][0], pos_[k][1]));
+    phase_[k] = std::atan2(pos_[k][1], pos_[k][0]) -
+                (k % 2 ? -1.0 : 1.0) * speed_ / orbit_radius_[k] * data->time;
+
+    // 随机运动：随机初始方向
+    double heading = absl::Uniform<double>(gen_, -mjPI, mjPI);
+    vel_[k][0] = speed_ * std::cos(heading);
+    vel_[k][1] = speed_ * std::sin(heading);
+    next_turn_[k] = data->time + absl::Uniform<double>(
+                                     gen_, kMinTurnInterval, kMaxTurnInterval);
+  }
+}
+
+void ObstacleScript::Update(mjData* data, ObstacleSet* snapshot) {
+  double t = data->time;
+  double dt = t > last_time_ ? t - last_time_ : 0.0;
+  last_time_ = t;
+
+  for (int k = 0; k < count_; k++) {
+    if (motion_ == kCircle) {
+      double direction = k % 2 ? -1.0 : 1.0;
+      double omega = direction * speed_ / orbit_radius_[k];
+      double angle = phase_[k] + omega * t;
+      pos_[k][0] = orbit_radius_[k] * std::cos(angle);
+      pos_[k][1] = orbit_radius_[k] * std::sin(angle);
+      vel_[k][0] = -orbit_radius_[k] * omega * std::sin(angle);
+      vel_[k][1] = orbit_radius_[k] * omega * std::cos(angle);
+    } else {
+      // 定期随机换向
+      if (t >= next_turn_[k]) {
+        double heading = absl::Uniform<double>(gen_, -mjPI, mjPI);
+        vel_[k][0] = speed_ * std::cos(heading);
+        vel_[k][1] = speed_ * std::sin(heading);
+        next_turn_[k] = t + absl::Uniform<double>(gen_, kMinTurnInterval,
+                                                  kMaxTurnInterval);
+      }
+      for (int j = 0; j < 2; j++) {
+        pos_[k][j] += vel_[k][j] * dt;
+        // 碰到场地边界反弹
+        double limit = kArenaHalfSize - radius_[k];
+        if (pos_[k][j] > limit) {
+          pos_[k][j] = 2.0 * limit - pos_[k][j];
+          vel_[k][j] = -std::abs(vel_[k][j]);
+        } else if (pos_[k][j] < -limit) {
+          pos_[k][j] = -2.0 * limit - pos_[k][j];
+          vel_[k][j] = std::abs(vel_[k][j]);
+        }
+      }
+    }
+
+    data->mocap_pos[3 * mocap_id_[k] + 0] = pos_[k][0];
+    data->mocap_pos[3 * mocap_id_[k] + 1] = pos_[k][1];
+  }
+
+  // 快照
+  snapshot->Clear();
+  snapshot->count = count_;
+  snapshot->time = t;
+  for (int k = 0; k < count_; k++) {
+    snapshot->x[k] = pos_[k][0];
+    snapshot->y[k] = pos_[k][1];
+    snapshot->vx[k] = vel_[k][0];
+    snapshot->vy[k] = vel_[k][1];
+    snapshot->radius[k] = radius_[k];
+  }
+}
+
+}  // namespace mjpc
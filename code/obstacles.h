@@ -0,0 +1,83 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_OBSTACLES_H_
+#define MJPC_TASKS_SIMPLE_CAR_OBSTACLES_H_
+
+#include <absl/random/random.h>
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 障碍物数量上限（数组按此长度定长，空位放在远处）
+inline constexpr int kMaxObstacles = 8;
+
+// 障碍物状态快照（SoA）
+//   预测采用匀速外推：p(t) = p0 + v * (t - time)，rollout 中不仿真障碍物
+struct ObstacleSet {
+  int count = 0;
+  double time = 0.0;  // 快照时刻
+
+  alignas(64) double x[kMaxObstacles];
+  alignas(64) double y[kMaxObstacles];
+  alignas(64) double vx[kMaxObstacles];
+  alignas(64) double vy[kMaxObstacles];
+  alignas(64) double radius[kMaxObstacles];
+
+  ObstacleSet() { Clear(); }
+  void Clear();
+
+  // 时刻 t 时点 (px, py) 到所有障碍物边缘的最小距离
+  //   循环固定跑满 kMaxObstacles，便于编译器向量化
+  double MinClearance(double px, double py, double t) const;
+};
+
+// 障碍物运动脚本（驱动 mocap 体）
+//   kCircle：绕原点匀速圆周运动；kRandom：在场地内匀速直线运动、碰边反弹、定期随机换向
+class ObstacleScript {
+ public:
+  enum Motion : int { kCircle = 0, kRandom = 1 };
+
+  // 从模型中查找名为 obstacle_0、obstacle_1 ... 的 mocap 体
+  void Initialize(const mjModel* model, const mjData* data, int motion,
+                  double speed, uint64_t seed);
+
+  // 推进到 data->time，写 mocap_pos，并把快照写入 snapshot
+  void Update(mjData* data, ObstacleSet* snapshot);
+
+  int count() const { return count_; }
+
+ private:
+  int count_ = 0;
+  int motion_ = kCircle;
+  double speed_ = 0.3;
+  double last_time_ = 0.0;
+
+  int mocap_id_[kMaxObstacles];
+  double radius_[kMaxObstacles];
+  double pos_[kMaxObstacles][2];
+  double vel_[kMaxObstacles][2];
+
+  // 圆周运动参数
+  double orbit_radius_[kMaxObstacles];
+  double phase_[kMaxObstacles];
+
+  // 随机运动：下一次换向时刻
+  double next_turn_[kMaxObstacles];
+  absl::BitGen gen_;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_OBSTACLES_H_
@@ -0,0 +1,412 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/param_reload.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/task.h"
+
+namespace mjpc {
+
+namespace {
+
+bool StartsWith(std::string_view text, std::string_view prefix) {
+  return text.substr(0, prefix.size()) == prefix;
+}
+
+// 去掉 <!-- ... --> 注释（被注释掉的 numeric 不参与比较）
+std::string StripComments(const std::string& xml) {
+  std::string out;
+  out.reserve(xml.size());
+  size_t pos = 0;
+  while (pos < xml.size()) {
+    size_t begin = xml.find("<!--", pos);
+    if (begin == std::string::npos) {
+      out.append(xml, pos, std::string::npos);
+      break;
+    }
+    out.append(xml, pos, begin - pos);
+    size_t end = xml.find("-->", begin + 4);
+    if (end == std::string::npos) break;
+    pos = end + 3;
+  }
+  return out;
+}
+
+// 在标签文本中查找属性值 [begin, end)，找不到时返回 false
+bool FindAttribute(std::string_view tag, std::string_view name, size_t* begin,
+                   size_t* end) {
+  size_t pos = 0;
+  while ((pos = tag.find(name, pos)) != std::string_view::npos) {
+    bool separated = pos > 0 && std::isspace(static_cast<unsigned char>(
+                                    tag[pos - 1]));
+    size_t eq = pos + name.size();
+    while (eq < tag.size() && std::isspace(static_cast<unsigned char>(tag[eq])))
+      eq++;
+    if (separated && eq < tag.size() && tag[eq] == '=') {
+      size_t quote = eq + 1;
+      while (quote < tag.size() &&
+             std::isspace(static_cast<unsigned char>(tag[quote])))
+        quote++;
+      if (quote >= tag.size() || (tag[quote] != '"' && tag[quote] != '\''))
+        return false;
+      size_t close = tag.find(tag[quote], quote + 1);
+      if (close == std::string_view::npos) return false;
+      *begin = quote + 1;
+      *end = close;
+      return true;
+    }
+    pos += name.size();
+  }
+  return false;
+}
+
+bool ParseValues(std::string_view text, std::vector<double>* values) {
+  std::string buffer(text);
+  const char* p = buffer.c_str();
+  values->clear();
+  while (true) {
+    while (std::isspace(static_cast<unsigned char>(*p))) p++;
+    if (*p == '\0') return true;
+    char* next = nullptr;
+    double value = std::strtod(p, &next);
+    if (next == p) return false;
+    values->push_back(value);
+    p = next;
+  }
+}
+
+// 是否为给定名称的元素标签（"<numeric" 之后须为空白或结束）
+bool IsElement(std::string_view tag, std::string_view element) {
+  if (!StartsWith(tag, element)) return false;
+  char next = tag.size() > element.size() ? tag[element.size()] : '>';
+  return std::isspace(static_cast<unsigned char>(next)) || next == '/' ||
+         next == '>';
+}
+
+std::string Directory(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+bool ReadText(const std::string& path, std::string* text) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  *text = buffer.str();
+  return true;
+}
+
+bool ModifiedTime(const std::string& path, timespec* mtime) {
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) return false;
+  *mtime = info.st_mtim;
+  return true;
+}
+
+const std::vector<double>* FindEntry(
+    const std::vector<ParamSnapshot::Entry>& entries, const std::string& name) {
+  for (const auto& entry : entries) {
+    if (entry.first == name) return &entry.second;
+  }
+  return nullptr;
+}
+
+// 规划器只在分配时读取的设置：mjpc agent 的 agent_* / sampling_* / gradient_* /
+//   estimator*，以及 CarMppiPlanner 的 mppi_* / rollout_grid_*
+bool IsPlannerSetting(std::string_view name) {
+  for (std::string_view prefix : {"agent_", "sampling_", "gradient_",
+                                  "estimator", "mppi_", "rollout_grid_"}) {
+    if (StartsWith(name, prefix)) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ParseParamSnapshot(const std::string& xml, ParamSnapshot* snapshot) {
+  std::string text = StripComments(xml);
+  snapshot->skeleton.clear();
+  snapshot->skeleton.reserve(text.size());
+  snapshot->numerics.clear();
+  snapshot->sensors.clear();
+
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t open = text.find('<', pos);
+    if (open == std::string::npos) {
+      snapshot->skeleton.append(text, pos, std::string::npos);
+      break;
+    }
+    size_t close = text.find('>', open);
+    if (close == std::string::npos) return false;
+    snapshot->skeleton.append(text, pos, open - pos);
+
+    std::string_view tag(text.data() + open + 1, close - open - 1);
+    const char* value_name = nullptr;
+    std::vector<ParamSnapshot::Entry>* entries = nullptr;
+    if (IsElement(tag, "numeric")) {
+      value_name = "data";
+      entries = &snapshot->numerics;
+    } else if (IsElement(tag, "user")) {
+      value_name = "user";
+      entries = &snapshot->sensors;
+    }
+
+    size_t begin, end;
+    if (entries && FindAttribute(tag, value_name, &begin, &end)) {
+      ParamSnapshot::Entry entry;
+      size_t name_begin, name_end;
+      if (FindAttribute(tag, "name", &name_begin, &name_end)) {
+        entry.first = std::string(tag.substr(name_begin, name_end - name_begin));
+      }
+      if (!ParseValues(tag.substr(begin, end - begin), &entry.second)) {
+        return false;
+      }
+      entries->push_back(std::move(entry));
+
+      // 骨架中去掉参数值
+      snapshot->skeleton.push_back('<');
+      snapshot->skeleton.append(tag.substr(0, begin));
+      snapshot->skeleton.append(tag.substr(end));
+      snapshot->skeleton.push_back('>');
+    } else {
+      snapshot->skeleton.append(text, open, close - open + 1);
+    }
+    pos = close + 1;
+  }
+  return true;
+}
+
+bool PatchModelParameters(const ParamSnapshot& snapshot, mjModel* model) {
+  // 先检查全部尺寸，保证要么全部修改、要么不修改
+  for (const auto& [name, values] : snapshot.numerics) {
+    int id = mj_name2id(model, mjOBJ_NUMERIC, name.c_str());
+    if (id < 0 || static_cast<int>(values.size()) != model->numeric_size[id]) {
+      return false;
+    }
+  }
+  for (const auto& [name, values] : snapshot.sensors) {
+    int id = mj_name2id(model, mjOBJ_SENSOR, name.c_str());
+    if (id < 0 || static_cast<int>(values.size()) > model->nuser_sensor) {
+      return false;
+    }
+  }
+
+  for (const auto& [name, values] : snapshot.numerics) {
+    int id = mj_name2id(model, mjOBJ_NUMERIC, name.c_str());
+    std::copy(values.begin(), values.end(),
+              model->numeric_data + model->numeric_adr[id]);
+  }
+  // 传感器 user 不足 nuser_sensor 的部分与编译器一致补零
+  for (const auto& [name, values] : snapshot.sensors) {
+    int id = mj_name2id(model, mjOBJ_SENSOR, name.c_str());
+    double* user = model->sensor_user + id * model->nuser_sensor;
+    std::fill_n(user, model->nuser_sensor, 0.0);
+    std::copy(values.begin(), values.end(), user);
+  }
+  return true;
+}
+
+void ApplyCostParameters(const mjModel* model, Task* task) {
+  // 代价项：user 传感器 [norm, weight, weight_lower, weight_upper, norm 参数...]
+  int term = 0;
+  int shift = 0;
+  for (int i = 0; i < model->nsensor && term < task->num_term; i++) {
+    if (model->sensor_type[i] != mjSENS_USER) continue;
+    const double* user = model->sensor_user + i * model->nuser_sensor;
+    task->weight[term] = user[1];
+    int num_parameter = task->num_norm_parameter[term];
+    for (int k = 0; k < num_parameter && 4 + k < model->nuser_sensor; k++) {
+      task->norm_parameter[shift + k] = user[4 + k];
+    }
+    shift += num_parameter;
+    term++;
+  }
+
+  // 残差参数：与 Task::Reset 相同，按 numeric 顺序取 residual_* 的第一个值；
+  //   residual_select_* 是界面选项，保留当前选择
+  int parameter = 0;
+  int num_parameters = task->parameters.size();
+  for (int i = 0; i < model->nnumeric && parameter < num_parameters; i++) {
+    std::string_view name(model->names + model->name_numericadr[i]);
+    if (StartsWith(name, "residual_select_")) {
+      parameter++;
+    } else if (StartsWith(name, "residual_")) {
+      task->parameters[parameter++] =
+          model->numeric_data[model->numeric_adr[i]];
+    }
+  }
+}
+
+bool ParamReloader::Initialize(const std::string& xml_path) {
+  path_ = xml_path;
+  files_.clear();
+  snapshot_ = ParamSnapshot();
+  if (!ReadFiles(&files_)) {
+    path_.clear();
+    return false;
+  }
+  for (const WatchedFile& file : files_) {
+    ParamSnapshot part;
+    if (!ParseParamSnapshot(file.text, &part)) {
+      path_.clear();
+      return false;
+    }
+    snapshot_.skeleton += part.skeleton;
+    snapshot_.numerics.insert(snapshot_.numerics.end(), part.numerics.begin(),
+                              part.numerics.end());
+    snapshot_.sensors.insert(snapshot_.sensors.end(), part.sensors.begin(),
+                             part.sensors.end());
+  }
+  return true;
+}
+
+bool ParamReloader::ReadFiles(std::vector<WatchedFile>* files) const {
+  // include 路径相对于主文件所在目录（与 MuJoCo 编译器一致）
+  std::string directory = Directory(path_);
+  std::vector<std::string> pending = {path_};
+  files->clear();
+  while (!pending.empty()) {
+    std::string path = pending.back();
+    pending.pop_back();
+    bool seen = false;
+    for (const WatchedFile& file : *files) seen |= file.path == path;
+    if (seen) continue;
+
+    WatchedFile file;
+    file.path = path;
+    if (!ModifiedTime(path, &file.mtime) || !ReadText(path, &file.text)) {
+      return false;
+    }
+
+    std::string text = StripComments(file.text);
+    size_t pos = 0;
+    while ((pos = text.find("<include", pos)) != std::string::npos) {
+      size_t close = text.find('>', pos);
+      if (close == std::string::npos) break;
+      std::string_view tag(text.data() + pos + 1, close - pos - 1);
+      size_t begin, end;
+      if (IsElement(tag, "include") &&
+          FindAttribute(tag, "file", &begin, &end)) {
+        std::string include(tag.substr(begin, end - begin));
+        pending.push_back(include[0] == '/' ? include : directory + include);
+      }
+      pos = close;
+    }
+    files->push_back(std::move(file));
+  }
+  return true;
+}
+
+bool ParamReloader::Modified() const {
+  for (const WatchedFile& file : files_) {
+    timespec mtime;
+    if (!ModifiedTime(file.path, &mtime)) return true;
+    if (mtime.tv_sec != file.mtime.tv_sec ||
+        mtime.tv_nsec != file.mtime.tv_nsec) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ParamReloader::Result ParamReloader::Poll(mjModel* model, ParamChange* change) {
+  if (path_.empty() || !Modified()) return kUnchanged;
+
+  // 编辑器保存过程中可能读到不完整的文件：记录修改时间，等下一次保存再比较
+  std::vector<WatchedFile> files;
+  if (!ReadFiles(&files)) return kUnchanged;
+  bool include_set_changed = files.size() != files_.size();
+  for (size_t i = 0; !include_set_changed && i < files.size(); i++) {
+    include_set_changed = files[i].path != files_[i].path;
+  }
+
+  ParamSnapshot snapshot;
+  for (const WatchedFile& file : files) {
+    ParamSnapshot part;
+    if (!ParseParamSnapshot(file.text, &part)) {
+      for (size_t i = 0; i < files.size() && i < files_.size(); i++) {
+        if (files[i].path == files_[i].path) files_[i].mtime = files[i].mtime;
+      }
+      return kUnchanged;
+    }
+    snapshot.skeleton += part.skeleton;
+    snapshot.numerics.insert(snapshot.numerics.end(), part.numerics.begin(),
+                             part.numerics.end());
+    snapshot.sensors.insert(snapshot.sensors.end(), part.sensors.begin(),
+                            part.sensors.end());
+  }
+  files_ = std::move(files);
+
+  if (include_set_changed || snapshot.skeleton != snapshot_.skeleton) {
+    snapshot_ = std::move(snapshot);
+    return kFull;
+  }
+
+  ParamChange local;
+  ParamChange& result = change ? *change : local;
+  result = ParamChange();
+  bool norm_changed = false;
+
+  for (const auto& [name, values] : snapshot.numerics) {
+    const std::vector<double>* previous = FindEntry(snapshot_.numerics, name);
+    if (previous && *previous == values) continue;
+    result.names.push_back(name);
+    if (StartsWith(name, "residual_")) {
+      result.residual = true;
+    } else if (IsPlannerSetting(name)) {
+      result.planner = true;
+    } else {
+      result.task = true;  // task_* / alert_* / dashboard_* / view_* 等
+    }
+  }
+  for (const auto& [name, values] : snapshot.sensors) {
+    const std::vector<double>* previous = FindEntry(snapshot_.sensors, name);
+    if (previous && *previous == values) continue;
+    result.names.push_back(name);
+    result.residual = true;
+    // 范数类型决定范数参数维度，改变时需要完整重载
+    if (!previous || previous->empty() || values.empty() ||
+        (*previous)[0] != values[0]) {
+      norm_changed = true;
+    }
+  }
+
+  if (result.names.empty()) return kUnchanged;  // 只改了格式或注释
+  if (norm_changed || !PatchModelParameters(snapshot, model)) {
+    snapshot_ = std::move(snapshot);
+    return kFull;
+  }
+
+  snapshot_ = std::move(snapshot);
+  result.snapshot = &snapshot_;
+  return kParameters;
+}
+
+}  // namespace mjpc
@@ -0,0 +1,108 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_PARAM_RELOAD_H_
+#define MJPC_TASKS_SIMPLE_CAR_PARAM_RELOAD_H_
+
+#include <ctime>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/task.h"
+
+namespace mjpc {
+
+// 模型文本中的可调参数：<numeric data="..."> 与 <user user="..."> 传感器
+//   skeleton 为去掉注释和这些参数值后的文本，相同即说明只有参数变化
+struct ParamSnapshot {
+  using Entry = std::pair<std::string, std::vector<double>>;
+
+  std::string skeleton;
+  std::vector<Entry> numerics;
+  std::vector<Entry> sensors;
+};
+
+// 解析模型文本，失败（标签不完整或数值非法）时返回 false
+bool ParseParamSnapshot(const std::string& xml, ParamSnapshot* snapshot);
+
+// 一次参数重载涉及的内容
+struct ParamChange {
+  std::vector<std::string> names;  // 变化的 numeric / 传感器名称
+  // agent_* / sampling_* / mppi_* 等规划器设置：模型中的值已更新，但规划器只在分配时
+  //   读取，需持有规划器的一方（监听者）重新读取设置并重新分配才生效
+  bool planner = false;
+  bool residual = false;  // residual_* 参数或代价权重
+  bool task = false;      // 其余 numeric：任务设置（task_*、alert_* 等）
+
+  // 新的参数快照，可用于更新规划器持有的模型副本
+  const ParamSnapshot* snapshot = nullptr;
+};
+
+// 参数变化的监听者（例如持有规划器的一方）
+using ParamListener = std::function<void(const ParamChange&)>;
+
+// 把快照中的参数写入模型（numeric_data / sensor_user）
+//   numeric 元素个数与模型不同（编译后的尺寸会变）或传感器 user 超出 nuser_sensor 时
+//   不修改并返回 false，需要完整重载
+//   规划器持有的模型副本也可以用同一快照更新
+bool PatchModelParameters(const ParamSnapshot& snapshot, mjModel* model);
+
+// 按模型中的参数更新任务的代价权重、范数参数和残差参数
+//   只写任务的公有成员，不加锁；调用方随后更新残差（UpdateResidual）
+void ApplyCostParameters(const mjModel* model, Task* task);
+
+// 参数热重载：监视 task.xml 及其 include 文件
+//   只有 numeric / 传感器参数变化时直接修改模型，不重新编译、不重新分配 mjData；
+//   其它任何变化返回 kFull，由调用方完整重载
+//   Poll 不调用监听者：调用方通常在持有任务锁时 Poll，应记下 ParamChange，
+//   释放锁之后再通知
+class ParamReloader {
+ public:
+  enum Result : int {
+    kUnchanged = 0,
+    kParameters,  // 已修改模型参数
+    kFull,        // 结构变化，需要完整重载
+  };
+
+  // 以当前文件内容为基准
+  bool Initialize(const std::string& xml_path);
+  bool IsInitialized() const { return !path_.empty(); }
+
+  // 检查文件变化：修改时间未变时只有几次 stat 调用
+  Result Poll(mjModel* model, ParamChange* change = nullptr);
+
+  const ParamSnapshot& snapshot() const { return snapshot_; }
+
+ private:
+  struct WatchedFile {
+    std::string path;
+    timespec mtime = {0, 0};
+    std::string text;
+  };
+
+  // 读取主文件及（递归的）include 文件
+  bool ReadFiles(std::vector<WatchedFile>* files) const;
+  bool Modified() const;
+
+  std::string path_;
+  std::vector<WatchedFile> files_;
+  ParamSnapshot snapshot_;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_PARAM_RELOAD_H_
@@ -0,0 +1,110 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 参数热重载检查：监视 task.xml，比较参数重载与完整重载（编译 + mjData）的耗时
+//   param_reload --xml=.../simple_car/task.xml --poll=0.2
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/param_reload.h"
+#include "mjpc/tasks/simple_car/planner_warmup.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(double, poll, 0.2, "poll period (s)");
+
+namespace {
+
+double Milliseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start).count();
+}
+
+// 完整重载：解析、编译并分配 mjData；预触碰单独计时（不计入重载基准）
+bool FullReload(const std::string& xml, mjModel** model, mjData** data,
+                double* milliseconds, double* prefault_ms) {
+  auto start = std::chrono::steady_clock::now();
+  char error[1000] = "";
+  mjModel* new_model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!new_model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return false;
+  }
+  mjData* new_data = mj_makeData(new_model);
+  mj_forward(new_model, new_data);
+  *milliseconds = Milliseconds(start);
+
+  auto prefault_start = std::chrono::steady_clock::now();
+  mjpc::PrefaultData(new_model, new_data);
+  mj_forward(new_model, new_data);
+  *prefault_ms = Milliseconds(prefault_start);
+
+  if (*data) mj_deleteData(*data);
+  if (*model) mj_deleteModel(*model);
+  *model = new_model;
+  *data = new_data;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = mjpc::SimpleCar().XmlPath();
+
+  mjModel* model = nullptr;
+  mjData* data = nullptr;
+  double full_ms = 0.0, prefault_ms = 0.0;
+  if (!FullReload(xml, &model, &data, &full_ms, &prefault_ms)) return 1;
+  std::printf("full reload: %.2f ms (+ prefault %.2f ms)\n", full_ms,
+              prefault_ms);
+
+  mjpc::ParamReloader reloader;
+  if (!reloader.Initialize(xml)) {
+    std::fprintf(stderr, "failed to watch '%s'\n", xml.c_str());
+    return 1;
+  }
+  std::printf("watching %s (ctrl-c to stop)\n", xml.c_str());
+  auto period = std::chrono::duration<double>(absl::GetFlag(FLAGS_poll));
+  while (true) {
+    std::this_thread::sleep_for(period);
+
+    auto start = std::chrono::steady_clock::now();
+    mjpc::ParamChange change;
+    mjpc::ParamReloader::Result result = reloader.Poll(model, &change);
+    double poll_ms = Milliseconds(start);
+
+    if (result == mjpc::ParamReloader::kParameters) {
+      std::printf("parameter reload: %zu changed in %.3f ms "
+                  "(full reload %.2f ms)%s\n",
+                  change.names.size(), poll_ms, full_ms,
+                  change.planner ? ", includes planner settings" : "");
+      for (const std::string& name : change.names) {
+        std::printf("  %s\n", name.c_str());
+      }
+    } else if (result == mjpc::ParamReloader::kFull) {
+      if (!FullReload(xml, &model, &data, &full_ms, &prefault_ms)) continue;
+      std::printf("structure changed: full reload %.2f ms "
+                  "(+ prefault %.2f ms)\n", full_ms, prefault_ms);
+    }
+  }
+}
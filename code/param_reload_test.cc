@@ -0,0 +1,177 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/param_reload.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+namespace {
+
+constexpr char kModel[] = R"(
+<mujoco>
+  <custom>
+    <numeric name="residual_gain" data="1 2"/>
+    <numeric name="task_speed" data="3"/>
+    <numeric name="alert_high_rpm" data="6500"/>
+    <numeric name="agent_horizon" data="1.5"/>
+  </custom>
+  <worldbody/>
+</mujoco>
+)";
+
+class PatchModelParametersTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string path = ::testing::TempDir() + "param_reload_test.xml";
+    FILE* file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs(kModel, file);
+    std::fclose(file);
+    char error[1000] = "";
+    model_ = mj_loadXML(path.c_str(), nullptr, error, sizeof(error));
+    std::remove(path.c_str());
+    ASSERT_NE(model_, nullptr) << error;
+  }
+
+  void TearDown() override {
+    if (model_) mj_deleteModel(model_);
+  }
+
+  // 把 kModel 中的 from 换成 to 后解析
+  ParamSnapshot Snapshot(const std::string& from, const std::string& to) {
+    std::string xml = kModel;
+    size_t pos = xml.find(from);
+    EXPECT_NE(pos, std::string::npos);
+    xml.replace(pos, from.size(), to);
+    ParamSnapshot snapshot;
+    EXPECT_TRUE(ParseParamSnapshot(xml, &snapshot));
+    return snapshot;
+  }
+
+  const double* Numeric(const char* name) const {
+    int id = mj_name2id(model_, mjOBJ_NUMERIC, name);
+    return model_->numeric_data + model_->numeric_adr[id];
+  }
+
+  mjModel* model_ = nullptr;
+};
+
+TEST_F(PatchModelParametersTest, PatchesMatchingSizes) {
+  ASSERT_TRUE(PatchModelParameters(
+      Snapshot(R"(data="1 2")", R"(data="5 6")"), model_));
+  EXPECT_EQ(Numeric("residual_gain")[0], 5.0);
+  EXPECT_EQ(Numeric("residual_gain")[1], 6.0);
+  EXPECT_EQ(Numeric("task_speed")[0], 3.0);
+}
+
+TEST_F(PatchModelParametersTest, RejectsFewerValues) {
+  // 重新编译后 numeric_size 会变成 1，不能原地修改
+  EXPECT_FALSE(PatchModelParameters(
+      Snapshot(R"(data="1 2")", R"(data="7")"), model_));
+  EXPECT_EQ(Numeric("residual_gain")[0], 1.0);
+  EXPECT_EQ(Numeric("residual_gain")[1], 2.0);
+}
+
+TEST_F(PatchModelParametersTest, RejectsMoreValues) {
+  EXPECT_FALSE(PatchModelParameters(
+      Snapshot(R"(data="3")", R"(data="8 9")"), model_));
+  EXPECT_EQ(Numeric("task_speed")[0], 3.0);
+}
+
+TEST_F(PatchModelParametersTest, RejectsUnknownNumeric) {
+  // 任一项不符时整体不修改
+  ParamSnapshot snapshot = Snapshot(R"(data="1 2")", R"(data="5 6")");
+  snapshot.numerics.push_back({"task_missing", {1.0}});
+  EXPECT_FALSE(PatchModelParameters(snapshot, model_));
+  EXPECT_EQ(Numeric("residual_gain")[0], 1.0);
+}
+
+// 监视的文件保留在磁盘上，Edit 改写后把修改时间推后，保证 Poll 能看到变化
+class ParamReloaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "param_reloader_test.xml";
+    Write(kModel);
+    char error[1000] = "";
+    model_ = mj_loadXML(path_.c_str(), nullptr, error, sizeof(error));
+    ASSERT_NE(model_, nullptr) << error;
+    ASSERT_TRUE(reloader_.Initialize(path_));
+  }
+
+  void TearDown() override {
+    if (model_) mj_deleteModel(model_);
+    std::remove(path_.c_str());
+  }
+
+  void Write(const std::string& xml) {
+    FILE* file = std::fopen(path_.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs(xml.c_str(), file);
+    std::fclose(file);
+  }
+
+  // 把 kModel 中的 from 换成 to 后写回
+  void Edit(const std::string& from, const std::string& to) {
+    auto mtime = std::filesystem::last_write_time(path_);
+    std::string xml = kModel;
+    size_t pos = xml.find(from);
+    ASSERT_NE(pos, std::string::npos);
+    xml.replace(pos, from.size(), to);
+    Write(xml);
+    std::filesystem::last_write_time(path_, mtime + std::chrono::seconds(1));
+  }
+
+  const double* Numeric(const char* name) const {
+    int id = mj_name2id(model_, mjOBJ_NUMERIC, name);
+    return model_->numeric_data + model_->numeric_adr[id];
+  }
+
+  std::string path_;
+  mjModel* model_ = nullptr;
+  ParamReloader reloader_;
+};
+
+TEST_F(ParamReloaderTest, AlertEditIsTaskSetting) {
+  // 告警阈值不是规划器设置：需要任务重新读取（ReadTaskParameters）
+  Edit(R"(data="6500")", R"(data="7000")");
+  ParamChange change;
+  ASSERT_EQ(reloader_.Poll(model_, &change), ParamReloader::kParameters);
+  EXPECT_EQ(change.names, std::vector<std::string>{"alert_high_rpm"});
+  EXPECT_TRUE(change.task);
+  EXPECT_FALSE(change.planner);
+  EXPECT_FALSE(change.residual);
+  EXPECT_EQ(Numeric("alert_high_rpm")[0], 7000.0);
+  EXPECT_EQ(reloader_.Poll(model_, &change), ParamReloader::kUnchanged);
+}
+
+TEST_F(ParamReloaderTest, AgentEditIsPlannerSetting) {
+  Edit(R"(data="1.5")", R"(data="2.5")");
+  ParamChange change;
+  ASSERT_EQ(reloader_.Poll(model_, &change), ParamReloader::kParameters);
+  EXPECT_EQ(change.names, std::vector<std::string>{"agent_horizon"});
+  EXPECT_TRUE(change.planner);
+  EXPECT_FALSE(change.task);
+  EXPECT_EQ(Numeric("agent_horizon")[0], 2.5);
+}
+
+}  // namespace
+}  // namespace mjpc
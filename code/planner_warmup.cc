@@ -0,0 +1,100 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/planner_warmup.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/threadpool.h"
+
+namespace mjpc {
+
+void PrefaultData(const mjModel* model, mjData* data) {
+  // 写入（而非读取）才会为匿名映射分配物理页
+  std::memset(data->buffer, 0, data->nbuffer);
+  std::memset(data->arena, 0, data->narena);
+  mj_resetData(model, data);
+}
+
+void WarmupThreadPool(ThreadPool& pool) {
+  int threads = pool.NumThreads();
+  int count_before = pool.GetCount();
+  for (int i = 0; i < threads; i++) {
+    pool.Schedule([]() {
+      // 触碰一段栈空间，提前完成线程栈的缺页
+      volatile char stack[64 * 1024];
+      for (size_t j = 0; j < sizeof(stack); j += 4096) stack[j] = 0;
+    });
+  }
+  pool.WaitCount(count_before + threads);
+  pool.ResetCount();
+}
+
+// ============ LatencyTracker ============
+void LatencyTracker::Record(double ms) {
+  if (cold_remaining_ > 0) {
+    cold_.push_back(ms);
+    cold_remaining_--;
+  } else {
+    steady_.push_back(ms);
+  }
+}
+
+void LatencyTracker::Clear() {
+  cold_remaining_ = 0;
+  warmups_ = 0;
+  warmup_ms_ = 0.0;
+  cold_.clear();
+  steady_.clear();
+}
+
+LatencyTracker::Summary LatencyTracker::Summarize(std::vector<double> values) {
+  Summary summary;
+  summary.count = values.size();
+  if (values.empty()) return summary;
+
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (double v : values) sum += v;
+  summary.mean = sum / values.size();
+  summary.max = values.back();
+  auto at = [&](double q) {
+    return values[static_cast<size_t>(q * (values.size() - 1))];
+  };
+  summary.p50 = at(0.50);
+  summary.p95 = at(0.95);
+  summary.p99 = at(0.99);
+  return summary;
+}
+
+void LatencyTracker::Print(const char* title) const {
+  Summary cold = Cold();
+  Summary steady = Steady();
+  std::printf("%s\n", title);
+  std::printf("  cold   : n=%-5d mean %8.3f ms  max %8.3f ms\n", cold.count,
+              cold.mean, cold.max);
+  std::printf("  steady : n=%-5d p50 %8.3f ms  p95 %8.3f ms  p99 %8.3f ms"
+              "  max %8.3f ms\n",
+              steady.count, steady.p50, steady.p95, steady.p99, steady.max);
+  if (warmups_ > 0) {
+    std::printf("  warm-up: n=%-5d total %8.3f ms  mean %8.3f ms\n", warmups_,
+                warmup_ms_, warmup_ms_ / warmups_);
+  }
+}
+
+}  // namespace mjpc
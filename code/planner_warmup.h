@@ -0,0 +1,116 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_PLANNER_WARMUP_H_
+#define MJPC_TASKS_SIMPLE_CAR_PLANNER_WARMUP_H_
+
+#include <chrono>
+#include <vector>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/threadpool.h"
+
+namespace mjpc {
+
+// 预先触碰 mjData 的全部缓冲区和 arena 页，然后恢复到初始状态
+//   避免第一次仿真/rollout 时的缺页和延迟分配
+void PrefaultData(const mjModel* model, mjData* data);
+
+// 让线程池的每个线程都执行一次任务（线程创建和首次调度的开销提前发生）
+void WarmupThreadPool(ThreadPool& pool);
+
+// 规划迭代延迟统计：冷启动（启动、模型重载、目标切换后的前几次迭代）与稳态分开统计
+class LatencyTracker {
+ public:
+  struct Summary {
+    int count = 0;
+    double mean = 0.0;
+    double max = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+  };
+
+  // 之后 iterations 次迭代计为冷启动
+  void MarkCold(int iterations = 3) { cold_remaining_ = iterations; }
+
+  // 记录一次迭代耗时（毫秒）
+  void Record(double ms);
+
+  // 记录一次热身的总耗时（不计入迭代延迟，单独报告）
+  void RecordWarmup(double ms) {
+    warmups_++;
+    warmup_ms_ += ms;
+  }
+
+  void Clear();
+
+  Summary Cold() const { return Summarize(cold_); }
+  Summary Steady() const { return Summarize(steady_); }
+
+  void Print(const char* title) const;
+
+ private:
+  static Summary Summarize(std::vector<double> values);
+
+  int cold_remaining_ = 0;
+  int warmups_ = 0;
+  double warmup_ms_ = 0.0;
+  std::vector<double> cold_;
+  std::vector<double> steady_;
+};
+
+// 热身结果
+struct WarmupReport {
+  int iterations = 0;
+  double first_ms = 0.0;  // 第一次（最冷）迭代
+  double last_ms = 0.0;   // 最后一次迭代，近似稳态
+  double total_ms = 0.0;
+};
+
+// 目标切换后的热身：在当前状态上追加若干次优化并保留策略，
+//   让策略在切换后的第一个控制周期之前就朝新目标收敛。
+//   PlannerT 需提供 OptimizePolicy(int, ThreadPool&)
+template <typename PlannerT>
+WarmupReport WarmupPolicy(PlannerT& planner, int horizon, ThreadPool& pool,
+                          int iterations) {
+  WarmupReport report;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    planner.OptimizePolicy(horizon, pool);
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+    if (i == 0) report.first_ms = ms;
+    report.last_ms = ms;
+    report.total_ms += ms;
+    report.iterations++;
+  }
+  return report;
+}
+
+// 规划器热身（启动、模型重载）：在当前状态上执行若干次空跑优化（dummy rollouts），
+//   让各线程的 mjData、轨迹缓冲区和缓存进入稳态，最后重置策略，不影响后续控制。
+//   PlannerT 另需提供 Reset(int)
+template <typename PlannerT>
+WarmupReport WarmupPlanner(PlannerT& planner, int horizon, ThreadPool& pool,
+                           int iterations) {
+  WarmupThreadPool(pool);
+  WarmupReport report = WarmupPolicy(planner, horizon, pool, iterations);
+  planner.Reset(horizon);
+  return report;
+}
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_PLANNER_WARMUP_H_
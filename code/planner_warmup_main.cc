@@ -0,0 +1,189 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 规划器热身对比：闭环运行 SimpleCar，分别统计冷启动与稳态迭代延迟
+//   planner_warmup --iterations=500 --warmup=5 --reload_every=200 --rounds=2
+// 启动和每次模型重载（重新分配 mjData 与规划器，与 agent 的重载路径相同）
+//   都经过同一个启动函数，开启热身时两处都先预触碰数据并热身规划器；
+//   目标切换由任务的热身请求（TakeWarmupRequest）通知，开启热身时追加优化
+//   并保留策略。热身耗时单独报告，不计入迭代延迟
+// 两种配置交替运行（偶数轮先无热身，奇数轮先热身），避免先后顺序带来的
+//   页缓存、频率等偏差；各轮结果合并统计
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/planners/sampling/planner.h"
+#include "mjpc/states/state.h"
+#include "mjpc/tasks/simple_car/planner_warmup.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+#include "mjpc/threadpool.h"
+#include "mjpc/utilities.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(int, iterations, 500, "closed-loop planner iterations");
+ABSL_FLAG(int, warmup, 5, "warm-up iterations (0 disables warm-up)");
+ABSL_FLAG(int, cold_window, 3, "iterations counted as cold after an event");
+ABSL_FLAG(int, reload_every, 200,
+          "simulate a model reload every n iterations (0: never)");
+ABSL_FLAG(int, rounds, 2, "alternating rounds of both configurations");
+ABSL_FLAG(int, threads, 0, "planner threads (0: hardware concurrency)");
+
+namespace {
+
+// 启动或重载：新建 mjData 和规划器并回到初始状态；warmup > 0 时先预触碰
+//   mjData、再空跑规划器（其每线程 mjData 和轨迹缓冲区在空跑中分配并触碰）
+void StartPlanner(mjModel* model, mjpc::SimpleCar& task, int horizon,
+                  int warmup, mjpc::ThreadPool& pool, mjData** data,
+                  mjpc::State* state,
+                  std::unique_ptr<mjpc::SamplingPlanner>* planner,
+                  mjpc::LatencyTracker* tracker) {
+  if (*data) mj_deleteData(*data);
+  *data = mj_makeData(model);
+  double prefault_ms = 0.0;
+  if (warmup > 0) {
+    auto start = std::chrono::steady_clock::now();
+    mjpc::PrefaultData(model, *data);
+    prefault_ms = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start).count();
+  }
+  if (model->nkey > 0) mj_resetDataKeyframe(model, *data, 0);
+  mj_forward(model, *data);
+  state->Set(model, *data);
+
+  *planner = std::make_unique<mjpc::SamplingPlanner>();
+  (*planner)->Initialize(model, task);
+  (*planner)->Allocate();
+  (*planner)->Reset(horizon);
+  (*planner)->SetState(*state);
+
+  // Reset（启动、重载）的热身请求由这里的热身满足
+  task.TakeWarmupRequest();
+  if (warmup > 0) {
+    mjpc::WarmupReport report =
+        mjpc::WarmupPlanner(**planner, horizon, pool, warmup);
+    tracker->RecordWarmup(prefault_ms + report.total_ms);
+  }
+}
+
+// 闭环运行一次，启动、重载和目标切换后的前 cold_window 次迭代计为冷启动
+void Run(mjModel* model, int iterations, int warmup, int cold_window,
+         int reload_every, int threads, mjpc::LatencyTracker* tracker) {
+  mjpc::SimpleCar task;
+  task.Reset(model);
+
+  mjpc::State state;
+  state.Initialize(model);
+  state.Allocate(model);
+  state.Reset();
+
+  double agent_timestep = mjpc::GetNumberOrDefault(0.02, model, "agent_timestep");
+  double agent_horizon = mjpc::GetNumberOrDefault(2.0, model, "agent_horizon");
+  int horizon = std::round(agent_horizon / agent_timestep) + 1;
+  int physics_steps = std::max(1, static_cast<int>(
+                                      std::round(agent_timestep /
+                                                 model->opt.timestep)));
+
+  mjpc::ThreadPool pool(threads);
+  mjData* data = nullptr;
+  std::unique_ptr<mjpc::SamplingPlanner> planner;
+  StartPlanner(model, task, horizon, warmup, pool, &data, &state, &planner,
+               tracker);
+  tracker->MarkCold(cold_window);
+
+  for (int i = 0; i < iterations; i++) {
+    if (reload_every > 0 && i > 0 && i % reload_every == 0) {
+      task.Reset(model);
+      StartPlanner(model, task, horizon, warmup, pool, &data, &state,
+                   &planner, tracker);
+      tracker->MarkCold(cold_window);
+    }
+
+    state.Set(model, data);
+    planner->SetState(state);
+
+    auto start = std::chrono::steady_clock::now();
+    planner->OptimizePolicy(horizon, pool);
+    tracker->Record(std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count());
+
+    // 按新策略推进一个控制周期
+    for (int k = 0; k < physics_steps; k++) {
+      task.Transition(model, data);
+      planner->ActionFromPolicy(data->ctrl, state.state().data(), data->time);
+      mj_step(model, data);
+    }
+
+    // 目标切换：之后的迭代同样计为冷启动；开启热身时先在新状态上追加优化
+    if (task.TakeWarmupRequest()) {
+      tracker->MarkCold(cold_window);
+      if (warmup > 0) {
+        state.Set(model, data);
+        planner->SetState(state);
+        mjpc::WarmupReport report =
+            mjpc::WarmupPolicy(*planner, horizon, pool, warmup);
+        tracker->RecordWarmup(report.total_ms);
+      }
+    }
+  }
+
+  mj_deleteData(data);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = mjpc::SimpleCar().XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+
+  int threads = absl::GetFlag(FLAGS_threads);
+  if (threads <= 0) threads = std::thread::hardware_concurrency();
+  int iterations = absl::GetFlag(FLAGS_iterations);
+  int warmup = absl::GetFlag(FLAGS_warmup);
+  int cold_window = absl::GetFlag(FLAGS_cold_window);
+  int reload_every = absl::GetFlag(FLAGS_reload_every);
+  int rounds = std::max(1, absl::GetFlag(FLAGS_rounds));
+
+  mjpc::LatencyTracker cold_start;
+  mjpc::LatencyTracker warm_start;
+  for (int round = 0; round < rounds; round++) {
+    for (int k = 0; k < 2; k++) {
+      bool warm = (k == 1) == (round % 2 == 0);
+      Run(model, iterations, warm ? warmup : 0, cold_window, reload_every,
+          threads, warm ? &warm_start : &cold_start);
+    }
+  }
+  cold_start.Print("without warm-up");
+  warm_start.Print("with warm-up");
+
+  mj_deleteModel(model);
+  return 0;
+}
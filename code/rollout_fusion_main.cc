@@ -0,0 +1,145 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 两遍评估与融合评估的 rollout 对比
+//   rollout_fusion --rollouts=2000 --duration=0.5
+// 两种模式使用相同的初始状态序列，代价应逐位相同；
+//   报告每个 rollout 的耗时和缓冲区读写字节数
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/car_rollout.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(int, rollouts, 2000, "rollouts per mode");
+ABSL_FLAG(double, duration, 0.5, "rollout duration (s)");
+ABSL_FLAG(int, repeats, 3, "timing repeats per mode (best is reported)");
+ABSL_FLAG(int, seed, 1, "initial state seed");
+
+namespace {
+
+struct ModeResult {
+  double us_per_rollout = 0.0;
+  std::vector<double> costs;
+};
+
+ModeResult Run(const mjModel* model, mjData* data,
+               const mjpc::ResidualFn& residual, mjpc::CarRollout* rollout,
+               const std::vector<mjpc::CarInitialState>& states,
+               const std::vector<double>& ctrl, int steps, int repeats) {
+  ModeResult result;
+  result.costs.resize(states.size());
+  double best = 1e300;
+  for (int repeat = 0; repeat < repeats; repeat++) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < states.size(); i++) {
+      mjpc::CarRollout::SetState(model, data, states[i]);
+      result.costs[i] = rollout->Rollout(model, data, residual,
+                                         ctrl.data() + 2 * i, steps);
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start).count();
+    best = std::min(best, seconds);
+  }
+  result.us_per_rollout = 1e6 * best / states.size();
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+  task.Reset(model);
+
+  int num_rollouts = std::max(1, absl::GetFlag(FLAGS_rollouts));
+  int steps = std::max(
+      1, static_cast<int>(std::round(absl::GetFlag(FLAGS_duration) /
+                                     model->opt.timestep)));
+  int repeats = std::max(1, absl::GetFlag(FLAGS_repeats));
+
+  // 随机初始状态与控制量，两种模式共用
+  std::mt19937 rng(absl::GetFlag(FLAGS_seed));
+  std::uniform_real_distribution<double> unit(-1.0, 1.0);
+  std::vector<mjpc::CarInitialState> states(num_rollouts);
+  std::vector<double> ctrl(2 * num_rollouts);
+  for (int i = 0; i < num_rollouts; i++) {
+    states[i].heading = M_PI * unit(rng);
+    states[i].speed = 0.5 + 0.5 * unit(rng);
+    states[i].goal[0] = 3.0 * unit(rng);
+    states[i].goal[1] = 3.0 * unit(rng);
+    ctrl[2 * i] = unit(rng);
+    ctrl[2 * i + 1] = unit(rng);
+  }
+
+  mjData* data = mj_makeData(model);
+  mjpc::SimpleCar::ResidualFn residual(&task);
+  mjpc::CarRollout rollout;
+  rollout.Allocate(model, task.num_residual, steps);
+
+  rollout.set_mode(mjpc::CarRollout::kTwoPass);
+  ModeResult two_pass =
+      Run(model, data, residual, &rollout, states, ctrl, steps, repeats);
+  rollout.set_mode(mjpc::CarRollout::kFused);
+  ModeResult fused =
+      Run(model, data, residual, &rollout, states, ctrl, steps, repeats);
+
+  double max_diff = 0.0;
+  for (int i = 0; i < num_rollouts; i++) {
+    max_diff = std::max(max_diff, std::abs(two_pass.costs[i] - fused.costs[i]));
+  }
+
+  std::printf("%d rollouts x %d steps (nq=%d nv=%d nu=%d nmocap=%d)\n",
+              num_rollouts, steps, model->nq, model->nv, model->nu,
+              model->nmocap);
+  std::printf("  %-9s %14s %16s %14s\n", "mode", "us/rollout", "buffer KB/roll",
+              "bytes/step");
+  struct {
+    const char* name;
+    mjpc::CarRollout::Mode mode;
+    const ModeResult* result;
+  } rows[2] = {{"two-pass", mjpc::CarRollout::kTwoPass, &two_pass},
+               {"fused", mjpc::CarRollout::kFused, &fused}};
+  for (const auto& row : rows) {
+    int bytes = rollout.BufferBytesPerStep(row.mode);
+    std::printf("  %-9s %14.2f %16.2f %14d\n", row.name,
+                row.result->us_per_rollout, bytes * steps / 1024.0, bytes);
+  }
+  std::printf("  speedup %.2fx, max |cost difference| %.3g\n",
+              two_pass.us_per_rollout / fused.us_per_rollout, max_diff);
+
+  mj_deleteData(data);
+  mj_deleteModel(model);
+  return max_diff == 0.0 ? 0 : 1;
+}
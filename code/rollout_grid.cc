@@ -0,0 +1,100 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/rollout_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <mujoco/mujoco.h>
+#include "mjpc/utilities.h"
+#include "mjpc/tasks/simple_car/sim_profile.h"
+
+namespace mjpc {
+
+RolloutGridConfig RolloutGridConfig::FromModel(const mjModel* model) {
+  RolloutGridConfig config;
+  config.fine_duration =
+      GetNumberOrDefault(config.fine_duration, model, "rollout_grid_fine");
+  config.coarse_step =
+      GetNumberOrDefault(config.coarse_step, model, "rollout_grid_coarse_step");
+  config.coarse_substep =
+      GetNumberOrDefault(config.coarse_substep, model, "rollout_grid_substep");
+  return config;
+}
+
+void RolloutGrid::Build(double horizon, double fine_step,
+                        const RolloutGridConfig& config) {
+  this->fine_step = fine_step;
+  times.assign(1, 0.0);
+  substeps.clear();
+  coarse.clear();
+  physics_steps = 0;
+
+  int total = std::max(1, static_cast<int>(std::round(horizon / fine_step)));
+  int fine = total;
+  int per_step = 0;
+  double substep = config.coarse_substep;
+  if (config.fine_duration > 0.0 && substep > fine_step) {
+    fine = std::min(
+        total, static_cast<int>(std::ceil(config.fine_duration / fine_step -
+                                          1e-9)));
+    per_step = std::max(1, static_cast<int>(
+                               std::round(config.coarse_step / substep)));
+  }
+
+  // 精细段：与均匀网格的前 fine 步完全相同
+  for (int t = 0; t < fine; t++) {
+    times.push_back((t + 1) * fine_step);
+    substeps.push_back(1);
+    coarse.push_back(0);
+    physics_steps++;
+  }
+  if (fine == total) return;
+
+  // 粗段：子步数取整，最后一步按剩余时长截短（至少 1 个子步）
+  double start = times.back();
+  int remaining = std::max(
+      1, static_cast<int>(std::round((horizon - start) / substep)));
+  int done = 0;
+  while (done < remaining) {
+    int n = std::min(per_step, remaining - done);
+    done += n;
+    times.push_back(start + done * substep);
+    substeps.push_back(n);
+    coarse.push_back(1);
+    physics_steps += n;
+  }
+}
+
+bool RolloutGrid::uniform() const {
+  return std::find(coarse.begin(), coarse.end(), 1) == coarse.end();
+}
+
+mjModel* MakeCoarseRolloutModel(const mjModel* model,
+                                const RolloutGridConfig& config) {
+  mjModel* coarse = mj_copyModel(nullptr, model);
+  ApplySimProfile(coarse, SimProfile{"coarse rollout", mjINT_IMPLICITFAST,
+                                     config.coarse_substep});
+  return coarse;
+}
+
+void UpdateCoarseRolloutModel(mjModel* coarse, const mjModel* model,
+                              const RolloutGridConfig& config) {
+  mj_copyModel(coarse, model);
+  ApplySimProfile(coarse, SimProfile{"coarse rollout", mjINT_IMPLICITFAST,
+                                     config.coarse_substep});
+}
+
+}  // namespace mjpc
@@ -0,0 +1,69 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_ROLLOUT_GRID_H_
+#define MJPC_TASKS_SIMPLE_CAR_ROLLOUT_GRID_H_
+
+#include <vector>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 非均匀 rollout 时间网格配置
+//   前 fine_duration 秒按规划模型步长（agent_timestep）逐步仿真；
+//   之后每个网格步长 coarse_step，由若干个 coarse_substep 的物理子步组成，
+//   子步在 implicitfast 积分器的粗模型上执行（与快速仿真配置相同的稳定性取舍）
+struct RolloutGridConfig {
+  double fine_duration = 0.0;   // rollout_grid_fine（秒），0 为均匀网格
+  double coarse_step = 0.1;     // rollout_grid_coarse_step（秒）
+  double coarse_substep = 0.05;  // rollout_grid_substep（秒）
+
+  // 从任务 numeric 读取（缺省时取上面的默认值）
+  static RolloutGridConfig FromModel(const mjModel* model);
+};
+
+// 网格：第 t 步从 times[t] 开始，持续 times[t + 1] - times[t]，
+//   coarse[t] 为 0 时在规划模型上走 1 步，否则在粗模型上走 substeps[t] 步
+struct RolloutGrid {
+  std::vector<double> times;   // [steps + 1]
+  std::vector<int> substeps;   // [steps]
+  std::vector<char> coarse;    // [steps]
+  double fine_step = 0.0;
+  int physics_steps = 0;       // 每条 rollout 的物理步数
+
+  // horizon 内的网格；配置为均匀或粗步长不大于 fine_step 时为均匀网格
+  void Build(double horizon, double fine_step, const RolloutGridConfig& config);
+
+  int steps() const { return substeps.size(); }
+  double duration(int t) const { return times[t + 1] - times[t]; }
+  // 第 t 步代价的权重：精细步为 1，粗步为 步长 / fine_step
+  double weight(int t) const {
+    return coarse[t] ? duration(t) / fine_step : 1.0;
+  }
+  bool uniform() const;
+};
+
+// 粗段使用的模型：复制 model，积分器改为 implicitfast，步长为 coarse_substep
+//   （调用者用 mj_deleteModel 释放）
+mjModel* MakeCoarseRolloutModel(const mjModel* model,
+                                const RolloutGridConfig& config);
+
+// model 的参数被修改后（尺寸不变）重新复制到已有的粗模型
+void UpdateCoarseRolloutModel(mjModel* coarse, const mjModel* model,
+                              const RolloutGridConfig& config);
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_ROLLOUT_GRID_H_
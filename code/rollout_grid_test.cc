@@ -0,0 +1,105 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/rollout_grid.h"
+
+#include <gtest/gtest.h>
+
+namespace mjpc {
+namespace {
+
+// 各步代价权重之和乘以 fine_step 应等于网格总时长
+double WeightedDuration(const RolloutGrid& grid) {
+  double sum = 0.0;
+  for (int t = 0; t < grid.steps(); t++) sum += grid.weight(t);
+  return sum * grid.fine_step;
+}
+
+TEST(RolloutGridTest, UniformByDefault) {
+  RolloutGrid grid;
+  grid.Build(2.0, 0.02, RolloutGridConfig());
+  EXPECT_TRUE(grid.uniform());
+  EXPECT_EQ(grid.steps(), 100);
+  EXPECT_EQ(grid.physics_steps, 100);
+  for (int t = 0; t < grid.steps(); t++) {
+    EXPECT_EQ(grid.substeps[t], 1);
+    EXPECT_DOUBLE_EQ(grid.weight(t), 1.0);
+  }
+  EXPECT_NEAR(grid.times.back(), 2.0, 1e-12);
+}
+
+TEST(RolloutGridTest, SubstepNotCoarserIsUniform) {
+  RolloutGridConfig config;
+  config.fine_duration = 0.3;
+  config.coarse_substep = 0.02;
+  RolloutGrid grid;
+  grid.Build(2.0, 0.02, config);
+  EXPECT_TRUE(grid.uniform());
+  EXPECT_EQ(grid.physics_steps, 100);
+}
+
+TEST(RolloutGridTest, DefaultSceneGrid) {
+  // task_common.xml：精细 0.3 s，之后 0.1 s 一步、每步 2 个 0.05 s 子步
+  RolloutGridConfig config;
+  config.fine_duration = 0.3;
+  config.coarse_step = 0.1;
+  config.coarse_substep = 0.05;
+  RolloutGrid grid;
+  grid.Build(2.0, 0.02, config);
+  EXPECT_FALSE(grid.uniform());
+  EXPECT_EQ(grid.steps(), 15 + 17);
+  EXPECT_EQ(grid.physics_steps, 15 + 34);
+  for (int t = 0; t < 15; t++) {
+    EXPECT_FALSE(grid.coarse[t]);
+    EXPECT_EQ(grid.substeps[t], 1);
+    EXPECT_DOUBLE_EQ(grid.weight(t), 1.0);
+  }
+  for (int t = 15; t < grid.steps(); t++) {
+    EXPECT_TRUE(grid.coarse[t]);
+    EXPECT_EQ(grid.substeps[t], 2);
+    EXPECT_NEAR(grid.weight(t), 5.0, 1e-9);
+  }
+  EXPECT_NEAR(grid.times.back(), 2.0, 1e-9);
+  EXPECT_NEAR(WeightedDuration(grid), 2.0, 1e-9);
+}
+
+TEST(RolloutGridTest, LastCoarseStepTruncated) {
+  // 剩余 1.7 s = 34 个子步，每步 3 个：11 步 + 最后 1 个子步
+  RolloutGridConfig config;
+  config.fine_duration = 0.3;
+  config.coarse_step = 0.15;
+  config.coarse_substep = 0.05;
+  RolloutGrid grid;
+  grid.Build(2.0, 0.02, config);
+  EXPECT_EQ(grid.steps(), 15 + 12);
+  EXPECT_EQ(grid.physics_steps, 15 + 34);
+  EXPECT_EQ(grid.substeps.back(), 1);
+  EXPECT_NEAR(grid.duration(grid.steps() - 1), 0.05, 1e-9);
+  EXPECT_NEAR(grid.weight(grid.steps() - 1), 2.5, 1e-9);
+  EXPECT_NEAR(grid.times.back(), 2.0, 1e-9);
+  EXPECT_NEAR(WeightedDuration(grid), 2.0, 1e-9);
+}
+
+TEST(RolloutGridTest, FineDurationCoversHorizon) {
+  RolloutGridConfig config;
+  config.fine_duration = 5.0;
+  config.coarse_substep = 0.05;
+  RolloutGrid grid;
+  grid.Build(1.0, 0.02, config);
+  EXPECT_TRUE(grid.uniform());
+  EXPECT_EQ(grid.steps(), 50);
+}
+
+}  // namespace
+}  // namespace mjpc
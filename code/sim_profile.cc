@@ -0,0 +1,120 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/sim_profile.h"
+
+#include <cmath>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+namespace {
+
+bool AllFinite(const double* x, int n) {
+  for (int i = 0; i < n; i++) {
+    if (!std::isfinite(x[i])) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+void ApplySimProfile(mjModel* model, const SimProfile& profile) {
+  model->opt.integrator = profile.integrator;
+  model->opt.timestep = profile.timestep;
+}
+
+const char* StabilityMonitor::StatusName(Status status) {
+  switch (status) {
+    case kStable: return "stable";
+    case kNonFinite: return "non-finite state";
+    case kWarning: return "simulation warning";
+    case kEnergyGrowth: return "energy growth";
+    case kPenetration: return "contact penetration";
+  }
+  return "unknown";
+}
+
+double StabilityMonitor::Energy(const mjModel* model, mjData* data) const {
+  // 模型未开启 energy 标志时显式计算
+  if (!(model->opt.enableflags & mjENBL_ENERGY)) {
+    mj_energyPos(model, data);
+    mj_energyVel(model, data);
+  }
+  return data->energy[0] + data->energy[1];
+}
+
+void StabilityMonitor::Reset(const mjModel* model, mjData* data) {
+  last_energy_ = Energy(model, data);
+  last_time_ = data->time;
+  for (int i = 0; i < mjNWARNING; i++) {
+    warning_count_[i] = data->warning[i].number;
+  }
+
+  good_time_ = data->time;
+  good_qpos_.assign(data->qpos, data->qpos + model->nq);
+  good_qvel_.assign(data->qvel, data->qvel + model->nv);
+  good_act_.assign(data->act, data->act + model->na);
+}
+
+StabilityMonitor::Status StabilityMonitor::Check(const mjModel* model,
+                                                 mjData* data) {
+  // NaN / Inf
+  if (!AllFinite(data->qpos, model->nq) || !AllFinite(data->qvel, model->nv)) {
+    return kNonFinite;
+  }
+
+  // MuJoCo 警告计数增加（BADQACC 等会让 mj_step 自动重置状态）
+  bool warned = false;
+  for (int i = 0; i < mjNWARNING; i++) {
+    if (data->warning[i].number > warning_count_[i]) warned = true;
+    warning_count_[i] = data->warning[i].number;
+  }
+  if (warned) return kWarning;
+
+  // 能量增长率
+  double energy = Energy(model, data);
+  double dt = data->time - last_time_;
+  if (dt > 0.0 && (energy - last_energy_) / dt > limits_.max_energy_rate) {
+    return kEnergyGrowth;
+  }
+  last_energy_ = energy;
+  last_time_ = data->time;
+
+  // 接触穿透
+  for (int i = 0; i < data->ncon; i++) {
+    if (data->contact[i].dist < -limits_.max_penetration) return kPenetration;
+  }
+
+  // 正常：记录恢复点
+  good_time_ = data->time;
+  good_qpos_.assign(data->qpos, data->qpos + model->nq);
+  good_qvel_.assign(data->qvel, data->qvel + model->nv);
+  good_act_.assign(data->act, data->act + model->na);
+  return kStable;
+}
+
+void StabilityMonitor::Restore(const mjModel* model, mjData* data) {
+  if (good_qpos_.size() != static_cast<size_t>(model->nq)) return;
+  data->time = good_time_;
+  mju_copy(data->qpos, good_qpos_.data(), model->nq);
+  mju_copy(data->qvel, good_qvel_.data(), model->nv);
+  mju_copy(data->act, good_act_.data(), model->na);
+  mju_zero(data->qacc_warmstart, model->nv);
+  mj_forward(model, data);
+  Reset(model, data);
+}
+
+}  // namespace mjpc
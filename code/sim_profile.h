@@ -0,0 +1,89 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_SIM_PROFILE_H_
+#define MJPC_TASKS_SIMPLE_CAR_SIM_PROFILE_H_
+
+#include <vector>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 主仿真的积分器配置
+struct SimProfile {
+  const char* name;
+  int integrator;
+  double timestep;
+};
+
+// 精确配置：与 car_model.xml 一致（默认 Euler，0.002 s）
+inline constexpr SimProfile kAccurateSimProfile = {"accurate", mjINT_EULER,
+                                                   0.002};
+
+// 快速配置：隐式积分器，步长放大 4 倍
+inline constexpr SimProfile kFastSimProfile = {"fast", mjINT_IMPLICITFAST,
+                                               0.008};
+
+// 写入模型选项
+void ApplySimProfile(mjModel* model, const SimProfile& profile);
+
+// 稳定性阈值
+struct StabilityLimits {
+  double max_energy_rate = 500.0;  // 总能量增长率上限（J/s）
+  double max_penetration = 0.01;   // 接触穿透深度上限（m）
+};
+
+// 在线稳定性监测：能量增长、穿透深度、NaN 与 MuJoCo 警告计数
+//   每步调用 Check；检测到异常时可用 Restore 回到最近一次正常状态
+class StabilityMonitor {
+ public:
+  enum Status : int {
+    kStable = 0,
+    kNonFinite,
+    kWarning,
+    kEnergyGrowth,
+    kPenetration,
+  };
+
+  // 以当前状态为基准
+  void Reset(const mjModel* model, mjData* data);
+
+  // 检查当前状态；正常时保存为恢复点
+  Status Check(const mjModel* model, mjData* data);
+
+  // 恢复到最近一次正常状态并以其为新基准
+  void Restore(const mjModel* model, mjData* data);
+
+  void set_limits(const StabilityLimits& limits) { limits_ = limits; }
+  static const char* StatusName(Status status);
+
+ private:
+  double Energy(const mjModel* model, mjData* data) const;
+
+  StabilityLimits limits_;
+  double last_energy_ = 0.0;
+  double last_time_ = 0.0;
+  int warning_count_[mjNWARNING] = {0};
+
+  // 恢复点
+  double good_time_ = 0.0;
+  std::vector<double> good_qpos_;
+  std::vector<double> good_qvel_;
+  std::vector<double> good_act_;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_SIM_PROFILE_H_
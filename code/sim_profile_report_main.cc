@@ -0,0 +1,177 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 仿真配置对比报告：标准场景下快速配置相对精确配置的 RTF 提升与轨迹偏差
+//   sim_profile_report --duration=20 --fast_timesteps=0.004,0.008,0.02
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/tasks/simple_car/sim_profile.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(double, duration, 20.0, "scenario length (s)");
+ABSL_FLAG(double, sample_interval, 0.04, "trajectory comparison interval (s)");
+ABSL_FLAG(std::string, fast_timesteps, "0.004,0.008,0.02",
+          "fast-profile timesteps to evaluate (each must divide "
+          "sample_interval)");
+
+namespace {
+
+// 采样时刻必须落在步边界上，否则轨迹在不同时刻比较
+bool DividesInterval(double timestep, double interval) {
+  double ratio = interval / timestep;
+  return timestep > 0.0 && std::abs(ratio - std::round(ratio)) < 1e-6;
+}
+
+// 标准场景的开环控制
+void ScenarioControl(double time, double* ctrl) {
+  ctrl[0] = 0.8 * std::sin(0.5 * time);
+  ctrl[1] = 0.6 * std::sin(0.3 * time + 1.0);
+}
+
+struct ProfileRun {
+  double wall = 0.0;              // 墙钟时间（秒）
+  std::vector<double> samples;    // 每个采样时刻的 (x, y)
+  int fallback_step = -1;         // 回退发生的步数（-1 未回退）
+  const char* fallback_reason = "";
+};
+
+ProfileRun RunScenario(mjModel* model, const mjpc::SimProfile& profile,
+                       const mjpc::SimProfile& accurate, double duration,
+                       double interval, bool monitor) {
+  ProfileRun run;
+  mjData* data = mj_makeData(model);
+  mjpc::ApplySimProfile(model, profile);
+  if (model->nkey > 0) mj_resetDataKeyframe(model, data, 0);
+  mj_forward(model, data);
+
+  mjpc::StabilityMonitor stability;
+  stability.Reset(model, data);
+
+  double next_sample = 0.0;
+  int step = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (data->time < duration - 1e-9) {
+    // 按采样时刻记录（步长是采样间隔的约数）
+    if (data->time >= next_sample - 1e-9) {
+      run.samples.push_back(data->qpos[0]);
+      run.samples.push_back(data->qpos[1]);
+      next_sample += interval;
+    }
+
+    ScenarioControl(data->time, data->ctrl);
+    mj_step(model, data);
+    step++;
+
+    if (monitor && run.fallback_step < 0) {
+      mjpc::StabilityMonitor::Status status = stability.Check(model, data);
+      if (status != mjpc::StabilityMonitor::kStable) {
+        stability.Restore(model, data);
+        mjpc::ApplySimProfile(model, accurate);
+        run.fallback_step = step;
+        run.fallback_reason = mjpc::StabilityMonitor::StatusName(status);
+      }
+    }
+  }
+  run.wall = std::chrono::duration<double>(
+                 std::chrono::steady_clock::now() - start).count();
+
+  mj_deleteData(data);
+  mjpc::ApplySimProfile(model, accurate);
+  return run;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  char error[1000] = "";
+  mjModel* model = mj_loadXML(xml.c_str(), nullptr, error, sizeof(error));
+  if (!model) {
+    std::fprintf(stderr, "failed to load '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+
+  double duration = absl::GetFlag(FLAGS_duration);
+  double interval = absl::GetFlag(FLAGS_sample_interval);
+  mjpc::SimProfile accurate = {"accurate", model->opt.integrator,
+                               model->opt.timestep};
+  if (!DividesInterval(accurate.timestep, interval)) {
+    std::fprintf(stderr, "model timestep %g does not divide "
+                 "--sample_interval=%g\n", accurate.timestep, interval);
+    mj_deleteModel(model);
+    return 1;
+  }
+
+  ProfileRun reference =
+      RunScenario(model, accurate, accurate, duration, interval, false);
+  std::printf("%-10s %-9s %10s %10s %12s %12s  %s\n", "profile", "timestep",
+              "RTF", "speedup", "rms_err[m]", "max_err[m]", "fallback");
+  std::printf("%-10s %-9.4f %10.1f %10.2f %12.4f %12.4f  -\n", accurate.name,
+              accurate.timestep, duration / reference.wall, 1.0, 0.0, 0.0);
+
+  std::stringstream list(absl::GetFlag(FLAGS_fast_timesteps));
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    mjpc::SimProfile fast = mjpc::kFastSimProfile;
+    fast.timestep = std::stod(item);
+    if (!DividesInterval(fast.timestep, interval)) {
+      std::fprintf(stderr, "skipping timestep %g: does not divide "
+                   "--sample_interval=%g\n", fast.timestep, interval);
+      continue;
+    }
+
+    ProfileRun run =
+        RunScenario(model, fast, accurate, duration, interval, true);
+
+    // 同一时刻的位置偏差
+    size_t n = std::min(run.samples.size(), reference.samples.size()) / 2;
+    double sum = 0.0, max_error = 0.0;
+    for (size_t i = 0; i < n; i++) {
+      double error = std::hypot(run.samples[2 * i] - reference.samples[2 * i],
+                                run.samples[2 * i + 1] -
+                                    reference.samples[2 * i + 1]);
+      sum += error * error;
+      max_error = std::max(max_error, error);
+    }
+    double rms = n > 0 ? std::sqrt(sum / n) : 0.0;
+
+    char fallback[64] = "-";
+    if (run.fallback_step >= 0) {
+      std::snprintf(fallback, sizeof(fallback), "step %d (%s)",
+                    run.fallback_step, run.fallback_reason);
+    }
+    std::printf("%-10s %-9.4f %10.1f %10.2f %12.4f %12.4f  %s\n", fast.name,
+                fast.timestep, duration / run.wall, reference.wall / run.wall,
+                rms, max_error, fallback);
+  }
+
+  mj_deleteModel(model);
+  return 0;
+}
@@ -14,10 +14,17 @@
 
 #include "mjpc/tasks/simple_car/simple_car.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <mutex>
+#include <random>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include <absl/random/random.h>
 #include <mujoco/mujoco.h>
@@ -26,42 +33,80 @@
 
 namespace mjpc {
 
-std::string SimpleCar::XmlPath() const {
-  return GetModelPath("simple_car/task.xml");
+namespace {
+
+// 读取 <custom><text> 字符串，不存在时返回空
+std::string CustomText(const mjModel* model, std::string_view name) {
+  for (int i = 0; i < model->ntext; i++) {
+    if (name == model->names + model->name_textadr[i]) {
+      return std::string(model->text_data + model->text_adr[i]);
+    }
+  }
+  return std::string();
 }
 
-std::string SimpleCar::Name() const { return "SimpleCar"; }
+// 车头朝向（自由关节四元数绕 z 轴的偏航角）
+double CarHeading(const mjData* data) {
+  const double* q = data->qpos + 3;
+  return std::atan2(2.0 * (q[0] * q[3] + q[1] * q[2]),
+                    1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]));
+}
+
+}  // namespace
+
+template <typename Vehicle>
+std::string CarTask<Vehicle>::XmlPath() const {
+  return GetModelPath(Vehicle::kXmlPath);
+}
+
+template <typename Vehicle>
+std::string CarTask<Vehicle>::Name() const { return Vehicle::kName; }
 
 // ------- Residuals for simple_car task ------
-//     Position: Car should reach goal position (x, y)
-//     Control:  Controls should be small
+//     Position:  Car should reach goal position (x, y)
+//     Control:   Controls should be small
+//     Clearance: Car should keep away from the predicted
+//                positions of moving obstacles
 // ------------------------------------------
-void SimpleCar::ResidualFn::Residual(const mjModel* model, const mjData* data,
+template <typename Vehicle>
+void CarTask<Vehicle>::ResidualFn::Residual(const mjModel* model, const mjData* data,
                                      double* residual) const {
   // ---------- Position (x, y) ----------
   // Goal position from mocap body
-  residual[0] = data->qpos[0] - data->mocap_pos[0];  // x position
-  residual[1] = data->qpos[1] - data->mocap_pos[1];  // y position
+  if (has_next_goal_) {
+    // 下一个目标已知：剩余路程（到达当前目标后改为朝下一个目标）
+    //   锁存是 rollout 状态的一部分，残差评估是唯一能在 rollout 内更新它的地方
+    bool switched;
+    if (model->nuserdata >= kGoalLatchSize) {
+      double* latch = const_cast<mjData*>(data)->userdata;
+      switched = UpdateGoalLatch(data->qpos, data->mocap_pos, latch);
+    } else {
+      switched = GoalReached(data->qpos, data->mocap_pos);
+    }
+    RemainingRouteResidual(data->qpos, data->mocap_pos, next_goal_, switched,
+                           residual);
+  } else {
+    residual[0] = data->qpos[0] - data->mocap_pos[0];  // x position
+    residual[1] = data->qpos[1] - data->mocap_pos[1];  // y position
+  }
 
   // ---------- Control ----------
-  residual[2] = data->ctrl[0];  // forward control
-  residual[3] = data->ctrl[1];  // turn control
+  // forward / turn control, specialized per vehicle type
+  Vehicle::ControlResidual(model, data, residual + 2);
+
+  // ---------- Obstacle clearance ----------
+  double clearance =
+      obstacles_.MinClearance(data->qpos[0], data->qpos[1], data->time);
+  residual[4] = std::max(0.0, obstacle_margin_ - clearance);
 }
 
 // ============ 更新仪表盘数据 ============
-void SimpleCar::UpdateDashboardData(const mjModel* model, const mjData* data) const {
-  // 获取车身速度
-  double vx = data->qvel[0];  // X方向速度
-  double vy = data->qvel[1];  // Y方向速度
-  double speed = std::sqrt(vx * vx + vy * vy);
-  
-  // 转换为km/h
-  dashboard_.speed_kmh = speed * 3.6;
-
-  // 模拟转速
-  dashboard_.rpm = dashboard_.speed_kmh * 40.0 + 800.0;
-  if (dashboard_.rpm > 8000.0) dashboard_.rpm = 8000.0;
-  if (dashboard_.rpm < 800.0) dashboard_.rpm = 800.0;
+template <typename Vehicle>
+void CarTask<Vehicle>::UpdateDashboardData(const mjModel* model, const mjData* data) const {
+  // 车速与转速（按车型提取）
+  VehicleSignals signals = Vehicle::Signals(vehicle_, model, data);
+  dashboard_.speed_kmh = signals.speed_kmh;
+  dashboard_.rpm = signals.rpm;
 
   // 模拟油量消耗
   dashboard_.simulated_fuel -= 0.001;
@@ -81,33 +126,523 @@ void SimpleCar::UpdateDashboardData(const mjModel* model, const mjData* data) co
 
 // -------- Transition for simple_car task --------
 //   If car is within tolerance of goal ->
-//   move goal randomly.
+//   move goal to the next queued goal, or randomly.
 // ------------------------------------------------
-void SimpleCar::TransitionLocked(mjModel* model, mjData* data) {
+template <typename Vehicle>
+void CarTask<Vehicle>::TransitionLocked(mjModel* model, mjData* data) {
+  // 参数热重载与主仿真配置
+  PollParamReload(model);
+  UpdateSimProfile(model, data);
+  UpdateGaugeFaces(model);
+
   // Car position (x, y)
   double car_pos[2] = {data->qpos[0], data->qpos[1]};
   
   // Goal position from mocap
   double goal_pos[2] = {data->mocap_pos[0], data->mocap_pos[1]};
   
-  // Distance to goal
-  double car_to_goal[2];
-  mju_sub(car_to_goal, goal_pos, car_pos, 2);
-  
-  // If within tolerance, move goal to random position
-  if (mju_norm(car_to_goal, 2) < 0.2) {
-    absl::BitGen gen_;
-    data->mocap_pos[0] = absl::Uniform<double>(gen_, -2.0, 2.0);
-    data->mocap_pos[1] = absl::Uniform<double>(gen_, -2.0, 2.0);
-    data->mocap_pos[2] = 0.01;  // keep z at ground level
+  // 仿真被重置（时间回退）时重新开始计时
+  if (data->time < episode_.last_time) {
+    episode_.goal_start_time = data->time;
+    episode_.has_last_pos = false;
   }
 
-  // 更新仪表盘数据
+  // 扫掠检测：上一步位置 -> 当前位置的线段是否经过目标圆盘，
+  //   步长较大时也不会漏检，并插值出进入时刻
+  const double* previous_pos =
+      episode_.has_last_pos ? episode_.last_pos : car_pos;
+  double fraction = 0.0;
+  bool reached = SweptGoalReached(previous_pos, car_pos, goal_pos, &fraction);
+  double reach_time =
+      episode_.last_time + fraction * (data->time - episode_.last_time);
+  if (!episode_.has_last_pos) reach_time = data->time;
+
+  episode_.last_time = data->time;
+  episode_.last_pos[0] = car_pos[0];
+  episode_.last_pos[1] = car_pos[1];
+  episode_.has_last_pos = true;
+
+  // 移动障碍物：推进脚本并更新残差使用的快照
+  if (obstacles_pending_) {
+    obstacles_pending_ = false;
+    obstacle_script_.Initialize(model, data, obstacle_motion_,
+                                obstacle_speed_, episode_.seed);
+  }
+  obstacle_script_.Update(data, &residual_.obstacles_);
+
+  // 新回合：有目标队列时立即切换到队列中的第一个目标，
+  //   否则保留当前目标，只提前确定下一个
+  if (goals_pending_) {
+    goals_pending_ = false;
+    has_upcoming_goal_ = false;
+    if (model->nuserdata >= kGoalLatchSize) ClearGoalLatch(data->userdata);
+    if (!goal_route_.empty()) {
+      goal_route_.SetStart(car_pos, CarHeading(data));
+      goal_route_.Refine();
+      NextGoal(model, data);
+    } else {
+      DrawUpcomingGoal();
+    }
+    episode_.goal_start_time = data->time;
+  } else if (reached) {
+    // If within tolerance, move goal to next queued or random position
+    episode_.time_to_goal.push_back(reach_time - episode_.goal_start_time);
+    episode_.goal_start_time = reach_time;
+    NextGoal(model, data);
+  }
+
+  // 锁步外部控制器
+  UpdateLockstep(data);
+
+  // 更新仪表盘数据并发布给其它线程
   UpdateDashboardData(model, data);
+  PublishTelemetry(data);
+}
+
+// ============ 锁步外部控制器 ============
+//   每个控制周期登记一次交换；发布状态和等待外部控制量在 mj_step 的控制回调中进行，
+//   不占用任务锁（规划器线程读取残差参数时不被阻塞）
+template <typename Vehicle>
+void CarTask<Vehicle>::UpdateLockstep(mjData* data) {
+  if (!lockstep_.IsOpen()) return;
+
+  // 仿真被重置（时间回退）时重新对齐
+  if (data->time < lockstep_next_time_ - lockstep_period_) {
+    lockstep_next_time_ = data->time;
+  }
+  if (data->time < lockstep_next_time_) return;
+
+  RequestLockstepExchange(&lockstep_, data, lockstep_timeout_us_,
+                          lockstep_spin_us_);
+
+  lockstep_next_time_ += lockstep_period_;
+  if (lockstep_next_time_ <= data->time) {
+    lockstep_next_time_ = data->time + lockstep_period_;
+  }
+}
+
+// ============ 发布仪表盘快照 ============
+template <typename Vehicle>
+void CarTask<Vehicle>::PublishTelemetry(const mjData* data) {
+  DashboardSnapshot snapshot;
+  snapshot.time = data->time;
+  snapshot.speed_kmh = dashboard_.speed_kmh;
+  snapshot.rpm = dashboard_.rpm;
+  snapshot.fuel = dashboard_.fuel;
+  snapshot.temperature = dashboard_.temperature;
+  snapshot.x = data->qpos[0];
+  snapshot.y = data->qpos[1];
+  snapshot.heading = CarHeading(data);
+
+  // 告警每次发布评估一次，绘制时只读位掩码
+  dashboard_.alerts = alerts_.Update(snapshot);
+  snapshot.alerts = dashboard_.alerts;
+  snapshot.alert_events = static_cast<uint32_t>(alerts_.event_count());
+  telemetry_.Publish(snapshot);
+}
+
+// ============ 表盘贴图 ============
+//   红区起点跟随高转速告警阈值，阈值热重载后重新烘焙
+template <typename Vehicle>
+void CarTask<Vehicle>::UpdateGaugeFaces(mjModel* model) {
+  if (!gauge_faces_.valid()) return;
+  double warning = alerts_.rule(kAlertHighRpm).set / 8000.0;
+  if (!gauge_faces_pending_ && warning == gauge_faces_warning_) return;
+  gauge_faces_pending_ = false;
+  gauge_faces_warning_ = warning;
+  if (!BakeGaugeFaces(model, warning, &gauge_faces_)) return;
+  for (int i = 0; i < kNumGaugeFaces; i++) {
+    MakeGaugeFaceGeom(model, gauge_faces_, i, gauge_face_geoms_ + i);
+  }
+}
+
+template <typename Vehicle>
+void CarTask<Vehicle>::UploadGaugeFaces(const mjModel* model,
+                                        const mjrContext* context) {
+  int version = gauge_faces_.version;
+  if (version == 0 ||
+      version == gauge_faces_uploaded_.load(std::memory_order_acquire)) {
+    return;
+  }
+  ::mjpc::UploadGaugeFaces(model, context, gauge_faces_);
+  gauge_faces_uploaded_.store(version, std::memory_order_release);
+}
+
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawGaugeFace(mjvScene* scene, int face, float x,
+                                     float y) const {
+  if (scene->ngeom >= scene->maxgeom) return;
+  mjvGeom* geom = scene->geoms + scene->ngeom;
+  *geom = gauge_face_geoms_[face];
+  geom->pos[0] += x;
+  geom->pos[1] += y;
+  scene->ngeom++;
+}
+
+// ============ 主仿真配置 ============
+template <typename Vehicle>
+void CarTask<Vehicle>::UpdateSimProfile(mjModel* model, mjData* data) {
+  if (sim_profile_pending_) {
+    sim_profile_pending_ = false;
+    // 精确配置取 XML 中的原始设置
+    if (!fast_profile_active_) {
+      accurate_profile_.integrator = model->opt.integrator;
+      accurate_profile_.timestep = model->opt.timestep;
+    }
+    fast_profile_active_ = use_fast_profile_;
+    ApplySimProfile(model, fast_profile_active_ ? fast_profile_
+                                                : accurate_profile_);
+    stability_.Reset(model, data);
+    return;
+  }
+  if (!fast_profile_active_) return;
+
+  StabilityMonitor::Status status = stability_.Check(model, data);
+  if (status != StabilityMonitor::kStable) {
+    // 回到最近一次正常状态，并切换到精确配置
+    stability_.Restore(model, data);
+    ApplySimProfile(model, accurate_profile_);
+    fast_profile_active_ = false;
+    profile_fallbacks_++;
+    printf("%s: %s at t=%.3f, falling back to accurate profile\n",
+           Vehicle::kName, StabilityMonitor::StatusName(status), data->time);
+  }
+}
+
+// ============ 选择下一个目标 ============
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawUpcomingGoal() {
+  if (!goal_route_.PopNext(upcoming_goal_)) {
+    upcoming_goal_[0] = absl::Uniform<double>(goal_gen_, -2.0, 2.0);
+    upcoming_goal_[1] = absl::Uniform<double>(goal_gen_, -2.0, 2.0);
+  }
+  has_upcoming_goal_ = true;
+
+  // 残差使用的下一个目标
+  residual_.has_next_goal_ = goal_lookahead_;
+  residual_.next_goal_[0] = upcoming_goal_[0];
+  residual_.next_goal_[1] = upcoming_goal_[1];
+}
+
+template <typename Vehicle>
+void CarTask<Vehicle>::NextGoal(const mjModel* model, mjData* data) {
+  if (!has_upcoming_goal_) DrawUpcomingGoal();
+  data->mocap_pos[0] = upcoming_goal_[0];
+  data->mocap_pos[1] = upcoming_goal_[1];
+  data->mocap_pos[2] = 0.01;  // keep z at ground level
+  if (model->nuserdata >= kGoalLatchSize) ClearGoalLatch(data->userdata);
+  DrawUpcomingGoal();
+  warmup_requested_.store(true, std::memory_order_release);
+}
+
+template <typename Vehicle>
+void CarTask<Vehicle>::AddGoal(double x, double y) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  goal_route_.AddGoal(x, y);
+}
+
+// -------- Reset for simple_car task --------
+//   Flush the finished episode and start a new one.
+// -------------------------------------------
+template <typename Vehicle>
+void CarTask<Vehicle>::ResetLocked(const mjModel* model) {
+  double startup_begin = 0.0;
+  if (!startup_reset_done_) {
+    startup_begin = StartupProfiler::Global().NowMs();
+  }
+
+  FlushEpisode();
+  vehicle_.Initialize(model);
+
+  // 表盘贴图在下一次 Transition 时烘焙（需要可写的模型），
+  //   新模型的贴图上传之前用 geom 绘制
+  gauge_faces_.Initialize(model);
+  gauge_faces_pending_ = true;
+  gauge_faces_uploaded_.store(0, std::memory_order_release);
+
+  // 告警统计按回合输出
+  if (alerts_.event_count() > 0) alerts_.PrintMetrics();
+  alerts_.Reset();
+  dashboard_.alerts = 0;
+
+  // 结果存储路径：<text name="task_episode_store" data="..."/>
+  std::string path = CustomText(model, "task_episode_store");
+  if (!path.empty() && !episode_store_.IsOpen() &&
+      !episode_store_.Open(path)) {
+    printf("%s: failed to open episode store '%s'\n", Vehicle::kName,
+           path.c_str());
+  }
+
+  // 目标随机种子：task_seed 为 0 时使用非确定性种子
+  int seed = GetNumberOrDefault(0, model, "task_seed");
+  if (seed != 0) {
+    std::seed_seq seq{seed};
+    goal_gen_ = absl::BitGen(seq);
+  }
+
+  // 任务设置先于目标排序读取（转角权重参与 SetGoals 的排序）
+  has_upcoming_goal_ = false;
+  ReadTaskParameters(model);
+
+  // 目标集合：<numeric name="task_goals" data="x0 y0 x1 y1 ..."/>
+  goal_route_.Clear();
+  int goals = mj_name2id(model, mjOBJ_NUMERIC, "task_goals");
+  if (goals >= 0 && model->numeric_size[goals] >= 2) {
+    // 起点在第一次 Transition 时由车辆状态确定，这里先按原点排序
+    double origin[2] = {0.0, 0.0};
+    goal_route_.SetStart(origin, 0.0);
+    goal_route_.SetGoals(model->numeric_data + model->numeric_adr[goals],
+                         model->numeric_size[goals] / 2);
+  }
+  goals_pending_ = true;
+  residual_.has_next_goal_ = false;
+  warmup_requested_.store(true, std::memory_order_release);
+  sim_profile_pending_ = true;
+  residual_.obstacles_.Clear();
+  obstacles_pending_ = true;
+
+  // 参数热重载：task_param_reload 为检查 task.xml 的周期（秒，0 关闭）
+  param_reload_period_ = GetNumberOrDefault(0.0, model, "task_param_reload");
+  if (param_reload_period_ > 0.0 && !param_reloader_.IsInitialized() &&
+      !param_reloader_.Initialize(XmlPath())) {
+    printf("%s: failed to watch '%s'\n", Vehicle::kName, XmlPath().c_str());
+  }
+
+  // 仪表盘 WebSocket 推送：dashboard_stream_port 为 0 时关闭
+  int stream_port = GetNumberOrDefault(0, model, "dashboard_stream_port");
+  if (stream_port > 0 && !dashboard_stream_.IsRunning()) {
+    std::string address = CustomText(model, "dashboard_stream_address");
+    if (address.empty()) address = "127.0.0.1";
+    double rate = GetNumberOrDefault(20.0, model, "dashboard_stream_rate");
+    if (dashboard_stream_.Start(&telemetry_, stream_port, rate, address)) {
+      printf("%s: dashboard stream on http://%s:%d/\n", Vehicle::kName,
+             address.c_str(), stream_port);
+    } else {
+      printf("%s: failed to start dashboard stream on %s:%d\n", Vehicle::kName,
+             address.c_str(), stream_port);
+    }
+  }
+
+  // 仪表盘 CAN 报文：<text name="can_interface" data="vcan0"/>
+  std::string can_interface = CustomText(model, "can_interface");
+  if (can_sender_.IsRunning()) {
+    can_sender_.PrintJitter();
+  } else if (!can_interface.empty()) {
+    if (!can_sender_.Start(&telemetry_, can_interface)) {
+      printf("%s: failed to open CAN interface '%s'\n", Vehicle::kName,
+             can_interface.c_str());
+    }
+  }
+
+  // 锁步外部控制器：<text name="lockstep_shm" data="/simple_car_lockstep"/>
+  std::string lockstep_name = CustomText(model, "lockstep_shm");
+  if (lockstep_.IsOpen()) {
+    LockstepStats stats = lockstep_.stats();
+    printf("%s: lockstep %llu exchanges, %llu timeouts, "
+           "round trip mean %.2f us, max %.2f us\n",
+           Vehicle::kName, static_cast<unsigned long long>(stats.exchanges),
+           static_cast<unsigned long long>(stats.timeouts), stats.mean_us,
+           stats.max_us);
+    lockstep_.ResetStats();
+  } else if (!lockstep_name.empty() && !lockstep_.Open(lockstep_name, model)) {
+    printf("%s: failed to open lockstep shared memory '%s'\n",
+           Vehicle::kName, lockstep_name.c_str());
+  }
+  lockstep_period_ = GetNumberOrDefault(0.02, model, "lockstep_period");
+  lockstep_timeout_us_ =
+      1e3 * GetNumberOrDefault(5.0, model, "lockstep_timeout_ms");
+  lockstep_spin_us_ = GetNumberOrDefault(20.0, model, "lockstep_spin_us");
+  lockstep_next_time_ = 0.0;
+
+  episode_ = EpisodeStats();
+  episode_.seed = seed;
+  episode_.wall_start = std::chrono::steady_clock::now();
+
+  if (!startup_reset_done_) {
+    startup_reset_done_ = true;
+    if (StartupProfiler::Enabled()) {
+      StartupProfiler& profiler = StartupProfiler::Global();
+      profiler.Add("SimpleCar first reset", startup_begin,
+                   profiler.NowMs() - startup_begin, 0);
+    }
+  }
+}
+
+// ============ 任务设置 ============
+//   Reset 与参数热重载共用；只在取值变化时重新初始化对应部分
+template <typename Vehicle>
+void CarTask<Vehicle>::ReadTaskParameters(const mjModel* model) {
+  // 转角权重变化（热重载）时在当前顺序上重新做局部改进
+  double turn_weight = GetNumberOrDefault(0.3, model, "task_route_turn_weight");
+  if (turn_weight != goal_route_.turn_weight()) {
+    goal_route_.SetTurnWeight(turn_weight);
+    if (!goal_route_.empty()) goal_route_.Refine();
+  }
+
+  // 规划时预见下一个目标（0 关闭，恢复只看当前目标）
+  goal_lookahead_ = GetNumberOrDefault(1, model, "task_goal_lookahead") != 0;
+  residual_.has_next_goal_ = goal_lookahead_ && has_upcoming_goal_;
+
+  // 主仿真配置：0 精确（XML 设置），1 快速（隐式积分器 + 大步长）
+  bool use_fast = GetNumberOrDefault(0, model, "task_sim_profile") == 1;
+  double fast_timestep = GetNumberOrDefault(kFastSimProfile.timestep, model,
+                                            "task_sim_fast_timestep");
+  if (use_fast != use_fast_profile_ ||
+      fast_timestep != fast_profile_.timestep) {
+    use_fast_profile_ = use_fast;
+    fast_profile_.timestep = fast_timestep;
+    sim_profile_pending_ = true;
+  }
+
+  // 移动障碍物参数
+  int motion =
+      GetNumberOrDefault(ObstacleScript::kCircle, model, "task_obstacle_motion");
+  double speed = GetNumberOrDefault(0.3, model, "task_obstacle_speed");
+  if (motion != obstacle_motion_ || speed != obstacle_speed_) {
+    obstacle_motion_ = motion;
+    obstacle_speed_ = speed;
+    obstacles_pending_ = true;
+  }
+  residual_.obstacle_margin_ =
+      GetNumberOrDefault(0.3, model, "task_obstacle_margin");
+
+  // 告警阈值：<numeric name="alert_high_rpm" data="set clear min_on min_off"/>
+  alerts_.ReadRules(model);
+
+  // 仪表盘由查看器按面板缓存合成（dashboard_panel.h）
+  dashboard_overlay_ = GetNumberOrDefault(0, model, "dashboard_overlay") != 0;
+
+  // 视锥剔除与最小投影尺寸（占视口高度的比例）
+  view_culling_ = GetNumberOrDefault(1, model, "view_culling") != 0;
+  cull_min_size_ = GetNumberOrDefault(0.01, model, "view_cull_min_size");
+}
+
+// ============ 参数热重载 ============
+//   只有 numeric / 代价参数变化时直接修改模型并更新任务，不重新编译
+template <typename Vehicle>
+void CarTask<Vehicle>::PollParamReload(mjModel* model) {
+  if (param_reload_period_ <= 0.0) return;
+  auto now = std::chrono::steady_clock::now();
+  if (now - param_reload_last_ <
+      std::chrono::duration<double>(param_reload_period_)) {
+    return;
+  }
+  param_reload_last_ = now;
+
+  ParamChange change;
+  switch (param_reloader_.Poll(model, &change)) {
+    case ParamReloader::kParameters:
+      if (change.residual) {
+        // 已持有 mutex_，直接更新内部残差
+        ApplyCostParameters(model, this);
+        InternalResidual()->Update();
+      }
+      if (change.task) ReadTaskParameters(model);
+      printf("%s: reloaded %zu parameter(s)%s\n", Vehicle::kName,
+             change.names.size(),
+             change.planner ? " (planner settings sent to listeners)" : "");
+      // 规划器设置由监听者应用：此处持有 mutex_，只记下变化，
+      //   DispatchParamReload 释放锁后再通知
+      if (param_change_pending_) {
+        for (std::string& name : change.names) {
+          pending_param_change_.names.push_back(std::move(name));
+        }
+        pending_param_change_.planner |= change.planner;
+        pending_param_change_.residual |= change.residual;
+        pending_param_change_.task |= change.task;
+      } else {
+        pending_param_change_ = std::move(change);
+        param_change_pending_ = true;
+      }
+      break;
+    case ParamReloader::kFull:
+      printf("%s: %s structure changed, full reload required\n",
+             Vehicle::kName, Vehicle::kXmlPath);
+      break;
+    case ParamReloader::kUnchanged:
+      break;
+  }
+}
+
+template <typename Vehicle>
+void CarTask<Vehicle>::AddParamReloadListener(ParamListener listener) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  param_listeners_.push_back(std::move(listener));
+}
+
+template <typename Vehicle>
+bool CarTask<Vehicle>::DispatchParamReload() {
+  // 在锁内取出变化并复制快照和监听者，监听者可以再调用任务的加锁接口
+  ParamChange change;
+  ParamSnapshot snapshot;
+  std::vector<ParamListener> listeners;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!param_change_pending_) return false;
+    param_change_pending_ = false;
+    change = std::move(pending_param_change_);
+    pending_param_change_ = ParamChange();
+    snapshot = param_reloader_.snapshot();
+    listeners = param_listeners_;
+  }
+  change.snapshot = &snapshot;
+  for (const ParamListener& listener : listeners) listener(change);
+  return true;
+}
+
+template <typename Vehicle>
+void CarTask<Vehicle>::PollParameters(mjModel* model) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PollParamReload(model);
+  }
+  DispatchParamReload();
+}
+
+// ============ 写入回合摘要 ============
+template <typename Vehicle>
+void CarTask<Vehicle>::FlushEpisode() {
+  if (!episode_store_.IsOpen() || episode_.last_time <= 0.0) return;
+
+  EpisodeRecord record;
+  record.seed = episode_.seed;
+  record.wall_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+
+  record.num_parameters =
+      std::min<int>(parameters.size(), kEpisodeMaxParameters);
+  for (int i = 0; i < record.num_parameters; i++) {
+    record.parameters[i] = parameters[i];
+  }
+  record.param_hash =
+      HashEpisodeParameters(record.parameters, record.num_parameters);
+
+  // 到达目标耗时统计
+  std::vector<double>& times = episode_.time_to_goal;
+  record.num_goals = times.size();
+  if (!times.empty()) {
+    double sum = 0.0;
+    for (double t : times) sum += t;
+    record.time_to_goal_mean = sum / times.size();
+    record.time_to_goal_min = *std::min_element(times.begin(), times.end());
+    record.time_to_goal_max = *std::max_element(times.begin(), times.end());
+    // 与查询工具相同的插值分位数
+    record.time_to_goal_p95 = EpisodePercentile(&times, 0.95);
+  }
+
+  // 实时率
+  record.sim_time = episode_.last_time;
+  double wall = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - episode_.wall_start)
+                    .count();
+  record.rtf = wall > 0.0 ? episode_.last_time / wall : 0.0;
+
+  episode_store_.Append(record);
 }
 
 // ============ 2D绘制辅助函数 ============
-void SimpleCar::Draw2DRectangle(mjvScene* scene, float x, float y, float width, float height,
+template <typename Vehicle>
+void CarTask<Vehicle>::Draw2DRectangle(mjvScene* scene, float x, float y, float width, float height,
                                float r, float g, float b, float a) const {
   if (scene->ngeom >= scene->maxgeom) return;
   
@@ -140,7 +675,8 @@ void SimpleCar::Draw2DRectangle(mjvScene* scene, float x, float y, float width,
   scene->ngeom++;
 }
 
-void SimpleCar::Draw2DLine(mjvScene* scene, float x1, float y1,
+template <typename Vehicle>
+void CarTask<Vehicle>::Draw2DLine(mjvScene* scene, float x1, float y1,
                           float x2, float y2, float width,
                           float r, float g, float b, float a) const {
   // 使用一个薄的BOX作为线条
@@ -182,7 +718,8 @@ void SimpleCar::Draw2DLine(mjvScene* scene, float x1, float y1,
   scene->ngeom++;
 }
 
-void SimpleCar::Draw2DCircle(mjvScene* scene, float x, float y, float radius,
+template <typename Vehicle>
+void CarTask<Vehicle>::Draw2DCircle(mjvScene* scene, float x, float y, float radius,
                             float r, float g, float b, float a) const {
   if (scene->ngeom >= scene->maxgeom) return;
   
@@ -216,16 +753,23 @@ void SimpleCar::Draw2DCircle(mjvScene* scene, float x, float y, float radius,
 }
 
 // ============ 2D速度表（调整为0-50 km/h范围） ============
-void SimpleCar::DrawSpeedometer2D(mjvScene* scene, float x, float y, float size) const {
-  // 表盘背景（亮灰色圆形）
-  Draw2DCircle(scene, x, y, size, 0.7f, 0.7f, 0.75f, 0.7f);  // 降低透明度到0.7
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawSpeedometer2D(mjvScene* scene, float x, float y, float size) const {
+  // 烘焙的表盘：外圈、刻度、数字和单位都在贴图里
+  bool baked = gauge_faces_.version > 0 && GaugeFacesUploaded();
+  if (baked) {
+    DrawGaugeFace(scene, kGaugeSpeedometer, x, y);
+  } else {
+    // 表盘背景（亮灰色圆形）
+    Draw2DCircle(scene, x, y, size, 0.7f, 0.7f, 0.75f, 0.7f);  // 降低透明度到0.7
   
-  // 外圈边框（亮蓝色）
-  Draw2DCircle(scene, x, y, size * 1.05f, 0.4f, 0.7f, 1.0f, 0.6f);  // 降低透明度到0.6
-  Draw2DCircle(scene, x, y, size * 0.95f, 0.3f, 0.3f, 0.4f, 0.8f);  // 降低透明度到0.8
+    // 外圈边框（亮蓝色）
+    Draw2DCircle(scene, x, y, size * 1.05f, 0.4f, 0.7f, 1.0f, 0.6f);  // 降低透明度到0.6
+    Draw2DCircle(scene, x, y, size * 0.95f, 0.3f, 0.3f, 0.4f, 0.8f);  // 降低透明度到0.8
+  }
   
   // 刻度线（保持12个刻度）
-  for (int i = 0; i < 12; i++) {
+  for (int i = 0; i < 12 && !baked; i++) {
     float angle = i * (2.0f * M_PI / 12.0f);
     float cos_a = std::cos(angle);
     float sin_a = std::sin(angle);
@@ -240,7 +784,7 @@ void SimpleCar::DrawSpeedometer2D(mjvScene* scene, float x, float y, float size)
   }
   
   // 主要刻度
-  for (int i = 0; i < 4; i++) {
+  for (int i = 0; i < 4 && !baked; i++) {
     float angle = i * (2.0f * M_PI / 4.0f);
     float cos_a = std::cos(angle);
     float sin_a = std::sin(angle);
@@ -256,7 +800,7 @@ void SimpleCar::DrawSpeedometer2D(mjvScene* scene, float x, float y, float size)
   
   // 数字标签（0, 10, 20, 30, 40, 50 km/h）- 改为0-50范围
   // 总共显示6个标签
-  for (int i = 0; i < 6; i++) {
+  for (int i = 0; i < 6 && !baked; i++) {
     float angle = i * (2.0f * M_PI / 6.0f);  // 6等分
     float cos_a = std::cos(angle - M_PI/2.0f);  // 从顶部开始
     float sin_a = std::sin(angle - M_PI/2.0f);
@@ -300,25 +844,35 @@ void SimpleCar::DrawSpeedometer2D(mjvScene* scene, float x, float y, float size)
   AddLabel(scene, x, y, 0.02f, speed_text, 0.15f, 0.15f, 0.1f, 0.9f);
   
   // 单位标签
-  AddLabel(scene, x, y - size * 0.25f, 0.02f, "km/h", 0.08f, 0.0f, 0.3f, 0.8f);
+  if (!baked) {
+    AddLabel(scene, x, y - size * 0.25f, 0.02f, "km/h", 0.08f, 0.0f, 0.3f, 0.8f);
+  }
   
   // 标题
   AddLabel(scene, x, y + size * 1.2f, 0.02f, "SPEED", 0.15f, 0.0f, 0.5f, 1.0f);
 }
 
 // ============ 2D转速表 ============
-void SimpleCar::DrawTachometer2D(mjvScene* scene, float x, float y, float size) const {
-  // 表盘背景（亮米色圆形）
-  Draw2DCircle(scene, x, y, size, 0.75f, 0.75f, 0.7f, 0.7f);  // 降低透明度到0.7
-  
-  // 外圈边框（亮橙色）
-  Draw2DCircle(scene, x, y, size * 1.05f, 1.0f, 0.6f, 0.3f, 0.6f);  // 降低透明度到0.6
-  Draw2DCircle(scene, x, y, size * 0.95f, 0.4f, 0.3f, 0.2f, 0.8f);  // 降低透明度到0.8
-  
-  // 红色警告区域（6000-8000 RPM）
-  if (dashboard_.rpm > 6000.0) {
-    float warning_ratio = (dashboard_.rpm - 6000.0f) / 2000.0f;
-    if (warning_ratio > 1.0f) warning_ratio = 1.0f;
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawTachometer2D(mjvScene* scene, float x, float y, float size) const {
+  // 烘焙的表盘：外圈、红区、刻度、数字和单位都在贴图里
+  bool baked = gauge_faces_.version > 0 && GaugeFacesUploaded();
+  if (baked) {
+    DrawGaugeFace(scene, kGaugeTachometer, x, y);
+  } else {
+    // 表盘背景（亮米色圆形）
+    Draw2DCircle(scene, x, y, size, 0.75f, 0.75f, 0.7f, 0.7f);  // 降低透明度到0.7
+  
+    // 外圈边框（亮橙色）
+    Draw2DCircle(scene, x, y, size * 1.05f, 1.0f, 0.6f, 0.3f, 0.6f);  // 降低透明度到0.6
+    Draw2DCircle(scene, x, y, size * 0.95f, 0.4f, 0.3f, 0.2f, 0.8f);  // 降低透明度到0.8
+  }
+  
+  // 红色警告区域（告警阈值-8000 RPM），回差区间内保持最低亮度
+  if (dashboard_.alerts & AlertBit(kAlertHighRpm)) {
+    float threshold = alerts_.rule(kAlertHighRpm).set;
+    float warning_ratio = (dashboard_.rpm - threshold) / (8000.0f - threshold);
+    warning_ratio = std::clamp(warning_ratio, 0.2f, 1.0f);
     
     for (int i = 0; i < 3; i++) {
       float alpha = 0.3f + 0.7f * (i / 3.0f);
@@ -328,7 +882,7 @@ void SimpleCar::DrawTachometer2D(mjvScene* scene, float x, float y, float size)
   }
   
   // 刻度线
-  for (int i = 0; i < 12; i++) {
+  for (int i = 0; i < 12 && !baked; i++) {
     float angle = i * (2.0f * M_PI / 12.0f);
     float cos_a = std::cos(angle);
     float sin_a = std::sin(angle);
@@ -343,7 +897,7 @@ void SimpleCar::DrawTachometer2D(mjvScene* scene, float x, float y, float size)
   }
   
   // 数字标签（0, 2, 4, 6, 8 x1000）
-  for (int i = 0; i < 5; i++) {
+  for (int i = 0; i < 5 && !baked; i++) {
     float angle = i * (2.0f * M_PI / 5.0f);
     float cos_a = std::cos(angle - M_PI/2.0f);
     float sin_a = std::sin(angle - M_PI/2.0f);
@@ -387,19 +941,23 @@ void SimpleCar::DrawTachometer2D(mjvScene* scene, float x, float y, float size)
   AddLabel(scene, x, y, 0.02f, rpm_text, 0.15f, 0.15f, 0.1f, 0.9f);
   
   // 单位标签
-  AddLabel(scene, x, y - size * 0.25f, 0.02f, "RPM", 0.08f, 0.0f, 0.3f, 0.8f);
+  if (!baked) {
+    AddLabel(scene, x, y - size * 0.25f, 0.02f, "RPM", 0.08f, 0.0f, 0.3f, 0.8f);
+  }
   
   // 标题
   AddLabel(scene, x, y + size * 1.2f, 0.02f, "TACHOMETER", 0.15f, 1.0f, 0.5f, 0.0f);
   
   // 高转速警告
-  if (dashboard_.rpm > 6000.0) {
-    AddLabel(scene, x, y - size * 1.4f, 0.02f, "HIGH RPM!", 0.12f, 1.0f, 0.1f, 0.1f);
+  if (dashboard_.alerts & AlertBit(kAlertHighRpm)) {
+    AddLabel(scene, x, y - size * 1.4f, 0.02f,
+             alerts_.rule(kAlertHighRpm).label, 0.12f, 1.0f, 0.1f, 0.1f);
   }
 }
 
 // ============ 2D油量表（简化版） ============
-void SimpleCar::DrawFuelGauge2D(mjvScene* scene, float x, float y, float width, float height) const {
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawFuelGauge2D(mjvScene* scene, float x, float y, float width, float height) const {
   // 移除外部背景和边框，直接绘制油量条
   // 油量条 - 根据油量百分比动态变化
   float fuel_width = (dashboard_.fuel / 100.0f) * width;  // 直接使用全部宽度
@@ -412,7 +970,7 @@ void SimpleCar::DrawFuelGauge2D(mjvScene* scene, float x, float y, float width,
     
     if (dashboard_.fuel > 50.0f) {
       fuel_color_r = 0.2f; fuel_color_g = 1.0f; fuel_color_b = 0.2f;  // 绿色
-    } else if (dashboard_.fuel > 20.0f) {
+    } else if (!(dashboard_.alerts & AlertBit(kAlertLowFuel))) {
       fuel_color_r = 1.0f; fuel_color_g = 1.0f; fuel_color_b = 0.2f;  // 黄色
     } else {
       fuel_color_r = 1.0f; fuel_color_g = 0.2f; fuel_color_b = 0.2f;  // 红色
@@ -428,8 +986,8 @@ void SimpleCar::DrawFuelGauge2D(mjvScene* scene, float x, float y, float width,
                     fuel_width, fuel_height, 
                     0.0f, 0.0f, 0.0f, 0.3f);  // 黑色边框
     
-    // 添加油量变化动画效果（当油量低于20%时闪烁）
-    if (dashboard_.fuel < 20.0f) {
+    // 添加油量变化动画效果（低油量告警时闪烁）
+    if (dashboard_.alerts & AlertBit(kAlertLowFuel)) {
       static float blink_timer = 0.0f;
       blink_timer += 0.1f;  // 简单的计时器
       if (fmod(blink_timer, 1.0f) > 0.5f) {
@@ -448,8 +1006,9 @@ void SimpleCar::DrawFuelGauge2D(mjvScene* scene, float x, float y, float width,
   AddLabel(scene, x, y + height * 0.8f, 0.02f, fuel_text, 0.1f, 0.1f, 0.1f, 1.0f);
   
   // 低油量警告
-  if (dashboard_.fuel < 20.0) {
-    AddLabel(scene, x, y - height * 0.8f, 0.02f, "LOW FUEL!", 0.12f, 1.0f, 0.1f, 0.1f);
+  if (dashboard_.alerts & AlertBit(kAlertLowFuel)) {
+    AddLabel(scene, x, y - height * 0.8f, 0.02f,
+             alerts_.rule(kAlertLowFuel).label, 0.12f, 1.0f, 0.1f, 0.1f);
   }
   
   // 添加油量刻度线（简化版）
@@ -462,7 +1021,8 @@ void SimpleCar::DrawFuelGauge2D(mjvScene* scene, float x, float y, float width,
 }
 
 // ============ 2D温度表（简化版） ============
-void SimpleCar::DrawTemperatureGauge2D(mjvScene* scene, float x, float y, float width, float height) const {
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawTemperatureGauge2D(mjvScene* scene, float x, float y, float width, float height) const {
   // 移除外部背景和边框，直接绘制温度条
   float min_temp = 60.0f;
   float max_temp = 120.0f;
@@ -512,7 +1072,7 @@ void SimpleCar::DrawTemperatureGauge2D(mjvScene* scene, float x, float y, float
                     0.0f, 0.0f, 0.0f, 0.3f);  // 黑色边框
     
     // 添加温度过高动画效果
-    if (dashboard_.temperature > 100.0f) {
+    if (dashboard_.alerts & AlertBit(kAlertOverheat)) {
       static float heat_timer = 0.0f;
       heat_timer += 0.05f;
       float pulse = 0.3f + 0.3f * sin(heat_timer * 5.0f);  // 脉冲效果
@@ -529,8 +1089,9 @@ void SimpleCar::DrawTemperatureGauge2D(mjvScene* scene, float x, float y, float
   AddLabel(scene, x, y + height * 0.8f, 0.02f, temp_text, 0.1f, 0.1f, 0.1f, 1.0f);
   
   // 高温警告
-  if (dashboard_.temperature > 100.0) {
-    AddLabel(scene, x, y - height * 0.8f, 0.02f, "OVERHEAT!", 0.12f, 1.0f, 0.1f, 0.1f);
+  if (dashboard_.alerts & AlertBit(kAlertOverheat)) {
+    AddLabel(scene, x, y - height * 0.8f, 0.02f,
+             alerts_.rule(kAlertOverheat).label, 0.12f, 1.0f, 0.1f, 0.1f);
   }
   
   // 添加温度刻度线（简化版）
@@ -554,7 +1115,8 @@ void SimpleCar::DrawTemperatureGauge2D(mjvScene* scene, float x, float y, float
 }
 
 // ============ 添加标签 ============
-void SimpleCar::AddLabel(mjvScene* scene, float x, float y, float z, const char* text, 
+template <typename Vehicle>
+void CarTask<Vehicle>::AddLabel(mjvScene* scene, float x, float y, float z, const char* text, 
                         float size, float r, float g, float b) const {
   if (scene->ngeom < scene->maxgeom) {
     mjvGeom* geom = scene->geoms + scene->ngeom;
@@ -574,37 +1136,128 @@ void SimpleCar::AddLabel(mjvScene* scene, float x, float y, float z, const char*
   }
 }
 
-// draw task-related geometry in the scene
-void SimpleCar::ModifyScene(const mjModel* model, const mjData* data,
-                             mjvScene* scene) const {
-  // 检查 scene 是否有效
-  if (!scene || scene->maxgeom == 0) return;
-  
-  // ===== 在屏幕上方固定位置绘制仪表盘 =====
-  // 使用相对坐标，将仪表盘放在屏幕顶部中间
-  
+// ============ 视锥剔除 ============
+//   radius 为 0（固定像素大小的标签）时只做视锥判断
+template <typename Vehicle>
+bool CarTask<Vehicle>::Visible(const ViewFrustum* view, float x, float y,
+                               float z, float radius) const {
+  if (!view) return true;
+  const float center[3] = {x, y, z};
+  ViewFrustum::Result result =
+      view->Test(center, radius, radius > 0.0f ? cull_min_size_ : 0.0);
+  cull_stats_.frame_tested++;
+  cull_stats_.total_tested++;
+  if (result == ViewFrustum::kOutside) {
+    cull_stats_.frame_frustum++;
+    cull_stats_.total_frustum++;
+  } else if (result == ViewFrustum::kTooSmall) {
+    cull_stats_.frame_size++;
+    cull_stats_.total_size++;
+  }
+  return result == ViewFrustum::kVisible;
+}
+
+// ============ 仪表盘面板 ============
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawDashboard(mjvScene* scene) const {
+  DrawDashboard(scene, nullptr);
+}
+
+template <typename Vehicle>
+void CarTask<Vehicle>::DrawDashboard(mjvScene* scene,
+                                     const ViewFrustum* view) const {
+  // 使用相对坐标，将仪表盘放在屏幕顶部中间（范围见 kDashboardRegion）
   float screen_center_x = 0.0f;  // 屏幕中心
   float screen_top = 3.0f;       // 屏幕顶部位置
   
   // ===== 绘制仪表盘标题 =====
-  AddLabel(scene, screen_center_x, screen_top - 0.5f, 0.5f, 
-           "CAR DASHBOARD", 0.25f, 0.0f, 0.5f, 1.0f);
+  if (Visible(view, screen_center_x, screen_top - 0.5f, 0.5f, 0.0f)) {
+    AddLabel(scene, screen_center_x, screen_top - 0.5f, 0.5f, 
+             "CAR DASHBOARD", 0.25f, 0.0f, 0.5f, 1.0f);
+  }
   
   // ===== 绘制仪表（固定在屏幕上方） =====
+  // 圆形表的包围球覆盖外圈、上方标题和下方告警文字（1.4 倍尺寸）
   // 速度表（左侧）
-  DrawSpeedometer2D(scene, screen_center_x - 2.5f, screen_top - 2.0f, 0.8f);
+  if (Visible(view, screen_center_x - 2.5f, screen_top - 2.0f, 0.0f, 1.45f * 0.8f)) {
+    DrawSpeedometer2D(scene, screen_center_x - 2.5f, screen_top - 2.0f, 0.8f);
+  }
   
   // 转速表（右侧）
-  DrawTachometer2D(scene, screen_center_x + 2.5f, screen_top - 2.0f, 0.8f);
+  if (Visible(view, screen_center_x + 2.5f, screen_top - 2.0f, 0.0f, 1.45f * 0.8f)) {
+    DrawTachometer2D(scene, screen_center_x + 2.5f, screen_top - 2.0f, 0.8f);
+  }
+  
+  // 条形表的矩形半宽为 width、半高为 height（Draw2DRectangle 的 size）
+  float bar_radius = std::hypot(1.5f, 0.4f);
   
   // 油量表（左下方，简化版）
-  DrawFuelGauge2D(scene, screen_center_x - 2.5f, screen_top - 3.5f, 1.5f, 0.4f);
+  if (Visible(view, screen_center_x - 2.5f, screen_top - 3.5f, 0.0f, bar_radius)) {
+    DrawFuelGauge2D(scene, screen_center_x - 2.5f, screen_top - 3.5f, 1.5f, 0.4f);
+  }
   
   // 温度表（右下方，简化版）
-  DrawTemperatureGauge2D(scene, screen_center_x + 2.5f, screen_top - 3.5f, 1.5f, 0.4f);
+  if (Visible(view, screen_center_x + 2.5f, screen_top - 3.5f, 0.0f, bar_radius)) {
+    DrawTemperatureGauge2D(scene, screen_center_x + 2.5f, screen_top - 3.5f, 1.5f, 0.4f);
+  }
+}
+
+template <typename Vehicle>
+uint64_t CarTask<Vehicle>::DashboardVersion() const {
+  // 数值按显示精度量化；闪烁/脉冲动画进行中时每次都视为变化
+  if (dashboard_.alerts &
+      (AlertBit(kAlertLowFuel) | AlertBit(kAlertOverheat))) {
+    dashboard_animation_++;
+  }
+  const int64_t key[6] = {
+      std::llround(dashboard_.speed_kmh * 10.0),
+      std::llround(dashboard_.rpm),
+      std::llround(dashboard_.fuel * 10.0),
+      std::llround(dashboard_.temperature * 10.0),
+      static_cast<int64_t>(dashboard_.alerts),
+      static_cast<int64_t>(dashboard_animation_),
+  };
+  // FNV-1a
+  uint64_t hash = 1469598103934665603ULL;
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key);
+  for (size_t i = 0; i < sizeof(key); i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+// draw task-related geometry in the scene
+template <typename Vehicle>
+void CarTask<Vehicle>::ModifyScene(const mjModel* model, const mjData* data,
+                             mjvScene* scene) const {
+  // 检查 scene 是否有效
+  if (!scene || scene->maxgeom == 0) return;
+
+  // 第一次调用时按需输出启动耗时分解
+  double startup_begin = 0.0;
+  if (!startup_reported_) {
+    startup_begin = StartupProfiler::Global().NowMs();
+  }
+  
+  // ===== 视锥剔除 =====
+  //   scene->camera 已由 mjv_updateScene 按当前相机填好
+  ViewFrustum frustum(scene);
+  const ViewFrustum* view =
+      view_culling() && frustum.valid() ? &frustum : nullptr;
+  cull_stats_.frames++;
+  cull_stats_.frame_tested = 0;
+  cull_stats_.frame_frustum = 0;
+  cull_stats_.frame_size = 0;
+
+  // ===== 在屏幕上方固定位置绘制仪表盘 =====
+  // 面板缓存开启时由查看器合成，这里跳过
+  dashboard_geoms_[0] = scene->ngeom;
+  if (!dashboard_overlay_) DrawDashboard(scene, view);
+  dashboard_geoms_[1] = scene->ngeom;
   
   // ===== 绘制目标标记（红色球）- 原有3D物体 =====
-  if (scene->ngeom < scene->maxgeom) {
+  if (scene->ngeom < scene->maxgeom &&
+      Visible(view, data->mocap_pos[0], data->mocap_pos[1], 0.2f, 0.15f)) {
     mjvGeom* geom = scene->geoms + scene->ngeom;
     geom->type = mjGEOM_SPHERE;
     geom->size[0] = geom->size[1] = geom->size[2] = 0.15;
@@ -619,7 +1272,10 @@ void SimpleCar::ModifyScene(const mjModel* model, const mjData* data,
   
   // 车辆当前位置标签 - 跟随车辆移动
   int car_body_id = mj_name2id(model, mjOBJ_BODY, "car");
-  if (car_body_id >= 0) {
+  if (car_body_id >= 0 &&
+      Visible(view, data->xpos[3 * car_body_id],
+              data->xpos[3 * car_body_id + 1],
+              data->xpos[3 * car_body_id + 2] + 2.0f, 0.0f)) {
     double* car_pos = data->xpos + 3 * car_body_id;
     char pos_text[50];
     // 显示车辆的位置坐标，而不是温度
@@ -629,10 +1285,25 @@ void SimpleCar::ModifyScene(const mjModel* model, const mjData* data,
   
   // ===== 绘制目标位置标签 =====
   // 在红色球上方添加目标位置标签
-  char goal_text[50];
-  std::snprintf(goal_text, sizeof(goal_text), "Goal: (%.2f, %.2f)", 
-                data->mocap_pos[0], data->mocap_pos[1]);
-  AddLabel(scene, data->mocap_pos[0], data->mocap_pos[1], 0.5f, goal_text, 0.1f, 1.0f, 0.0f, 0.0f);
+  if (Visible(view, data->mocap_pos[0], data->mocap_pos[1], 0.5f, 0.0f)) {
+    char goal_text[50];
+    std::snprintf(goal_text, sizeof(goal_text), "Goal: (%.2f, %.2f)", 
+                  data->mocap_pos[0], data->mocap_pos[1]);
+    AddLabel(scene, data->mocap_pos[0], data->mocap_pos[1], 0.5f, goal_text, 0.1f, 1.0f, 0.0f, 0.0f);
+  }
+
+  if (!startup_reported_) {
+    startup_reported_ = true;
+    if (StartupProfiler::Enabled()) {
+      StartupProfiler& profiler = StartupProfiler::Global();
+      profiler.Add("SimpleCar first ModifyScene", startup_begin,
+                   profiler.NowMs() - startup_begin, 0);
+      profiler.Print();
+    }
+  }
 }
 
+template class CarTask<DifferentialDrive>;
+template class CarTask<AckermannSteering>;
+
 }  // namespace mjpc
@@ -15,41 +15,140 @@
 #ifndef MJPC_TASKS_SIMPLE_CAR_SIMPLE_CAR_H_
 #define MJPC_TASKS_SIMPLE_CAR_SIMPLE_CAR_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <vector>
 
+#include <absl/random/random.h>
 #include <mujoco/mujoco.h>
 #include "mjpc/task.h"
+#include "mjpc/tasks/simple_car/alert_engine.h"
+#include "mjpc/tasks/simple_car/can_sender.h"
+#include "mjpc/tasks/simple_car/dashboard_stream.h"
+#include "mjpc/tasks/simple_car/episode_store.h"
+#include "mjpc/tasks/simple_car/gauge_faces.h"
+#include "mjpc/tasks/simple_car/goal_route.h"
+#include "mjpc/tasks/simple_car/goal_switch.h"
+#include "mjpc/tasks/simple_car/lockstep_bridge.h"
+#include "mjpc/tasks/simple_car/obstacles.h"
+#include "mjpc/tasks/simple_car/param_reload.h"
+#include "mjpc/tasks/simple_car/sim_profile.h"
+#include "mjpc/tasks/simple_car/startup_profile.h"
+#include "mjpc/tasks/simple_car/telemetry.h"
+#include "mjpc/tasks/simple_car/vehicle_traits.h"
+#include "mjpc/tasks/simple_car/view_culling.h"
 
 namespace mjpc {
-class SimpleCar : public Task {
+// 车辆导航与仪表盘任务，按车型（vehicle_traits.h）模板化
+template <typename Vehicle>
+class CarTask : public Task {
  public:
   std::string Name() const override;
   std::string XmlPath() const override;
 
   class ResidualFn : public BaseResidualFn {
    public:
-    explicit ResidualFn(const SimpleCar* task) : BaseResidualFn(task) {}
+    explicit ResidualFn(const CarTask* task) : BaseResidualFn(task) {}
     void Residual(const mjModel* model, const mjData* data,
                   double* residual) const override;
+
+   private:
+    friend class CarTask;
+    // 移动障碍物快照，rollout 中按匀速外推预测
+    ObstacleSet obstacles_;
+    double obstacle_margin_ = 0.3;  // 期望的最小净空（米）
+
+    // 下一个目标：已知时按切换规则评估剩余路程，rollout 穿过当前目标
+    bool has_next_goal_ = false;
+    double next_goal_[2] = {0.0, 0.0};
   };
 
-  SimpleCar() : residual_(this) {
+  CarTask() : residual_(this) {
     visualize = 1;  // enable visualization
+    StartupProfiler::Global();  // 启动计时以任务创建为起点
   }
 
   void TransitionLocked(mjModel* model, mjData* data) override;
+
+  // 运行时加入一个目标，访问顺序增量重排（线程安全）
+  void AddGoal(double x, double y);
+
+  // 仪表盘读数（仿真线程发布，任意线程无锁读取）
+  const DashboardTelemetry& telemetry() const { return telemetry_; }
+
+  // 告警事件与统计（事件可在任意线程读取）
+  const AlertEngine& alerts() const { return alerts_; }
+
+  // 参数热重载后的通知（例如规划器重新读取设置）：Transition 中只记下变化，
+  //   监听者在 DispatchParamReload 中、不持有任务锁时调用
+  void AddParamReloadListener(ParamListener listener);
+
+  // 通知 Transition 以来记下的参数变化，返回是否有变化；
+  //   仿真线程在 Transition 之后调用（不能持有任务锁）
+  bool DispatchParamReload();
+
+  // 只检查参数热重载（不推进目标等回合状态）并通知监听者，
+  //   供不调用 Transition 的闭环（例如规划器基准）使用
+  void PollParameters(mjModel* model);
   void ModifyScene(const mjModel* model, const mjData* data,
                    mjvScene* scene) const override;
 
+  // 仪表盘面板（kDashboardRegion 内的仪表和标题），供 DashboardPanel 单独渲染
+  void DrawDashboard(mjvScene* scene) const;
+
+  // 仪表盘显示内容的版本：按显示精度量化，内容不变时版本不变
+  uint64_t DashboardVersion() const;
+
+  // 为 true 时 ModifyScene 不再绘制仪表盘，由查看器合成缓存的面板
+  bool dashboard_overlay() const { return dashboard_overlay_; }
+  void set_dashboard_overlay(bool overlay) { dashboard_overlay_ = overlay; }
+
+  // 烘焙的表盘贴图；查看器每帧（GL 上下文为当前上下文时）调用 UploadGaugeFaces，
+  //   有新烘焙的贴图时上传并确认。确认之前仪表盘仍用 geom 绘制外圈和刻度，
+  //   不调用它的查看器（例如 mjpc 默认界面）不会看到空白表盘
+  const GaugeFaceAssets& gauge_faces() const { return gauge_faces_; }
+  void UploadGaugeFaces(const mjModel* model, const mjrContext* context);
+
+  // ModifyScene 的视锥剔除计数（渲染线程读取）
+  const CullStats& cull_stats() const { return cull_stats_; }
+
+  // 多视口共用一次 ModifyScene 时需关闭剔除（剔除只按 scene->camera 判断）
+  //   view_culling numeric 为默认值；set_view_culling 是查看器的覆盖设置，
+  //   不随 Reset 和参数热重载改变，clear_view_culling 后恢复 numeric 的设置
+  bool view_culling() const {
+    int culling = view_culling_override_.load(std::memory_order_relaxed);
+    return culling >= 0 ? culling != 0 : view_culling_;
+  }
+  void set_view_culling(bool culling) {
+    view_culling_override_.store(culling ? 1 : 0, std::memory_order_relaxed);
+  }
+  void clear_view_culling() {
+    view_culling_override_.store(-1, std::memory_order_relaxed);
+  }
+
+  // 规划器热身请求：Reset（启动、模型重载）和目标切换后置位，
+  //   驱动规划器的一方取走后执行热身（见 planner_warmup.h），返回是否有请求
+  bool TakeWarmupRequest() {
+    return warmup_requested_.exchange(false, std::memory_order_acq_rel);
+  }
+
+  // 最近一次 ModifyScene 中仪表盘 geom 的区间 [begin, end)，供 MultiView 标记
+  int dashboard_geom_begin() const { return dashboard_geoms_[0]; }
+  int dashboard_geom_end() const { return dashboard_geoms_[1]; }
+
  protected:
+  void ResetLocked(const mjModel* model) override;
   std::unique_ptr<mjpc::ResidualFn> ResidualLocked() const override {
-    return std::make_unique<ResidualFn>(this);
+    return std::make_unique<ResidualFn>(residual_);
   }
   ResidualFn* InternalResidual() override { return &residual_; }
 
  private:
   ResidualFn residual_;
+  typename Vehicle::Layout vehicle_;  // 车型相关的模型索引
   
   // 仪表盘数据结构
   struct DashboardData {
@@ -57,12 +156,122 @@ class SimpleCar : public Task {
     double rpm = 0.0;            // 转速
     double fuel = 100.0;         // 油量 (%)
     double temperature = 60.0;   // 温度 (°C)
+    uint32_t alerts = 0;         // 告警位掩码（发布快照时由 alerts_ 计算）
     
     // 模拟数据
     mutable double simulated_fuel = 100.0;
   };
   
   mutable DashboardData dashboard_;
+  bool dashboard_overlay_ = false;
+  mutable uint64_t dashboard_animation_ = 0;  // 闪烁/脉冲动画帧
+  mutable int dashboard_geoms_[2] = {0, 0};
+
+  // 表盘贴图（gauge_assets.xml）：Reset 后在仿真线程中烘焙到模型贴图，
+  //   每个圆形表盘只绘制一个贴图圆片和指针
+  GaugeFaceAssets gauge_faces_;
+  mjvGeom gauge_face_geoms_[kNumGaugeFaces];
+  bool gauge_faces_pending_ = false;
+  double gauge_faces_warning_ = -1.0;  // 已烘焙的转速表红区起点
+  std::atomic<int> gauge_faces_uploaded_{0};  // 查看器已上传的 version，0 为未上传
+  bool GaugeFacesUploaded() const {
+    return gauge_faces_uploaded_.load(std::memory_order_acquire) > 0;
+  }
+  void UpdateGaugeFaces(mjModel* model);
+  void DrawGaugeFace(mjvScene* scene, int face, float x, float y) const;
+
+  // 视锥剔除：仪表、标签和目标标记按包围球判断，view 为空时全部绘制
+  bool view_culling_ = true;  // view_culling numeric
+  std::atomic<int> view_culling_override_{-1};  // 查看器设置：-1 无，0 关，1 开
+  std::atomic<bool> warmup_requested_{false};
+  double cull_min_size_ = 0.01;  // 投影直径占视口高度的比例下限
+  mutable CullStats cull_stats_;
+  bool Visible(const ViewFrustum* view, float x, float y, float z,
+               float radius) const;
+  void DrawDashboard(mjvScene* scene, const ViewFrustum* view) const;
+
+  // 仪表盘快照，本地 WebSocket 推送与 CAN 报文发送
+  DashboardTelemetry telemetry_;
+  AlertEngine alerts_;
+  DashboardStream dashboard_stream_;
+  CanSender can_sender_;
+  void PublishTelemetry(const mjData* data);
+
+  // 回合统计（两次 Reset 之间为一个回合）
+  struct EpisodeStats {
+    uint64_t seed = 0;
+    double goal_start_time = 0.0;        // 当前目标出现时刻
+    double last_time = 0.0;              // 最近一次 Transition 的仿真时间
+    bool has_last_pos = false;
+    double last_pos[2] = {0.0, 0.0};     // 最近一次 Transition 的车辆位置
+    std::vector<double> time_to_goal;    // 每个目标的到达耗时
+    std::chrono::steady_clock::time_point wall_start;
+  };
+  EpisodeStats episode_;
+  EpisodeStoreWriter episode_store_;
+  absl::BitGen goal_gen_;
+
+  // 多目标队列：给定目标集合时按优化后的顺序依次访问，队列空后恢复随机目标
+  GoalRoute goal_route_;
+  bool goals_pending_ = false;  // 下一次 Transition 时初始化目标序列
+
+  // 预先确定的下一个目标（来自队列或提前抽取的随机目标）
+  bool goal_lookahead_ = true;
+  bool has_upcoming_goal_ = false;
+  double upcoming_goal_[2] = {0.0, 0.0};
+
+  // 移动障碍物（mocap 体 obstacle_0, obstacle_1, ...）
+  ObstacleScript obstacle_script_;
+  int obstacle_motion_ = ObstacleScript::kCircle;
+  double obstacle_speed_ = 0.3;
+  bool obstacles_pending_ = false;  // 下一次 Transition 时初始化
+
+  // 主仿真配置：快速配置（隐式积分器 + 大步长）不稳定时自动回退到精确配置
+  StabilityMonitor stability_;
+  SimProfile accurate_profile_ = kAccurateSimProfile;
+  SimProfile fast_profile_ = kFastSimProfile;
+  bool use_fast_profile_ = false;
+  bool fast_profile_active_ = false;
+  bool sim_profile_pending_ = false;  // 下一次 Transition 时应用
+  int profile_fallbacks_ = 0;
+
+  // 启动计时：第一次 Reset / ModifyScene
+  bool startup_reset_done_ = false;
+  mutable bool startup_reported_ = false;
+
+  // 锁步外部控制器（共享内存 + futex），超时回退到内部规划器
+  LockstepServer lockstep_;
+  double lockstep_period_ = 0.02;
+  double lockstep_timeout_us_ = 5000.0;
+  double lockstep_spin_us_ = 20.0;
+  double lockstep_next_time_ = 0.0;
+  void UpdateLockstep(mjData* data);
+
+  // 参数热重载（task_param_reload 秒检查一次 task.xml）
+  ParamReloader param_reloader_;
+  double param_reload_period_ = 0.0;
+  std::chrono::steady_clock::time_point param_reload_last_;
+  std::vector<ParamListener> param_listeners_;
+  ParamChange pending_param_change_;  // 尚未通知的变化（可能合并了多次）
+  bool param_change_pending_ = false;
+
+  // 读取回合中可修改的任务设置
+  void ReadTaskParameters(const mjModel* model);
+
+  // 检查 task.xml，只有参数变化时直接更新模型和任务
+  void PollParamReload(mjModel* model);
+
+  // 应用/监测主仿真配置
+  void UpdateSimProfile(mjModel* model, mjData* data);
+
+  // 确定下一个目标：优先取队列，否则随机
+  void DrawUpcomingGoal();
+
+  // 切换到下一个目标，并提前确定再下一个
+  void NextGoal(const mjModel* model, mjData* data);
+
+  // 把当前回合摘要追加写入结果存储
+  void FlushEpisode();
   
   // 辅助函数：更新仪表盘数据
   void UpdateDashboardData(const mjModel* model, const mjData* data) const;
@@ -87,6 +296,13 @@ class SimpleCar : public Task {
   void AddLabel(mjvScene* scene, float x, float y, float z, const char* text, 
                 float size, float r, float g, float b) const;
 };
+
+extern template class CarTask<DifferentialDrive>;
+extern template class CarTask<AckermannSteering>;
+
+// 差速驱动小车（task.xml）与阿克曼转向小车（task_ackermann.xml）
+using SimpleCar = CarTask<DifferentialDrive>;
+using AckermannCar = CarTask<AckermannSteering>;
 }  // namespace mjpc
 
 #endif  // MJPC_TASKS_SIMPLE_CAR_SIMPLE_CAR_H_
@@ -0,0 +1,116 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/startup_profile.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mjpc {
+
+StartupProfiler::StartupProfiler()
+    : origin_(std::chrono::steady_clock::now()) {}
+
+StartupProfiler& StartupProfiler::Global() {
+  static StartupProfiler* profiler = new StartupProfiler();
+  return *profiler;
+}
+
+bool StartupProfiler::Enabled() {
+  const char* value = std::getenv("MJPC_STARTUP_PROFILE");
+  return value && std::strcmp(value, "0") != 0;
+}
+
+double StartupProfiler::NowMs() const {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - origin_).count();
+}
+
+int64_t StartupProfiler::ResidentBytes() {
+  // /proc/self/statm 第二列：常驻页数
+  FILE* file = std::fopen("/proc/self/statm", "r");
+  if (!file) return 0;
+  long size = 0, resident = 0;
+  int n = std::fscanf(file, "%ld %ld", &size, &resident);
+  std::fclose(file);
+  return n == 2 ? static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE) : 0;
+}
+
+void StartupProfiler::Begin(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  open_.push_back({name, NowMs(), ResidentBytes()});
+}
+
+void StartupProfiler::End() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (open_.empty()) return;
+  Open open = open_.back();
+  open_.pop_back();
+  phases_.push_back({open.name, open.start_ms, NowMs() - open.start_ms,
+                     ResidentBytes() - open.rss});
+}
+
+void StartupProfiler::Add(const std::string& name, double start_ms,
+                          double duration_ms, int64_t rss_delta) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  phases_.push_back({name, start_ms, duration_ms, rss_delta});
+}
+
+std::vector<StartupProfiler::Phase> StartupProfiler::phases() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return phases_;
+}
+
+void StartupProfiler::Print() const {
+  // 按开始时刻排序（End 按结束顺序记录，内层在外层之前），同时开始的较长者在前
+  std::vector<Phase> phases = this->phases();
+  std::stable_sort(phases.begin(), phases.end(),
+                   [](const Phase& a, const Phase& b) {
+                     if (a.start_ms != b.start_ms) {
+                       return a.start_ms < b.start_ms;
+                     }
+                     return a.duration_ms > b.duration_ms;
+                   });
+
+  // 落在其他阶段区间内的阶段为嵌套阶段：缩进显示，不计入合计
+  double total = 0.0;
+  std::vector<double> enclosing_end;
+  std::printf("---- startup profile ----\n");
+  std::printf("%-28s %10s %10s %12s\n", "phase", "start[ms]", "time[ms]",
+              "rss[KiB]");
+  for (const Phase& phase : phases) {
+    while (!enclosing_end.empty() && phase.start_ms >= enclosing_end.back()) {
+      enclosing_end.pop_back();
+    }
+    int depth = enclosing_end.size();
+    if (depth == 0) total += phase.duration_ms;
+    enclosing_end.push_back(phase.start_ms + phase.duration_ms);
+
+    std::string name = std::string(2 * depth, ' ') + phase.name;
+    std::printf("%-28s %10.2f %10.2f %+12.0f\n", name.c_str(),
+                phase.start_ms, phase.duration_ms, phase.rss_delta / 1024.0);
+  }
+  std::printf("%-28s %10s %10.2f %12.0f\n", "total (top level)", "", total,
+              ResidentBytes() / 1024.0);
+}
+
+}  // namespace mjpc
@@ -0,0 +1,88 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_STARTUP_PROFILE_H_
+#define MJPC_TASKS_SIMPLE_CAR_STARTUP_PROFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mjpc {
+
+// 启动阶段耗时与内存变化记录
+//   设置环境变量 MJPC_STARTUP_PROFILE=1 时，任务在第一次 ModifyScene 后打印
+class StartupProfiler {
+ public:
+  struct Phase {
+    std::string name;
+    double start_ms;      // 相对 profiler 创建时刻
+    double duration_ms;
+    int64_t rss_delta;    // 常驻内存变化（字节）
+  };
+
+  StartupProfiler();
+
+  // 进程内共享的实例
+  static StartupProfiler& Global();
+
+  // 是否按需打印（MJPC_STARTUP_PROFILE 环境变量）
+  static bool Enabled();
+
+  void Begin(const std::string& name);
+  void End();
+
+  // 记录一个已经测得的阶段
+  void Add(const std::string& name, double start_ms, double duration_ms,
+           int64_t rss_delta);
+
+  double NowMs() const;
+  static int64_t ResidentBytes();
+
+  // 按开始时刻打印，嵌套阶段缩进且不计入合计
+  void Print() const;
+  std::vector<Phase> phases() const;
+
+  // RAII 计时
+  class Scope {
+   public:
+    Scope(StartupProfiler& profiler, const std::string& name)
+        : profiler_(profiler) {
+      profiler_.Begin(name);
+    }
+    ~Scope() { profiler_.End(); }
+
+   private:
+    StartupProfiler& profiler_;
+  };
+
+ private:
+  std::chrono::steady_clock::time_point origin_;
+  mutable std::mutex mutex_;
+  std::vector<Phase> phases_;
+
+  // 进行中的阶段（允许嵌套）
+  struct Open {
+    std::string name;
+    double start_ms;
+    int64_t rss;
+  };
+  std::vector<Open> open_;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_STARTUP_PROFILE_H_
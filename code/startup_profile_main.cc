@@ -0,0 +1,146 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SimpleCar 启动耗时分解
+//   startup_profile [--gl] [--threads=N]
+// 网格处理和纹理生成发生在 mj_compile 内部，这里与编译合并计时，并给出规模供参考。
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <GLFW/glfw3.h>
+#include <mujoco/mujoco.h>
+#include "mjpc/planners/sampling/planner.h"
+#include "mjpc/tasks/simple_car/simple_car.h"
+#include "mjpc/tasks/simple_car/startup_profile.h"
+#include "mjpc/threadpool.h"
+
+ABSL_FLAG(std::string, xml, "", "task xml (default: simple_car/task.xml)");
+ABSL_FLAG(bool, gl, false, "also time GL context creation (hidden window)");
+ABSL_FLAG(int, threads, 0, "planner thread pool size (0: hardware)");
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  mjpc::StartupProfiler& profiler = mjpc::StartupProfiler::Global();
+
+  mjpc::SimpleCar task;
+  std::string xml = absl::GetFlag(FLAGS_xml);
+  if (xml.empty()) xml = task.XmlPath();
+
+  // ---------- 模型 ----------
+  char error[1000] = "";
+  profiler.Begin("xml parse (with includes)");
+  mjSpec* spec = mj_parseXML(xml.c_str(), nullptr, error, sizeof(error));
+  profiler.End();
+  if (!spec) {
+    std::fprintf(stderr, "failed to parse '%s': %s\n", xml.c_str(), error);
+    return 1;
+  }
+
+  profiler.Begin("compile (meshes, textures)");
+  mjModel* model = mj_compile(spec, nullptr);
+  profiler.End();
+  mj_deleteSpec(spec);
+  if (!model) {
+    std::fprintf(stderr, "failed to compile '%s'\n", xml.c_str());
+    return 1;
+  }
+
+  profiler.Begin("mjData allocation");
+  mjData* data = mj_makeData(model);
+  profiler.End();
+
+  profiler.Begin("first mj_forward");
+  mj_forward(model, data);
+  profiler.End();
+
+  // ---------- 任务与规划器 ----------
+  profiler.Begin("task reset");
+  task.Reset(model);
+  profiler.End();
+
+  {
+    mjpc::StartupProfiler::Scope scope(profiler, "planner initialization");
+    mjpc::SamplingPlanner planner;
+    planner.Initialize(model, task);
+    planner.Allocate();
+    planner.Reset(0);
+  }
+
+  int threads = absl::GetFlag(FLAGS_threads);
+  if (threads <= 0) threads = std::thread::hardware_concurrency();
+  {
+    // 等每个线程都执行过一次任务才算启动完成
+    mjpc::StartupProfiler::Scope scope(profiler, "thread pool spin-up");
+    mjpc::ThreadPool pool(threads);
+    int count_before = pool.GetCount();
+    for (int i = 0; i < threads; i++) pool.Schedule([]() {});
+    pool.WaitCount(count_before + threads);
+    pool.ResetCount();
+  }
+
+  // ---------- 渲染 ----------
+  GLFWwindow* window = nullptr;
+  mjrContext context;
+  mjr_defaultContext(&context);
+  if (absl::GetFlag(FLAGS_gl)) {
+    mjpc::StartupProfiler::Scope scope(profiler, "GL context");
+    if (glfwInit()) {
+      glfwWindowHint(GLFW_VISIBLE, 0);
+      window = glfwCreateWindow(800, 600, "startup_profile", nullptr, nullptr);
+      if (window) {
+        glfwMakeContextCurrent(window);
+        mjr_makeContext(model, &context, mjFONTSCALE_150);
+      }
+    }
+  }
+
+  mjvScene scene;
+  mjvCamera camera;
+  mjvOption option;
+  mjvPerturb perturb;
+  mjv_defaultCamera(&camera);
+  mjv_defaultOption(&option);
+  mjv_defaultPerturb(&perturb);
+  mjv_defaultScene(&scene);
+
+  profiler.Begin("scene creation");
+  mjv_makeScene(model, &scene, 2000);
+  profiler.End();
+
+  profiler.Begin("first mjv_updateScene");
+  mjv_updateScene(model, data, &option, &perturb, &camera, mjCAT_ALL, &scene);
+  profiler.End();
+
+  profiler.Begin("first ModifyScene");
+  task.ModifyScene(model, data, &scene);
+  profiler.End();
+
+  profiler.Print();
+  std::printf("model: %d meshes (%d vertices), %d textures (%d bytes)\n",
+              model->nmesh, model->nmeshvert, model->ntex, model->ntexdata);
+
+  mjv_freeScene(&scene);
+  if (window) {
+    mjr_freeContext(&context);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  }
+  mj_deleteData(data);
+  mj_deleteModel(model);
+  return 0;
+}
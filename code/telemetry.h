@@ -0,0 +1,88 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_TELEMETRY_H_
+#define MJPC_TASKS_SIMPLE_CAR_TELEMETRY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mjpc {
+
+// 仪表盘读数快照（仿真线程发布，其它线程读取）
+struct DashboardSnapshot {
+  double time = 0.0;         // 仿真时间（s）
+  double speed_kmh = 0.0;    // 速度（km/h）
+  double rpm = 0.0;          // 转速
+  double fuel = 0.0;         // 油量（%）
+  double temperature = 0.0;  // 温度（°C）
+  double x = 0.0;            // 车辆位置（m）
+  double y = 0.0;
+  double heading = 0.0;      // 车头朝向（rad）
+  uint32_t alerts = 0;       // 告警位掩码（AlertBit）
+  uint32_t alert_events = 0; // 已产生的告警边沿事件数，变化即有新事件
+};
+
+// 单写者多读者的顺序锁：
+//   写者从不等待读者；读者在写入过程中读到的数据会被丢弃并重读
+class DashboardTelemetry {
+ public:
+  // 仿真线程调用
+  void Publish(const DashboardSnapshot& snapshot) {
+    uint64_t words[kWords];
+    std::memcpy(words, &snapshot, sizeof(snapshot));
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);  // 奇数：写入中
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < kWords; i++) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // 读取最新快照，返回其序号（尚未发布时返回 0）
+  uint64_t Read(DashboardSnapshot* snapshot) const {
+    uint64_t words[kWords];
+    while (true) {
+      uint64_t before = sequence_.load(std::memory_order_acquire);
+      if (before & 1) continue;
+      for (int i = 0; i < kWords; i++) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == before) {
+        std::memcpy(snapshot, words, sizeof(*snapshot));
+        return before / 2;
+      }
+    }
+  }
+
+  uint64_t sequence() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  static_assert(std::is_trivially_copyable_v<DashboardSnapshot>);
+  static_assert(sizeof(DashboardSnapshot) % sizeof(uint64_t) == 0);
+  static constexpr int kWords = sizeof(DashboardSnapshot) / sizeof(uint64_t);
+
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<uint64_t> words_[kWords] = {};
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_TELEMETRY_H_
@@ -0,0 +1,117 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_VEHICLE_TRAITS_H_
+#define MJPC_TASKS_SIMPLE_CAR_VEHICLE_TRAITS_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 车型特性：任务与仪表盘代码按车型模板化，热路径中没有运行时分支
+//   每个车型提供：
+//     kName / kXmlPath         任务名称与模型路径
+//     Layout                   Reset 时从模型中查好的索引
+//     ControlResidual          控制残差（2 维）
+//     Signals                  仪表盘信号（车速、转速）
+
+// 仪表盘信号
+struct VehicleSignals {
+  double speed_kmh = 0.0;
+  double rpm = 0.0;
+};
+
+// 差速驱动（car_model.xml）：两个后轮，forward / turn 两个肌腱
+struct DifferentialDrive {
+  static constexpr const char* kName = "SimpleCar";
+  static constexpr const char* kXmlPath = "simple_car/task.xml";
+
+  struct Layout {
+    void Initialize(const mjModel*) {}
+  };
+
+  // ctrl[0] 前进，ctrl[1] 差速转向
+  static void ControlResidual(const mjModel*, const mjData* data,
+                              double* residual) {
+    residual[0] = data->ctrl[0];
+    residual[1] = data->ctrl[1];
+  }
+
+  // 转速按车速模拟（怠速 800，上限 8000）
+  static VehicleSignals Signals(const Layout&, const mjModel*,
+                                const mjData* data) {
+    VehicleSignals signals;
+    double speed = std::sqrt(data->qvel[0] * data->qvel[0] +
+                             data->qvel[1] * data->qvel[1]);
+    signals.speed_kmh = speed * 3.6;
+    signals.rpm = std::clamp(signals.speed_kmh * 40.0 + 800.0, 800.0, 8000.0);
+    return signals;
+  }
+};
+
+// 阿克曼转向（car_model_ackermann.xml）：前轴转向，后轴驱动
+struct AckermannSteering {
+  static constexpr const char* kName = "AckermannCar";
+  static constexpr const char* kXmlPath = "simple_car/task_ackermann.xml";
+
+  // 发动机到后轮的总传动比（仪表盘转速）
+  static constexpr double kDriveRatio = 20.0;
+
+  struct Layout {
+    int rear_dof[2] = {-1, -1};
+
+    void Initialize(const mjModel* model) {
+      const char* names[2] = {"left rear", "right rear"};
+      for (int i = 0; i < 2; i++) {
+        int joint = mj_name2id(model, mjOBJ_JOINT, names[i]);
+        rear_dof[i] = joint >= 0 ? model->jnt_dofadr[joint] : -1;
+      }
+    }
+  };
+
+  // ctrl[0] 油门，ctrl[1] 前轮转角指令；
+  //   转向代价随车速增大（相同转角下侧向加速度随车速增大），高速时少打方向
+  static void ControlResidual(const mjModel*, const mjData* data,
+                              double* residual) {
+    double speed = std::sqrt(data->qvel[0] * data->qvel[0] +
+                             data->qvel[1] * data->qvel[1]);
+    residual[0] = data->ctrl[0];
+    residual[1] = data->ctrl[1] * (1.0 + speed);
+  }
+
+  // 转速由后轮角速度经传动比换算
+  static VehicleSignals Signals(const Layout& layout, const mjModel*,
+                                const mjData* data) {
+    VehicleSignals signals;
+    double speed = std::sqrt(data->qvel[0] * data->qvel[0] +
+                             data->qvel[1] * data->qvel[1]);
+    signals.speed_kmh = speed * 3.6;
+
+    double wheel = 0.0;  // 后轮平均角速度（rad/s）
+    if (layout.rear_dof[0] >= 0 && layout.rear_dof[1] >= 0) {
+      wheel = 0.5 * (std::abs(data->qvel[layout.rear_dof[0]]) +
+                     std::abs(data->qvel[layout.rear_dof[1]]));
+    }
+    signals.rpm = std::clamp(800.0 + wheel * kDriveRatio * 60.0 / (2.0 * M_PI),
+                             800.0, 8000.0);
+    return signals;
+  }
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_VEHICLE_TRAITS_H_
@@ -0,0 +1,131 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mjpc/tasks/simple_car/view_culling.h"
+
+#include <cmath>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+namespace {
+
+float Dot3(const float a[3], const float b[3]) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// 包围球在侧平面外：平面过原点，侧边斜率为 slope（近平面范围 / 近平面距离）
+//   sign 为 +1 时平面在 +轴一侧
+bool OutsidePlane(float u, float z, float slope, float sign, float radius) {
+  float distance = sign * (u - slope * z) / std::sqrt(1.0f + slope * slope);
+  return distance > radius;
+}
+
+}  // namespace
+
+ViewFrustum::ViewFrustum(const mjvScene* scene, double max_aspect) {
+  // 模型变换（enabletransform）下场景坐标与世界坐标不一致，不剔除
+  if (!scene || scene->enabletransform) return;
+
+  // 单目渲染使用两个相机的平均，双目分别使用；两者都取并集
+  for (const mjvGLCamera& gl : scene->camera) {
+    Camera camera;
+    const float* forward = gl.forward;
+    const float* up = gl.up;
+    float right[3] = {forward[1] * up[2] - forward[2] * up[1],
+                      forward[2] * up[0] - forward[0] * up[2],
+                      forward[0] * up[1] - forward[1] * up[0]};
+    float norm = std::sqrt(Dot3(right, right));
+    if (!(norm > 1e-6f) || !(gl.frustum_near > 0.0f) ||
+        !(gl.frustum_far > gl.frustum_near) ||
+        !(gl.frustum_top > gl.frustum_bottom)) {
+      ncamera_ = 0;
+      return;
+    }
+    for (int i = 0; i < 3; i++) {
+      camera.pos[i] = gl.pos[i];
+      camera.axis[0][i] = right[i] / norm;
+      camera.axis[1][i] = up[i];
+      camera.axis[2][i] = forward[i];
+    }
+    float half_width = gl.frustum_width;
+    if (half_width <= 0.0f) {
+      half_width = static_cast<float>(
+          0.5 * max_aspect * (gl.frustum_top - gl.frustum_bottom));
+    }
+    camera.left = gl.frustum_center - half_width;
+    camera.right = gl.frustum_center + half_width;
+    camera.bottom = gl.frustum_bottom;
+    camera.top = gl.frustum_top;
+    camera.znear = gl.frustum_near;
+    camera.zfar = gl.frustum_far;
+    camera.orthographic = gl.orthographic != 0;
+    camera_[ncamera_++] = camera;
+  }
+}
+
+ViewFrustum::Result ViewFrustum::Test(const float center[3], float radius,
+                                      double min_size) const {
+  if (ncamera_ == 0) return kVisible;
+  Result result = kOutside;
+  for (int i = 0; i < ncamera_; i++) {
+    Result r = TestCamera(camera_[i], center, radius, min_size);
+    if (r == kVisible) return kVisible;
+    if (r == kTooSmall) result = kTooSmall;
+  }
+  return result;
+}
+
+ViewFrustum::Result ViewFrustum::TestCamera(const Camera& camera,
+                                            const float center[3],
+                                            float radius,
+                                            double min_size) const {
+  float d[3] = {center[0] - camera.pos[0], center[1] - camera.pos[1],
+                center[2] - camera.pos[2]};
+  float x = Dot3(camera.axis[0], d);
+  float y = Dot3(camera.axis[1], d);
+  float z = Dot3(camera.axis[2], d);
+
+  // 近/远平面
+  if (z < camera.znear - radius || z > camera.zfar + radius) return kOutside;
+
+  float height = camera.top - camera.bottom;
+  if (camera.orthographic) {
+    if (x - radius > camera.right || x + radius < camera.left ||
+        y - radius > camera.top || y + radius < camera.bottom) {
+      return kOutside;
+    }
+    if (min_size > 0.0 && 2.0f * radius < min_size * height) return kTooSmall;
+    return kVisible;
+  }
+
+  // 透视：四个侧平面都过相机原点
+  float inv_near = 1.0f / camera.znear;
+  if (OutsidePlane(x, z, camera.right * inv_near, 1.0f, radius) ||
+      OutsidePlane(x, z, camera.left * inv_near, -1.0f, radius) ||
+      OutsidePlane(y, z, camera.top * inv_near, 1.0f, radius) ||
+      OutsidePlane(y, z, camera.bottom * inv_near, -1.0f, radius)) {
+    return kOutside;
+  }
+
+  // 投影直径占视口高度的比例（包围球跨过近平面时视为足够大）
+  if (min_size > 0.0 && z - radius > camera.znear) {
+    double fraction = 2.0 * radius * camera.znear / (z * height);
+    if (fraction < min_size) return kTooSmall;
+  }
+  return kVisible;
+}
+
+}  // namespace mjpc
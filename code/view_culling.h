@@ -0,0 +1,69 @@
+// Copyright 2022 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MJPC_TASKS_SIMPLE_CAR_VIEW_CULLING_H_
+#define MJPC_TASKS_SIMPLE_CAR_VIEW_CULLING_H_
+
+#include <cstdint>
+
+#include <mujoco/mujoco.h>
+
+namespace mjpc {
+
+// 剔除计数：frame_* 为最近一次 ModifyScene，total_* 为累计
+struct CullStats {
+  uint64_t frames = 0;
+  int frame_tested = 0;
+  int frame_frustum = 0;  // 在视锥外
+  int frame_size = 0;     // 投影尺寸小于下限
+  uint64_t total_tested = 0;
+  uint64_t total_frustum = 0;
+  uint64_t total_size = 0;
+};
+
+// 当前相机的视锥（mjv_updateScene 之后 scene->camera 中的 OpenGL 相机）
+//   用包围球判断仪表、标签等装饰是否可见；双目渲染时取两个视锥的并集
+//   判断是保守的：不确定时一律视为可见
+class ViewFrustum {
+ public:
+  enum Result { kVisible = 0, kOutside, kTooSmall };
+
+  // frustum_width 为 0 时水平范围由视口宽高比决定，这里按 max_aspect 估计
+  explicit ViewFrustum(const mjvScene* scene, double max_aspect = 2.5);
+
+  // center/radius 为世界坐标的包围球；min_size 为投影直径占视口高度的比例下限
+  //   （0 时只做视锥判断，例如固定像素大小的标签）
+  Result Test(const float center[3], float radius, double min_size) const;
+
+  bool valid() const { return ncamera_ > 0; }
+
+ private:
+  struct Camera {
+    float pos[3];
+    float axis[3][3];   // 右、上、前
+    float left, right;  // 近平面上的范围（正交相机为世界单位）
+    float bottom, top;
+    float znear, zfar;
+    bool orthographic;
+  };
+  Result TestCamera(const Camera& camera, const float center[3], float radius,
+                    double min_size) const;
+
+  Camera camera_[2];
+  int ncamera_ = 0;
+};
+
+}  // namespace mjpc
+
+#endif  // MJPC_TASKS_SIMPLE_CAR_VIEW_CULLING_H_